@@ -0,0 +1,151 @@
+#include "bench.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Count every heap allocation, whether it comes from new or from malloc
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t n, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+namespace
+{
+uint64_t alloc_count = 0;
+
+struct entry_t
+{
+  const char *name;
+  bench::bench_fn fn;
+};
+
+entry_t entries[64];
+int num_entries = 0;
+
+struct metric_t
+{
+  const char *name;
+  double value;
+  bool limited;
+  double max;
+};
+
+metric_t metrics[8];
+int num_metrics = 0;
+
+double run_once(bench::bench_fn fn, uint64_t iters)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  fn(iters);
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+extern "C" void *malloc(size_t size)
+{
+  alloc_count++;
+  return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t n, size_t size)
+{
+  alloc_count++;
+  return __libc_calloc(n, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+  alloc_count++;
+  return __libc_realloc(ptr, size);
+}
+
+bench::registrar::registrar(const char *name, bench_fn fn)
+{
+  if (num_entries < (int)(sizeof(entries) / sizeof(entries[0])))
+    entries[num_entries++] = {name, fn};
+}
+
+uint64_t bench::allocations()
+{
+  return alloc_count;
+}
+
+void bench::metric(const char *name, double value)
+{
+  for (int i = 0; i < num_metrics; i++)
+    if (strcmp(metrics[i].name, name) == 0)
+    {
+      metrics[i].value = value;
+      return;
+    }
+
+  if (num_metrics < (int)(sizeof(metrics) / sizeof(metrics[0])))
+    metrics[num_metrics++] = {name, value, false, 0};
+}
+
+void bench::limit(const char *name, double value, double max)
+{
+  metric(name, value);
+  for (int i = 0; i < num_metrics; i++)
+    if (strcmp(metrics[i].name, name) == 0)
+    {
+      metrics[i].limited = true;
+      metrics[i].max = max;
+    }
+}
+
+/**
+ * Usage: core_bench [name filter] [min time per benchmark, seconds]
+ *
+ * Exits 1 if any bench::limit was exceeded
+ */
+int main(int argc, char **argv)
+{
+  const char *filter = argc > 1 ? argv[1] : "";
+  double min_ns = (argc > 2 ? atof(argv[2]) : 0.25) * 1e9;
+  int failures = 0;
+
+  for (int i = 0; i < num_entries; i++)
+  {
+    if (strstr(entries[i].name, filter) == NULL)
+      continue;
+
+    // Warm up, then double the iterations until the run is long enough to trust
+    run_once(entries[i].fn, 1);
+
+    uint64_t iters = 1;
+    double ns = 0;
+    uint64_t allocs = 0;
+    num_metrics = 0;
+    while (true)
+    {
+      uint64_t before = alloc_count;
+      ns = run_once(entries[i].fn, iters);
+      allocs = alloc_count - before;
+
+      if (ns >= min_ns || iters >= (1ULL << 40))
+        break;
+      iters *= 2;
+    }
+
+    printf("{\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.2f, \"allocs_per_op\": %.2f",
+           entries[i].name, (unsigned long long)iters, ns / iters, (double)allocs / iters);
+    for (int m = 0; m < num_metrics; m++)
+      printf(", \"%s\": %.3g", metrics[m].name, metrics[m].value);
+    printf("}\n");
+    fflush(stdout);
+
+    for (int m = 0; m < num_metrics; m++)
+    {
+      // Written so NaN fails too
+      if (metrics[m].limited && !(metrics[m].value <= metrics[m].max))
+      {
+        fprintf(stderr, "FAIL %s: %s is %g, over %g\n", entries[i].name, metrics[m].name, metrics[m].value,
+                metrics[m].max);
+        failures++;
+      }
+    }
+  }
+
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,68 @@
+#ifndef _BENCH_
+#define _BENCH_
+
+#include <stdint.h>
+
+/**
+ * bench.h
+ *
+ * Minimal microbenchmark harness for the host build (make -f host.mk bench).
+ *
+ * Each benchmark is a function that runs its operation (iters) times. The runner grows
+ * the iteration count until a run takes long enough to time reliably, then prints one
+ * JSON object per benchmark to stdout:
+ *
+ *  {"name": "pid_update", "iterations": 4194304, "ns_per_op": 21.4, "allocs_per_op": 0.00}
+ *
+ * so results from two commits can be compared with any JSON tool. Benchmarks can attach
+ * their own numbers (e.g. the error of an approximation) with bench::metric, which are
+ * added to the same line. Numbers given with bench::limit also have a maximum: if one is
+ * over it, or not a number, the benchmark is reported as failed on stderr and core_bench
+ * exits non-zero.
+ */
+namespace bench
+{
+
+typedef void (*bench_fn)(uint64_t iters);
+
+/**
+ * Register a benchmark. Use the BENCHMARK macro instead of calling this directly.
+ */
+struct registrar
+{
+  registrar(const char *name, bench_fn fn);
+};
+
+/**
+ * Stop the compiler from optimizing away a value that is never used
+ */
+template <typename T>
+inline void keep(T const &value)
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Number of heap allocations made by the program so far
+ */
+uint64_t allocations();
+
+/**
+ * Attach a named value to the running benchmark's result. The value from the last
+ * (longest) run is the one printed. Names must be string literals.
+ */
+void metric(const char *name, double value);
+
+/**
+ * bench::metric, for a value that must be no more than (max)
+ */
+void limit(const char *name, double value, double max);
+
+} // namespace bench
+
+#define BENCHMARK(name)                                                                                                \
+  static void bench_##name(uint64_t iters);                                                                            \
+  static bench::registrar bench_reg_##name(#name, bench_##name);                                                      \
+  static void bench_##name(uint64_t iters)
+
+#endif
@@ -0,0 +1,315 @@
+/**
+ * core_bench.cpp
+ *
+ * Benchmarks for the hot-path code in core. Devices are the simulator's stand-ins with
+ * physics turned off, so device calls cost about as much as a function call.
+ */
+#include "bench.h"
+#include "sim/sim.h"
+#include "../core/include/utils/pid.h"
+#include "../core/include/utils/vector.h"
+#include "../core/include/subsystems/swerve_module.h"
+#include "../core/include/subsystems/swerve_drive.h"
+#include "../core/include/subsystems/mecanum_drive.h"
+#include "../core/include/utils/command.h"
+#include "../core/include/utils/routine.h"
+#include "../core/include/utils/pure_pursuit.h"
+#include "../core/include/pathfinder.h"
+
+using namespace vex;
+
+void sim::configure_robot(World &world)
+{
+  world.physics_enabled = false;
+}
+
+namespace
+{
+motor lf_drive(PORT1, gearSetting::ratio6_1), rf_drive(PORT10, gearSetting::ratio6_1);
+motor lr_drive(PORT11, gearSetting::ratio6_1), rr_drive(PORT20, gearSetting::ratio6_1);
+motor lf_dir(PORT2, true), rf_dir(PORT9, true), lr_dir(PORT12, true), rr_dir(PORT19, true);
+inertial imu(PORT6);
+
+SwerveModule lf_mod(lf_drive, gearSetting::ratio18_1, lf_dir, gearSetting::ratio18_1);
+SwerveModule rf_mod(rf_drive, gearSetting::ratio18_1, rf_dir, gearSetting::ratio18_1);
+SwerveModule lr_mod(lr_drive, gearSetting::ratio18_1, lr_dir, gearSetting::ratio18_1);
+SwerveModule rr_mod(rr_drive, gearSetting::ratio18_1, rr_dir, gearSetting::ratio18_1);
+
+SwerveDrive swerve(lf_mod, lr_mod, rf_mod, rr_mod, imu);
+MecanumDrive mecanum(lf_drive, rf_drive, lr_drive, rr_drive);
+
+PID::pid_config_t pid_config = {.p = .035, .i = .001, .d = .003, .f = 0, .deadband = .5, .on_target_time = .3};
+} // namespace
+
+BENCHMARK(pid_update)
+{
+  PID pid(pid_config);
+  pid.set_target(100);
+  pid.set_limits(-1, 1);
+
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    pid.update((double)(i % 100));
+    bench::keep(pid.get());
+  }
+}
+
+BENCHMARK(vector_from_point)
+{
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    Vector::point_t p = {.x = (i % 7) / (scalar_t)7, .y = (i % 5) / (scalar_t)5};
+    Vector v(p);
+    bench::keep(v);
+  }
+}
+
+BENCHMARK(vector_add)
+{
+  Vector a(.3, .8);
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    Vector b((i % 8) * .7, .5);
+    Vector c = a + b;
+    bench::keep(c);
+  }
+}
+
+BENCHMARK(swerve_drive_vector)
+{
+  for (uint64_t i = 0; i < iters; i++)
+    swerve.drive(Vector((i % 16) * .39, .75), ((i % 3) - 1) * .3);
+}
+
+BENCHMARK(swerve_drive_controller)
+{
+  for (uint64_t i = 0; i < iters; i++)
+    swerve.drive((int32_t)(i % 200) - 100, (int32_t)(i % 150) - 75, (int32_t)(i % 60) - 30);
+}
+
+BENCHMARK(swerve_module_set_direction)
+{
+  for (uint64_t i = 0; i < iters; i++)
+    bench::keep(lf_mod.set_direction((double)(i % 360) - 180));
+}
+
+BENCHMARK(swerve_module_set)
+{
+  for (uint64_t i = 0; i < iters; i++)
+    lf_mod.set((double)(i % 360) - 180, (i % 21) / 10.0 - 1.0);
+}
+
+BENCHMARK(mecanum_drive)
+{
+  for (uint64_t i = 0; i < iters; i++)
+    mecanum.drive((double)(i % 200) - 100, (double)(i % 150) - 75, (double)(i % 60) - 30);
+}
+
+namespace
+{
+bool never_done() { return false; }
+bool done_after(void *count) { return --*(int *)count <= 0; }
+} // namespace
+
+BENCHMARK(command_scheduler_tick)
+{
+  // A typical routine shape: drive while running two mechanisms, against a timeout
+  FunctionCommand drive_cmd(never_done), intake_cmd(never_done), lift_cmd(never_done);
+  drive_cmd.add_requirement(&swerve);
+  SequentialGroup mechanisms({&intake_cmd, &lift_cmd});
+  DeadlineGroup routine({&drive_cmd, &mechanisms});
+  RaceGroup auto_cmd({&routine});
+
+  CommandScheduler scheduler;
+  scheduler.schedule(auto_cmd);
+  for (uint64_t i = 0; i < iters; i++)
+    scheduler.run();
+}
+
+BENCHMARK(command_schedule_sequence)
+{
+  // Start, run to completion and end a short sequence
+  int counts[3];
+  FunctionCommand a(done_after, &counts[0]), b(done_after, &counts[1]), c(done_after, &counts[2]);
+  SequentialGroup sequence({&a, &b, &c});
+  CommandScheduler scheduler;
+
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    counts[0] = counts[1] = counts[2] = 2;
+    scheduler.schedule(sequence);
+    while (!scheduler.is_idle())
+      scheduler.run();
+  }
+}
+
+namespace
+{
+class BenchRoutine : public Routine
+{
+public:
+  FunctionCommand intake = FunctionCommand(never_done);
+  int count = 0;
+
+  void body() override
+  {
+    ROUTINE_BEGIN();
+    while (true)
+    {
+      ROUTINE_AWAIT(++count % 4 == 0);
+      ROUTINE_AWAIT_ANY(&intake);
+    }
+    ROUTINE_END();
+  }
+};
+} // namespace
+
+BENCHMARK(routine_tick)
+{
+  BenchRoutine routine;
+  CommandScheduler scheduler;
+  scheduler.schedule(routine);
+  for (uint64_t i = 0; i < iters; i++)
+    scheduler.run();
+}
+
+namespace
+{
+// A 3000 point zig-zag across the field, at 1" spacing
+#define PURSUIT_LEGS 30
+#define PURSUIT_LEG_INCHES 100
+
+PurePursuit::pursuit_config_t pursuit_config = {.lookahead_min = 6, .lookahead_max = 18, .lookahead_gain = .25,
+                                                .max_v = 60, .min_v = 4, .max_a = 60, .max_lateral_a = 60,
+                                                .kv = 1 / 72.0, .track_width = 12, .spacing = 1,
+                                                .search_distance = 24, .relocate_distance = 12,
+                                                .end_tolerance = 1};
+
+void pursuit_path(Waypoint *points)
+{
+  for (int i = 0; i <= PURSUIT_LEGS; i++)
+    points[i] = {(double)(i % 2) * PURSUIT_LEG_INCHES, (double)i * 4, 0};
+}
+
+/**
+ * A pose (inches) along the zig-zag, an inch to the side of it
+ */
+PurePursuit::pose_t pursuit_pose(scalar_t inches)
+{
+  int leg = (int)(inches / PURSUIT_LEG_INCHES) % PURSUIT_LEGS;
+  scalar_t along = inches - (int)(inches / PURSUIT_LEG_INCHES) * PURSUIT_LEG_INCHES;
+  scalar_t x = leg % 2 == 0 ? along : PURSUIT_LEG_INCHES - along;
+  return {x, leg * (scalar_t)4 + 1, leg % 2 == 0 ? (scalar_t)0 : (scalar_t)3.14159};
+}
+} // namespace
+
+BENCHMARK(pure_pursuit_update)
+{
+  Waypoint points[PURSUIT_LEGS + 1];
+  pursuit_path(points);
+  PurePursuit pursuit(pursuit_config);
+  pursuit.set_path(points, PURSUIT_LEGS + 1);
+
+  // Half an inch per loop: about 50 in/s at 10ms
+  scalar_t inches = 0;
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    inches += .5;
+    if (inches >= PURSUIT_LEGS * PURSUIT_LEG_INCHES - 20)
+    {
+      inches = 0;
+      pursuit.set_path(points, PURSUIT_LEGS + 1);
+    }
+    bench::keep(pursuit.update(pursuit_pose(inches)));
+  }
+  bench::metric("path_points", pursuit.get_length());
+}
+
+// What update() avoids: the nearest point by checking the whole path
+BENCHMARK(pure_pursuit_full_scan)
+{
+  Waypoint points[PURSUIT_LEGS + 1];
+  pursuit_path(points);
+  PurePursuit pursuit(pursuit_config);
+  pursuit.set_path(points, PURSUIT_LEGS + 1);
+  int length = pursuit.get_length();
+
+  static scalar_t xs[PURSUIT_LEGS * PURSUIT_LEG_INCHES + 1], ys[PURSUIT_LEGS * PURSUIT_LEG_INCHES + 1];
+  for (int i = 0; i < length; i++)
+  {
+    PurePursuit::pose_t p = pursuit_pose(i);
+    xs[i] = p.x;
+    ys[i] = p.y - 1;
+  }
+
+  scalar_t inches = 0;
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    inches = inches + .5 >= PURSUIT_LEGS * PURSUIT_LEG_INCHES - 20 ? 0 : inches + .5;
+    PurePursuit::pose_t pose = pursuit_pose(inches);
+
+    int best = 0;
+    scalar_t best_sq = -1;
+    for (int j = 0; j < length; j++)
+    {
+      scalar_t dx = xs[j] - pose.x, dy = ys[j] - pose.y;
+      if (best_sq < 0 || dx * dx + dy * dy < best_sq)
+      {
+        best_sq = dx * dx + dy * dy;
+        best = j;
+      }
+    }
+    bench::keep(best);
+  }
+}
+
+// pathfinder is only shipped as an ARM archive; these run when host.mk is given a host
+// build of it with PATHFINDER_HOST_LIB
+#ifdef BENCH_PATHFINDER
+
+namespace
+{
+Waypoint bench_path[] = {{0, 0, 0}, {24, 24, d2r(45)}, {48, 36, 0}};
+}
+
+BENCHMARK(pathfinder_generate)
+{
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    TrajectoryCandidate candidate;
+    pathfinder_prepare(bench_path, 3, FIT_HERMITE_CUBIC, PATHFINDER_SAMPLES_LOW, .01, 10, 20, 100, &candidate);
+
+    Segment *traj = (Segment *)malloc(sizeof(Segment) * candidate.length);
+    pathfinder_generate(&candidate, traj);
+    bench::keep(traj[candidate.length - 1]);
+    free(traj);
+  }
+}
+
+BENCHMARK(pathfinder_follow_encoder)
+{
+  static Segment *traj = NULL;
+  static int length = 0;
+
+  if (traj == NULL)
+  {
+    TrajectoryCandidate candidate;
+    pathfinder_prepare(bench_path, 3, FIT_HERMITE_CUBIC, PATHFINDER_SAMPLES_LOW, .01, 10, 20, 100, &candidate);
+    traj = (Segment *)malloc(sizeof(Segment) * candidate.length);
+    pathfinder_generate(&candidate, traj);
+    length = candidate.length;
+  }
+
+  EncoderConfig config = {0, 900, 4 * PI, .1, 0, 0, .1, 0};
+  EncoderFollower follower = {0, 0, 0, 0, 0};
+
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    if (follower.finished)
+      follower = {0, 0, 0, 0, 0};
+
+    bench::keep(pathfinder_follow_encoder(config, &follower, traj, length, (int)(follower.segment * 3)));
+  }
+}
+
+#endif
@@ -0,0 +1,210 @@
+/**
+ * estimator_bench.cpp
+ *
+ * PoseEstimator (pose_estimator.h) on synthetic sensor data. A made-up 15s drive is
+ * sampled into the readings a robot would get: wheel speeds with noise, a scale error
+ * and bursts of wheel slip, 30ms late; IMU heading with noise and drift, turn rate and
+ * acceleration with noise, 10ms late. pose_estimator_error reports the RMS position
+ * error (inches) over the drive of:
+ *   "odometry_rms"    wheel speeds integrated along the IMU heading, as TankOdometry does
+ *   "ekf_rms"         the estimator, with each reading stamped with when it was taken
+ *   "ekf_late_rms"    the estimator, with readings stamped when they arrive instead
+ * and fails if the estimator is over EKF_MAX_RMS, or isn't better than odometry
+ * ("ekf_over_odometry" under 1).
+ */
+#include "bench.h"
+#include <cmath>
+#include <stdint.h>
+#include "../core/include/utils/pose_estimator.h"
+
+namespace
+{
+#define RUN_STEPS 1500 // 15s at 10ms
+#define STEP_MS 10
+#define ODOMETRY_DELAY_STEPS 3
+#define IMU_DELAY_STEPS 1
+#define EKF_MAX_RMS 2.0 // inches; it's been 1.35, against 10.4 for odometry
+
+PoseEstimator::estimator_config_t estimator_config = {
+    .accel_noise = 10,
+    .yaw_accel_noise = 4,
+    .odometry_noise = 3,
+    .heading_noise = .01,
+    .yaw_rate_noise = .05,
+    .slip_gate = 2.5};
+
+/**
+ * Deterministic normally distributed noise, so every run sees the same data
+ */
+struct noise_t
+{
+  uint32_t seed = 12345;
+
+  double uniform()
+  {
+    seed = seed * 1664525u + 1013904223u;
+    return ((seed >> 8) + .5) / (double)(1 << 24);
+  }
+
+  double normal(double stddev)
+  {
+    return stddev * std::sqrt(-2 * std::log(uniform())) * std::cos(2 * M_PI * uniform());
+  }
+};
+
+struct truth_t
+{
+  double x, y, heading, forward, left, omega, accel_forward, accel_left;
+};
+
+struct reading_t
+{
+  double wheel_forward, wheel_left, heading, omega, accel_forward, accel_left;
+};
+
+/**
+ * Speeds and turn rate at (t): speeding up and slowing down while weaving and strafing
+ */
+void truth_speeds(double t, double &forward, double &left, double &omega)
+{
+  forward = 30 + 20 * std::sin(.5 * t);
+  left = 10 * std::sin(.3 * t);
+  omega = .8 * std::sin(.4 * t);
+}
+
+void make_run(truth_t *truth, reading_t *readings)
+{
+  noise_t noise;
+  double x = 0, y = 0, heading = 0, dt = STEP_MS / 1000.0;
+  int slip_steps = 0;
+  double slip = 0;
+
+  for (int i = 0; i < RUN_STEPS; i++)
+  {
+    double t = i * dt, forward, left, omega, next_forward, next_left, next_omega;
+    truth_speeds(t, forward, left, omega);
+    truth_speeds(t + dt, next_forward, next_left, next_omega);
+
+    // What an accelerometer turning with the robot feels
+    double accel_forward = (next_forward - forward) / dt - omega * left;
+    double accel_left = (next_left - left) / dt + omega * forward;
+    truth[i] = {x, y, heading, forward, left, omega, accel_forward, accel_left};
+
+    // Now and then a wheel spins up for a few hundred ms
+    if (slip_steps == 0 && noise.uniform() < .005)
+    {
+      slip_steps = 20 + (int)(noise.uniform() * 20);
+      slip = noise.normal(15);
+    }
+    double wheel_slip = slip_steps > 0 ? slip : 0;
+    slip_steps -= slip_steps > 0 ? 1 : 0;
+
+    readings[i].wheel_forward = forward * 1.01 + wheel_slip + noise.normal(2);
+    readings[i].wheel_left = left * 1.01 + noise.normal(2);
+    readings[i].heading = heading + .002 * t + noise.normal(.005);
+    readings[i].omega = omega + noise.normal(.03);
+    readings[i].accel_forward = accel_forward + noise.normal(10);
+    readings[i].accel_left = accel_left + noise.normal(10);
+
+    double c = std::cos(heading), s = std::sin(heading);
+    x += (c * forward - s * left) * dt;
+    y += (s * forward + c * left) * dt;
+    heading += omega * dt;
+  }
+}
+
+/**
+ * Run the estimator over the readings, which arrive late. With (stamped), each reading
+ * says when it was taken. Returns the RMS position error.
+ */
+double run_estimator(const truth_t *truth, const reading_t *readings, bool stamped)
+{
+  PoseEstimator estimator(estimator_config);
+  PoseEstimator::state_t start = {0, 0, 0, (scalar_t)truth[0].forward, (scalar_t)truth[0].left, (scalar_t)truth[0].omega};
+  estimator.reset(start, 0);
+
+  double sum_sq = 0;
+  for (int i = 1; i < RUN_STEPS; i++)
+  {
+    uint32_t now = i * STEP_MS;
+    estimator.predict(now, readings[i].accel_forward, readings[i].accel_left);
+
+    // Readings arriving now were taken a few steps ago
+    if (i >= IMU_DELAY_STEPS)
+    {
+      const reading_t &imu = readings[i - IMU_DELAY_STEPS];
+      uint32_t taken = stamped ? now - IMU_DELAY_STEPS * STEP_MS : now;
+      estimator.add_heading(taken, imu.heading);
+      estimator.add_yaw_rate(taken, imu.omega);
+    }
+    if (i >= ODOMETRY_DELAY_STEPS)
+    {
+      const reading_t &wheels = readings[i - ODOMETRY_DELAY_STEPS];
+      estimator.add_odometry(stamped ? now - ODOMETRY_DELAY_STEPS * STEP_MS : now, wheels.wheel_forward,
+                             wheels.wheel_left);
+    }
+
+    PoseEstimator::state_t state = estimator.get_state();
+    sum_sq += (state.x - truth[i].x) * (state.x - truth[i].x) + (state.y - truth[i].y) * (state.y - truth[i].y);
+  }
+  return std::sqrt(sum_sq / (RUN_STEPS - 1));
+}
+
+/**
+ * Wheel speeds integrated along the IMU heading, as the readings arrive
+ */
+double run_odometry(const truth_t *truth, const reading_t *readings)
+{
+  double x = 0, y = 0, dt = STEP_MS / 1000.0, sum_sq = 0;
+  for (int i = 1; i < RUN_STEPS; i++)
+  {
+    if (i >= ODOMETRY_DELAY_STEPS)
+    {
+      const reading_t &wheels = readings[i - ODOMETRY_DELAY_STEPS];
+      double heading = readings[i - IMU_DELAY_STEPS].heading;
+      x += (std::cos(heading) * wheels.wheel_forward - std::sin(heading) * wheels.wheel_left) * dt;
+      y += (std::sin(heading) * wheels.wheel_forward + std::cos(heading) * wheels.wheel_left) * dt;
+    }
+    sum_sq += (x - truth[i].x) * (x - truth[i].x) + (y - truth[i].y) * (y - truth[i].y);
+  }
+  return std::sqrt(sum_sq / (RUN_STEPS - 1));
+}
+
+truth_t run_truth[RUN_STEPS];
+reading_t run_readings[RUN_STEPS];
+} // namespace
+
+BENCHMARK(pose_estimator_step)
+{
+  make_run(run_truth, run_readings);
+  PoseEstimator estimator(estimator_config);
+
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    const reading_t &r = run_readings[i % RUN_STEPS];
+    uint32_t now = (uint32_t)(i + 1) * STEP_MS;
+    estimator.predict(now, r.accel_forward, r.accel_left);
+    estimator.add_heading(now - STEP_MS, r.heading);
+    estimator.add_yaw_rate(now - STEP_MS, r.omega);
+    estimator.add_odometry(now - 3 * STEP_MS, r.wheel_forward, r.wheel_left);
+    bench::keep(estimator.get_state());
+  }
+}
+
+BENCHMARK(pose_estimator_error)
+{
+  make_run(run_truth, run_readings);
+
+  double odometry = 0, ekf = 0, late = 0;
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    odometry = run_odometry(run_truth, run_readings);
+    ekf = run_estimator(run_truth, run_readings, true);
+    late = run_estimator(run_truth, run_readings, false);
+  }
+
+  bench::metric("odometry_rms", odometry);
+  bench::limit("ekf_rms", ekf, EKF_MAX_RMS);
+  bench::metric("ekf_late_rms", late);
+  bench::limit("ekf_over_odometry", ekf / odometry, .999);
+}
@@ -0,0 +1,144 @@
+/**
+ * math_bench.cpp
+ *
+ * fast_math.h against the libm functions it replaces. The *_error benchmarks sweep
+ * (iters) evenly spaced inputs across the domain the drive code uses and report the
+ * largest absolute difference from libm (evaluated in double) as "max_error", and fail
+ * if it's over the bound fast_math.h documents.
+ */
+#include "bench.h"
+#include <cmath>
+#include "../core/include/utils/fast_math.h"
+
+namespace
+{
+// Widest angle the sin / cos sweeps cover, in radians: all of the range fast_sincos
+// works out itself, before it hands over to libm. Headings are never wrapped in the
+// drive code, so angles well past one turn do reach these functions.
+const double TRIG_RANGE = FAST_MATH_MAX_ANGLE;
+
+// The documented bounds (fast_math.h), for the build's precision
+const bool FLOAT_MATH = sizeof(scalar_t) == sizeof(float);
+const double ATAN2_BOUND = 2e-6;
+const double SINCOS_BOUND = FLOAT_MATH ? 1e-7 : 2e-9;
+const double IPOW_BOUND = FLOAT_MATH ? 5e-7 : 1e-15; // relative: a few roundings
+
+scalar_t sweep(uint64_t i, uint64_t iters, double lo, double hi)
+{
+  return (scalar_t)(lo + (hi - lo) * (double)i / (double)(iters > 1 ? iters - 1 : 1));
+}
+} // namespace
+
+BENCHMARK(libm_atan2)
+{
+  for (uint64_t i = 0; i < iters; i++)
+    bench::keep(std::atan2((scalar_t)(i % 201) - 100, (scalar_t)(i % 131) - 65));
+}
+
+BENCHMARK(fast_atan2)
+{
+  for (uint64_t i = 0; i < iters; i++)
+    bench::keep(fast_atan2((scalar_t)(i % 201) - 100, (scalar_t)(i % 131) - 65));
+}
+
+BENCHMARK(libm_sincos)
+{
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    scalar_t x = (scalar_t)(i % 1000) * (scalar_t).01;
+    bench::keep(std::sin(x));
+    bench::keep(std::cos(x));
+  }
+}
+
+BENCHMARK(fast_sincos)
+{
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    scalar_t s, c;
+    fast_sincos((scalar_t)(i % 1000) * (scalar_t).01, &s, &c);
+    bench::keep(s);
+    bench::keep(c);
+  }
+}
+
+BENCHMARK(libm_pow)
+{
+  for (uint64_t i = 0; i < iters; i++)
+    bench::keep(std::pow((scalar_t)(i % 200) * (scalar_t).01 - 1, 3));
+}
+
+BENCHMARK(fast_ipow)
+{
+  for (uint64_t i = 0; i < iters; i++)
+    bench::keep(ipow((scalar_t)(i % 200) * (scalar_t).01 - 1, 3));
+}
+
+BENCHMARK(fast_atan2_error)
+{
+  // Inputs on a circle, so every octant and the swap between them are covered
+  double max_error = 0;
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    double t = sweep(i, iters, -M_PI, M_PI);
+    scalar_t y = (scalar_t)std::sin(t), x = (scalar_t)std::cos(t);
+    double error = std::fabs(fast_atan2(y, x) - std::atan2((double)y, (double)x));
+
+    // atan2 jumps from +PI to -PI along the -x axis; both answers are the same angle
+    if (error > M_PI)
+      error = std::fabs(error - 2 * M_PI);
+    if (error > max_error)
+      max_error = error;
+  }
+  bench::limit("max_error", max_error, ATAN2_BOUND);
+}
+
+BENCHMARK(fast_sincos_error)
+{
+  double max_error = 0;
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    scalar_t x = sweep(i, iters, -TRIG_RANGE, TRIG_RANGE);
+    scalar_t s, c;
+    fast_sincos(x, &s, &c);
+
+    double error = std::fmax(std::fabs(s - std::sin((double)x)), std::fabs(c - std::cos((double)x)));
+    if (error > max_error)
+      max_error = error;
+  }
+  bench::limit("max_error", max_error, SINCOS_BOUND);
+
+  // Past the range reduction, it should agree with libm at the same precision, and pass
+  // NaN through
+  scalar_t huge[] = {FAST_MATH_MAX_ANGLE, (scalar_t)2e4, (scalar_t)1e6, (scalar_t)-3e9, (scalar_t)1e30, (scalar_t)INFINITY};
+  int wrong = 0;
+  for (unsigned i = 0; i < sizeof(huge) / sizeof(huge[0]); i++)
+  {
+    scalar_t s, c;
+    fast_sincos(huge[i], &s, &c);
+    scalar_t ls = std::sin(huge[i]), lc = std::cos(huge[i]);
+    wrong += !((s == ls || (std::isnan(s) && std::isnan(ls))) && (c == lc || (std::isnan(c) && std::isnan(lc))));
+  }
+  scalar_t s, c;
+  fast_sincos((scalar_t)NAN, &s, &c);
+  wrong += !(std::isnan(s) && std::isnan(c));
+  bench::limit("out_of_range_wrong", wrong, 0);
+}
+
+BENCHMARK(fast_ipow_error)
+{
+  // Relative, since it's compared against pow in double over the joystick range
+  double max_error = 0;
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    scalar_t x = sweep(i, iters, -1, 1);
+    for (int n = 1; n <= 4; n++)
+    {
+      double exact = std::pow((double)x, n);
+      double error = std::fabs(ipow(x, n) - exact) / (std::fabs(exact) > 1e-6 ? std::fabs(exact) : 1e-6);
+      if (error > max_error)
+        max_error = error;
+    }
+  }
+  bench::limit("max_rel_error", max_error, IPOW_BOUND);
+}
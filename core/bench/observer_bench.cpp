@@ -0,0 +1,117 @@
+/**
+ * observer_bench.cpp
+ *
+ * StateObserver (state_observer.h) on a synthetic steering motor. The motor swings back
+ * and forth with smooth moves of varied size, and is read every 5ms, give or take a
+ * millisecond of loop jitter, through an encoder with 0.4 degree steps.
+ * state_observer_error reports the RMS velocity error (rpm) of:
+ *   "differenced_rms"  the change in position over the measured time step
+ *   "observer_rms"     the observer
+ * and "observer_accel_rms", the observer's acceleration error (rpm/s).
+ */
+#include "bench.h"
+#include <cmath>
+#include <stdint.h>
+#include "../core/include/utils/state_observer.h"
+
+namespace
+{
+#define RUN_SAMPLES 4000
+#define PERIOD_S .005
+#define JITTER_S .001
+#define ENCODER_STEP_DEG .4
+
+StateObserver::observer_config_t observer_config = {.position_noise = .5, .jerk_noise = 5e4};
+
+struct sample_t
+{
+  double dt, position, velocity, acceleration; // degrees, deg/s, deg/s^2
+};
+
+/**
+ * Motor position (degrees) at (t): moves between targets that change every .3s, each
+ * a smooth (raised cosine) velocity pulse
+ */
+void motion(double t, double &position, double &velocity, double &acceleration)
+{
+  const double move_s = .3;
+  int move = (int)(t / move_s);
+  double from = 0, to = 0;
+  for (int i = 0; i <= move; i++)
+  {
+    from = to;
+    to = 90 * std::sin(i * 2.4) * ((i % 3) + 1) / 3; // pseudo-random targets
+  }
+
+  double u = (t - move * move_s) / move_s, distance = to - from;
+  position = from + distance * (u - std::sin(2 * M_PI * u) / (2 * M_PI));
+  velocity = distance / move_s * (1 - std::cos(2 * M_PI * u));
+  acceleration = distance / (move_s * move_s) * 2 * M_PI * std::sin(2 * M_PI * u);
+}
+
+void make_run(sample_t *samples)
+{
+  uint32_t seed = 12345;
+  double t = 0;
+  for (int i = 0; i < RUN_SAMPLES; i++)
+  {
+    seed = seed * 1664525u + 1013904223u;
+    double jitter = ((seed >> 8) / (double)(1 << 24) * 2 - 1) * JITTER_S;
+    double dt = i == 0 ? 0 : PERIOD_S + jitter;
+    t += dt;
+
+    double position;
+    motion(t, position, samples[i].velocity, samples[i].acceleration);
+    samples[i].dt = dt;
+    samples[i].position = std::floor(position / ENCODER_STEP_DEG) * ENCODER_STEP_DEG;
+  }
+}
+
+sample_t run_samples[RUN_SAMPLES];
+} // namespace
+
+BENCHMARK(state_observer_update)
+{
+  make_run(run_samples);
+  StateObserver observer(observer_config);
+
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    const sample_t &s = run_samples[i % RUN_SAMPLES];
+    observer.update((scalar_t)s.position, (scalar_t)PERIOD_S);
+    bench::keep(observer.get_velocity());
+  }
+}
+
+BENCHMARK(state_observer_error)
+{
+  make_run(run_samples);
+
+  double differenced = 0, observed = 0, accel = 0;
+  for (uint64_t iter = 0; iter < iters; iter++)
+  {
+    StateObserver observer(observer_config);
+    double sum_diff = 0, sum_obs = 0, sum_accel = 0;
+    for (int i = 0; i < RUN_SAMPLES; i++)
+    {
+      const sample_t &s = run_samples[i];
+      observer.update((scalar_t)s.position, (scalar_t)s.dt);
+      if (i == 0)
+        continue;
+
+      double diff = (s.position - run_samples[i - 1].position) / s.dt;
+      sum_diff += (diff - s.velocity) * (diff - s.velocity);
+      sum_obs += (observer.get_velocity() - s.velocity) * (observer.get_velocity() - s.velocity);
+      sum_accel += (observer.get_acceleration() - s.acceleration) * (observer.get_acceleration() - s.acceleration);
+    }
+
+    // deg/s to rpm
+    differenced = std::sqrt(sum_diff / (RUN_SAMPLES - 1)) / 6;
+    observed = std::sqrt(sum_obs / (RUN_SAMPLES - 1)) / 6;
+    accel = std::sqrt(sum_accel / (RUN_SAMPLES - 1)) / 6;
+  }
+
+  bench::metric("differenced_rms", differenced);
+  bench::metric("observer_rms", observed);
+  bench::metric("observer_accel_rms", accel);
+}
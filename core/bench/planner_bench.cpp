@@ -0,0 +1,107 @@
+/**
+ * planner_bench.cpp
+ *
+ * FieldPlanner (field_planner.h) on a full 12' field with a long barrier across the
+ * middle, a shorter one across that, and two round goals:
+ *   field_planner_plan   corner to opposite corner, around the barriers. Reports the
+ *                        waypoints, cells searched, the length of the way (in), and how
+ *                        many points along the curves a path through the waypoints takes
+ *                        aren't clear (fails if any).
+ *   field_planner_turn   the same, starting facing the wall behind the robot, so the first
+ *                        curve has to turn tightly to stay on the field
+ *   field_planner_build  growing the field elements onto the grid, which happens once,
+ *                        or again when they change
+ */
+#include "bench.h"
+#include <cmath>
+#include "../core/include/utils/field_planner.h"
+
+namespace
+{
+#define MAX_WAYPOINTS 16
+
+FieldPlanner::planner_config_t planner_config = {.field_size = 144, .robot_radius = 10};
+
+void add_field(FieldPlanner &planner)
+{
+  planner.add_rectangle(70, 36, 74, 108);
+  planner.add_rectangle(48, 70, 96, 74);
+  planner.add_circle(36, 108, 5);
+  planner.add_circle(108, 36, 5);
+}
+
+Waypoint start = {14, 14, 0};
+Waypoint start_backwards = {14, 14, M_PI};
+Waypoint goal = {130, 130, M_PI / 2};
+
+/**
+ * Point (t) (0 -> 1) along the cubic Hermite curve from (a) to (b), with tangents as long
+ * as the distance between them, as TrajectoryGenerator draws it
+ */
+void curve_point(const Waypoint &a, const Waypoint &b, double t, double &x, double &y)
+{
+  double chord = std::sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+  double t2 = t * t, t3 = t2 * t;
+  double h00 = 2 * t3 - 3 * t2 + 1, h10 = t3 - 2 * t2 + t, h01 = -2 * t3 + 3 * t2, h11 = t3 - t2;
+  x = h00 * a.x + h10 * chord * std::cos(a.angle) + h01 * b.x + h11 * chord * std::cos(b.angle);
+  y = h00 * a.y + h10 * chord * std::sin(a.angle) + h01 * b.y + h11 * chord * std::sin(b.angle);
+}
+
+void plan_field(const Waypoint &from, uint64_t iters)
+{
+  FieldPlanner planner(planner_config);
+  add_field(planner);
+
+  Waypoint waypoints[MAX_WAYPOINTS];
+  int count = 0;
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    count = planner.plan(from, goal, waypoints, MAX_WAYPOINTS);
+    bench::keep(waypoints[count - 1]);
+  }
+
+  // Along each curve, every 1/200 of it
+  double length = 0;
+  int blocked = 0;
+  for (int i = 1; i < count; i++)
+  {
+    double last_x = waypoints[i - 1].x, last_y = waypoints[i - 1].y;
+    for (int j = 1; j <= 200; j++)
+    {
+      double x, y;
+      curve_point(waypoints[i - 1], waypoints[i], j / 200.0, x, y);
+      length += std::sqrt((x - last_x) * (x - last_x) + (y - last_y) * (y - last_y));
+      blocked += !planner.is_clear(x, y);
+      last_x = x;
+      last_y = y;
+    }
+  }
+
+  bench::metric("waypoints", count);
+  bench::metric("expanded", planner.get_expanded());
+  bench::metric("length", length);
+  bench::limit("blocked_points", blocked, 0);
+}
+} // namespace
+
+BENCHMARK(field_planner_plan)
+{
+  plan_field(start, iters);
+}
+
+BENCHMARK(field_planner_turn)
+{
+  plan_field(start_backwards, iters);
+}
+
+BENCHMARK(field_planner_build)
+{
+  FieldPlanner planner(planner_config);
+
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    planner.clear();
+    add_field(planner);
+    bench::keep(planner.is_clear(start.x, start.y));
+  }
+}
@@ -0,0 +1,96 @@
+/**
+ * trajectory_bench.cpp
+ *
+ * TrajectoryGenerator (trajectory_generator.h), on the same path and limits as the
+ * pathfinder_generate benchmark:
+ *   trajectory_generate  the whole path from rest
+ *   trajectory_replan    the rest of it from a pose off the path, already at full speed,
+ *                        as a replan would be. Reports the segments made, how far the last
+ *                        one is from the last waypoint (in), and the hardest acceleration
+ *                        (in/s^2, max_a is 20).
+ *   trajectory_chain     two paths, one carrying straight on from the other, made with the
+ *                        join at the fastest speed the second can stop from. Reports the
+ *                        time to drive both that way and stopping at the join (s), and
+ *                        the hardest acceleration chained (in/s^2).
+ */
+#include "bench.h"
+#include <cmath>
+#include "../core/include/utils/trajectory_generator.h"
+
+namespace
+{
+#define MAX_SEGMENTS 2000
+
+Waypoint bench_path[] = {{0, 0, 0}, {24, 24, 45 * M_PI / 180}, {48, 36, 0}};
+Waypoint replan_path[] = {{10, 6, 30 * M_PI / 180}, {24, 24, 45 * M_PI / 180}, {48, 36, 0}};
+Waypoint chain_first[] = {{0, 0, 0}, {24, 0, 0}};
+Waypoint chain_second[] = {{24, 0, 0}, {48, 24, 90 * M_PI / 180}};
+
+TrajectoryGenerator::generator_config_t generator_config = {.max_v = 10, .max_a = 20, .dt = .01};
+
+Segment segments[MAX_SEGMENTS];
+} // namespace
+
+BENCHMARK(trajectory_generate)
+{
+  TrajectoryGenerator generator(generator_config);
+
+  int length = 0;
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    length = generator.generate(bench_path, 3, 0, 0, segments, MAX_SEGMENTS);
+    bench::keep(segments[length - 1]);
+  }
+
+  bench::metric("segments", length);
+}
+
+BENCHMARK(trajectory_replan)
+{
+  TrajectoryGenerator generator(generator_config);
+
+  int length = 0;
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    length = generator.generate(replan_path, 3, generator_config.max_v, 0, segments, MAX_SEGMENTS);
+    bench::keep(segments[length - 1]);
+  }
+
+  double peak_a = 0;
+  for (int i = 0; i < length; i++)
+    peak_a = std::fabs(segments[i].acceleration) > peak_a ? std::fabs(segments[i].acceleration) : peak_a;
+
+  const Segment &end = segments[length - 1];
+  bench::metric("segments", length);
+  bench::metric("end_error", std::sqrt((end.x - 48) * (end.x - 48) + (end.y - 36) * (end.y - 36)));
+  bench::metric("peak_accel", peak_a);
+}
+
+BENCHMARK(trajectory_chain)
+{
+  TrajectoryGenerator generator(generator_config);
+
+  // The second path is at least 24 * sqrt(2) long
+  double join_v = std::sqrt(2 * generator_config.max_a * 24 * std::sqrt(2.0));
+  join_v = join_v > generator_config.max_v ? generator_config.max_v : join_v;
+
+  int first = 0, second = 0;
+  for (uint64_t i = 0; i < iters; i++)
+  {
+    first = generator.generate(chain_first, 2, 0, join_v, segments, MAX_SEGMENTS);
+    second = generator.generate(chain_second, 2, segments[first - 1].velocity, 0, segments + first,
+                                MAX_SEGMENTS - first);
+    bench::keep(segments[first + second - 1]);
+  }
+
+  double peak_a = 0;
+  for (int i = 0; i < first + second; i++)
+    peak_a = std::fabs(segments[i].acceleration) > peak_a ? std::fabs(segments[i].acceleration) : peak_a;
+
+  int stopped = generator.generate(chain_first, 2, 0, 0, segments, MAX_SEGMENTS) +
+                generator.generate(chain_second, 2, 0, 0, segments, MAX_SEGMENTS);
+
+  bench::metric("chained_s", (first + second) * generator_config.dt);
+  bench::metric("stopped_s", stopped * generator_config.dt);
+  bench::metric("peak_accel", peak_a);
+}
@@ -2,6 +2,9 @@
 #define _MECANUMDRIVE_
 
 #include "vex.h"
+#include "../core/include/utils/scalar.h"
+#include "../core/include/utils/battery_compensation.h"
+#include "../core/include/utils/motor_controller.h"
 
 #ifndef PI
 #define PI 3.141592654
@@ -14,10 +17,25 @@ class MecanumDrive
 
   MecanumDrive(vex::motor &left_front, vex::motor &right_front, vex::motor &left_rear, vex::motor &right_rear);
 
-  void drive(double left_y, double left_x, double right_x, int power=2);
+  void drive(scalar_t left_y, scalar_t left_x, scalar_t right_x, int power=2);
+
+  /**
+   * Drive the wheels by battery-compensated voltage (see battery_compensation.h) instead of
+   * the motors' velocity loops. Pass NULL to go back to velocity control.
+   */
+  void set_battery_compensation(BatteryCompensation *compensation);
+
+  /**
+   * Run each wheel with our own velocity loop (see motor_controller.h) instead of the
+   * motors' internal ones. Pass NULL for all four to go back to those.
+   */
+  void set_controllers(MotorController *left_front, MotorController *right_front, MotorController *left_rear,
+                       MotorController *right_rear);
 
   private:
 
+  BatteryCompensation *compensation = NULL;
+  MotorController *controllers[4] = {NULL, NULL, NULL, NULL}; // lf, rf, lr, rr
 
   vex::motor &left_front, &right_front, &left_rear, &right_rear;
 
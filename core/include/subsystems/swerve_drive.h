@@ -4,6 +4,7 @@
 #include "../core/include/subsystems/swerve_module.h"
 #include "../core/include/utils/vector.h"
 #include "../core/include/utils/pid.h"
+#include "../core/include/utils/collision_detector.h"
 
 #define ROT_DEADBAND 0.2
 #define LAT_DEADBAND 0.2
@@ -28,23 +29,47 @@ void drive(int32_t leftY, int32_t leftX, int32_t rightX);
  * The main control method. Takes a vector and a rotation, and performs vector math to
  * calculate the position/speed for each wheel.
  */
-void drive(Vector lateral, double rotation);
+void drive(Vector lateral, scalar_t rotation);
 
 /**
  * Autonomously drive the robot in (degrees) direction, at (-1.0 -> 1.0) speed, for (inches) distance.
  * Indicate a negative speed or distance, or (preferably) a direction of +-180 degrees for backwards.
  */
-bool auto_drive(double direction, double speed, double distance);
+bool auto_drive(scalar_t direction, scalar_t speed, scalar_t distance);
 
 /**
  * Autonomously turn the robot over it's center axis in degrees. Positive degrees is clockwise, Negative is counter-clockwise
  * Speed is in percent (-1.0 -> 1.0)
  */
-bool auto_turn(double degrees, double speed);
+bool auto_turn(scalar_t degrees, scalar_t speed);
+
+/**
+ * Stop the robot, and abandon any auto_drive / auto_turn in progress so the next call
+ * starts fresh.
+ */
+void stop_auto();
+
+/**
+ * How fast the robot is moving, from the wheels: x to the right and y forward, in inches / second.
+ * Turning in place averages out to zero.
+ */
+Vector::point_t get_velocity();
 
 void set_drive_pid(PID::pid_config_t &config);
 void set_turn_pid(PID::pid_config_t &config);
 
+/**
+ * Stop auto_drive early (returning true) when (detector) says the robot has run into
+ * something. Pass NULL to always drive the full distance.
+ */
+void set_collision_detector(CollisionDetector *detector);
+
+/**
+ * Why the last auto_drive stopped early, or CollisionDetector::NONE if it reached its
+ * target. Check it after an auto_drive to recover, e.g. by backing off.
+ */
+CollisionDetector::cause_t get_collision();
+
 private:
 
 SwerveModule &left_front, &left_rear, &right_front, &right_rear;
@@ -54,6 +79,9 @@ bool auto_turn_init = true;
 PID *drive_pid, *turn_pid;
 vex::inertial &imu;
 
+CollisionDetector *collision_detector = NULL;
+CollisionDetector::cause_t collision = CollisionDetector::NONE;
+
 };
 
 #endif
\ No newline at end of file
@@ -2,6 +2,12 @@
 #define _SWERVEMODULE_
 
 #include "vex.h"
+#include "../core/include/utils/scalar.h"
+#include "../core/include/utils/battery_compensation.h"
+#include "../core/include/utils/motor_controller.h"
+#include "../core/include/utils/power_manager.h"
+#include "../core/include/utils/thermal_model.h"
+#include "../core/include/utils/traction_control.h"
 
 // Gear teeth (input to output): 16, 35
 #define DIR_GEAR_RATIO (16.0/35.0) // ~0.457
@@ -31,7 +37,7 @@ class SwerveModule
      * @param direction_deg Degrees of rotation for the module's direction (clockwise positive, from top)
      * @param speed_pct Speed of the wheel for the module, in percent (-1.0 -> 1.0, positive fwd)
      */
-    void set(double direction_deg, double speed_pct, int power=2);
+    void set(scalar_t direction_deg, scalar_t speed_pct, int power=2);
 
     /**
      * Sets the direction of the module to X degrees (clockwise positive, from top perspective).
@@ -43,13 +49,43 @@ class SwerveModule
      * 
      * @param deg position to set the motor, counter clockwise from the top.
      */
-    bool set_direction(double deg);
+    bool set_direction(scalar_t deg);
 
     /**
      * Sets the speed of the drive motor, taking into account the speed of the direction motor,
      * in percent units (-1.0 -> 1.0)
      */
-    void set_speed(double percent);
+    void set_speed(scalar_t percent);
+
+    /**
+     * Drive the wheel by battery-compensated voltage (see battery_compensation.h) instead of
+     * the motor's velocity loop. Pass NULL to go back to velocity control.
+     */
+    void set_battery_compensation(BatteryCompensation *compensation);
+
+    /**
+     * Run the drive and / or direction motor with our own loops (see motor_controller.h)
+     * instead of the motors' internal ones. Pass NULL for either to go back to those.
+     */
+    void set_controllers(MotorController *drive_controller, MotorController *direction_controller);
+
+    /**
+     * Share a current budget with the other modules (see power_manager.h): drive output is
+     * slew limited and scaled, and steering speed scaled, by (power_manager).
+     */
+    void set_power_manager(PowerManager &power_manager);
+
+    /**
+     * Lower the drive motor's current limit ahead of it overheating (see thermal_model.h)
+     */
+    void set_thermal_model(ThermalModel &thermal_model);
+
+    /**
+     * Hold the wheel to the floor's speed when it slips (see traction_control.h), and count
+     * distance driven by where the module really went. The module's center is (x), (y)
+     * inches from the robot's (right and forward).
+     */
+    void set_traction_control(TractionControl &traction_control, scalar_t x, scalar_t y);
 
     /**
     * Reset the drive encoder to zero
@@ -59,7 +95,13 @@ class SwerveModule
     /**
      * Get 'distance' from the drive motor
      */
-    double get_distance_driven();
+    scalar_t get_distance_driven();
+
+    /**
+     * Which way the wheel is pointing (degrees, clockwise from forward) and how fast it's
+     * rolling that way (inches / second), from the motors' readings
+     */
+    void get_velocity(scalar_t *direction_deg, scalar_t *speed_ips);
 
     bool auto_reverse = false;
 
@@ -86,8 +128,17 @@ class SwerveModule
     vex::motor &direction;
     vex::gearSetting dir_gearing;
     bool inverseDrive;
-    double lastStoredHeading;
-    double driveMulitplier;
+    scalar_t lastStoredHeading;
+    scalar_t driveMulitplier;
+
+    BatteryCompensation *compensation = NULL;
+    MotorController *drive_controller = NULL;
+    MotorController *direction_controller = NULL;
+    PowerManager *power_manager = NULL;
+    int power_index = -1;
+    ThermalModel *thermal_model = NULL;
+    TractionControl *traction_control = NULL;
+    int traction_index = -1;
 
 };
 
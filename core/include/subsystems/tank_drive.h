@@ -5,6 +5,9 @@
 
 #include "vex.h"
 #include "../core/include/utils/pid.h"
+#include "../core/include/utils/battery_compensation.h"
+#include "../core/include/utils/motor_controller.h"
+#include "../core/include/utils/collision_detector.h"
 
 using namespace vex;
 
@@ -17,7 +20,7 @@ public:
     PID::pid_config_t drive_pid;
     PID::pid_config_t turn_pid;
 
-    double wheel_diam;
+    scalar_t wheel_diam;
   };
 
   /**
@@ -36,7 +39,7 @@ public:
    * 
    * left_motors and right_motors are in "percent": -1.0 -> 1.0
    */
-  void drive_tank(double left, double right);
+  void drive_tank(scalar_t left, scalar_t right);
 
   /**
    * Drive the robot using arcade style controls. forward_back controls the linear motion,
@@ -44,7 +47,7 @@ public:
    * 
    * left_motors and right_motors are in "percent": -1.0 -> 1.0
    */
-  void drive_arcade(double forward_back, double left_right);
+  void drive_arcade(scalar_t forward_back, scalar_t left_right);
 
   /**
    * Autonomously drive the robot X inches forward (Negative for backwards), with a maximum speed
@@ -52,7 +55,7 @@ public:
    * 
    * Uses a PID loop for it's control.
    */
-  bool drive_forward(double inches, double percent_speed);
+  bool drive_forward(scalar_t inches, scalar_t percent_speed);
 
   /**
    * Autonomously turn the robot X degrees to the right (negative for left), with a maximum motor speed
@@ -60,7 +63,31 @@ public:
    * 
    * Uses a PID loop for it's control.
    */
-  bool turn_degrees(double degrees, double percent_speed);
+  bool turn_degrees(scalar_t degrees, scalar_t percent_speed);
+
+  /**
+   * Drive the wheels by battery-compensated voltage (see battery_compensation.h) instead of
+   * the motors' velocity loops. Pass NULL to go back to velocity control.
+   */
+  void set_battery_compensation(BatteryCompensation *compensation);
+
+  /**
+   * Run each side with our own velocity loop (see motor_controller.h) instead of the
+   * motors' internal ones. Pass NULL for both to go back to those.
+   */
+  void set_controllers(MotorController *left_controller, MotorController *right_controller);
+
+  /**
+   * Stop drive_forward early (returning true) when (detector) says the robot has run into
+   * something. Pass NULL to always drive the full distance.
+   */
+  void set_collision_detector(CollisionDetector *detector);
+
+  /**
+   * Why the last drive_forward stopped early, or CollisionDetector::NONE if it reached
+   * its target
+   */
+  CollisionDetector::cause_t get_collision();
 
 private:
   tankdrive_config_t &config;
@@ -74,6 +101,13 @@ private:
   inertial &gyro_sensor;
 
   bool initialize_func = true;
+
+  BatteryCompensation *compensation = NULL;
+  MotorController *left_controller = NULL;
+  MotorController *right_controller = NULL;
+
+  CollisionDetector *collision_detector = NULL;
+  CollisionDetector::cause_t collision = CollisionDetector::NONE;
 };
 
 #endif
\ No newline at end of file
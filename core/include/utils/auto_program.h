@@ -0,0 +1,181 @@
+#ifndef _AUTO_PROGRAM_
+#define _AUTO_PROGRAM_
+
+#include <stdint.h>
+#include "vex.h"
+#include "../core/include/utils/scalar.h"
+#include "../core/include/utils/command.h"
+
+/**
+ * auto_program.h
+ *
+ * Autonomous routines loaded from the SD card instead of compiled in. A program file holds
+ * any number of named routines, each a list of actions (drive, turn, follow a path, wait,
+ * run a bound Command, or a parallel block of those). It is compiled from text on a
+ * computer by core/tools/auto_compiler.cpp, loaded once at startup into a fixed table,
+ * and run by a ProgramCommand, so picking and starting a routine costs nothing.
+ *
+ * File format (little endian):
+ *   header   uint32 magic "VXRT", uint16 version, uint16 routine count, uint16 action count,
+ *            uint16 reserved
+ *   routines (count) x { char name[16], uint16 first action, uint16 action count }
+ *   actions  (count) x { uint8 op, uint8 block size, uint16 timeout (ms, 0 = none),
+ *                        float32 args[3] }
+ */
+
+#define AUTO_PROGRAM_MAGIC 0x54525856 // "VXRT"
+#define AUTO_PROGRAM_VERSION 1
+#define AUTO_PROGRAM_HEADER_BYTES 12
+#define AUTO_PROGRAM_ROUTINE_BYTES 20
+#define AUTO_PROGRAM_ACTION_BYTES 16
+#define AUTO_PROGRAM_NAME_LEN 16
+
+#define AUTO_PROGRAM_MAX_ROUTINES 16
+#define AUTO_PROGRAM_MAX_ACTIONS 256
+#define AUTO_PROGRAM_MAX_COMMANDS 32
+#define AUTO_PROGRAM_MAX_BLOCK 8
+
+class AutoProgram
+{
+public:
+  enum op_t
+  {
+    OP_DRIVE = 1,    // args: direction (deg), speed (0 -> 1), distance (in)
+    OP_TURN = 2,     // args: degrees (clockwise), speed (0 -> 1)
+    OP_PATH = 3,     // args: path id
+    OP_WAIT = 4,     // args: seconds
+    OP_COMMAND = 5,  // args: command id, bound with bind()
+    OP_PARALLEL = 6  // the next (block size) actions run at the same time, until all finish
+  };
+
+  struct action_t
+  {
+    uint8_t op;
+    uint8_t block_size;
+    uint16_t timeout_ms;
+    scalar_t args[3];
+  };
+
+  struct routine_t
+  {
+    char name[AUTO_PROGRAM_NAME_LEN + 1];
+    uint16_t first, count;
+  };
+
+  /**
+   * What the drive actions move. Implemented by the robot code for its drivetrain,
+   * with the same "call every tick until it returns true" style as SwerveDrive::auto_drive.
+   */
+  class Drivetrain
+  {
+  public:
+    virtual ~Drivetrain() {}
+
+    virtual bool drive(scalar_t direction_deg, scalar_t speed, scalar_t distance_in) = 0;
+    virtual bool turn(scalar_t degrees, scalar_t speed) = 0;
+
+    /**
+     * Whether the robot has a path (id) to follow. Robots without paths can leave this and
+     * follow_path() as they are: programs that follow a path are then rejected (see
+     * check_paths()).
+     */
+    virtual bool has_path(int id) const { return false; }
+
+    /**
+     * Follow the robot's path (id)
+     */
+    virtual bool follow_path(int id)
+    {
+      fprintf(stderr, "AutoProgram: no path %d on this robot, skipping it\n", id);
+      return true;
+    }
+
+    /**
+     * Stop, and forget any drive / turn in progress (after a timeout, or cancelling)
+     */
+    virtual void stop() = 0;
+  };
+
+  /**
+   * Parse a program from memory. Returns false, leaving the program empty, if it's invalid.
+   */
+  bool load(const uint8_t *data, int32_t len);
+
+  /**
+   * Load a program file from the SD card, with a buffer allocated just for the load.
+   */
+  bool load(vex::brain::sdcard &sd, const char *filename);
+
+  int num_routines() const;
+
+  /**
+   * Index of the routine called (name), or -1
+   */
+  int find(const char *name) const;
+
+  const routine_t &get_routine(int index) const;
+  const action_t &get_action(int index) const;
+
+  /**
+   * Make "command (id)" actions run (command)
+   */
+  void bind(int id, Command &command);
+
+  Command *get_command(int id) const;
+
+  /**
+   * Whether (drivetrain) has every path the program follows. If not, says which are
+   * missing and empties the program, so no routine runs without its paths.
+   */
+  bool check_paths(const Drivetrain &drivetrain);
+
+private:
+  routine_t routines[AUTO_PROGRAM_MAX_ROUTINES];
+  action_t actions[AUTO_PROGRAM_MAX_ACTIONS];
+  int routine_count = 0, action_count = 0;
+
+  Command *commands[AUTO_PROGRAM_MAX_COMMANDS] = {};
+};
+
+/**
+ * Runs one routine of an AutoProgram. Each tick it only looks at the action(s) in
+ * progress, so the cost per tick is that of the actions themselves.
+ */
+class ProgramCommand : public Command
+{
+public:
+  ProgramCommand(AutoProgram &program, AutoProgram::Drivetrain &drivetrain);
+
+  /**
+   * Choose the routine to run next time the command starts. Returns false if there is
+   * no such routine.
+   */
+  bool select(int routine);
+  bool select(const char *name);
+
+  void initialize() override;
+  void execute() override;
+  void end(bool interrupted) override;
+  bool is_finished() override;
+
+private:
+  AutoProgram &program;
+  AutoProgram::Drivetrain &drivetrain;
+
+  int routine = -1;
+  int next = 0, end_index = 0;
+
+  // Actions in progress: one, or each member of a parallel block
+  int running[AUTO_PROGRAM_MAX_BLOCK];
+  bool running_done[AUTO_PROGRAM_MAX_BLOCK];
+  int num_running = 0;
+  int block = -1; // the parallel action, if running a block
+  uint32_t step_start_ms = 0;
+
+  void start_step();
+  void start_action(int index);
+  bool run_action(int index);
+  void stop_action(int index);
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef _BATTERY_COMPENSATION_
+#define _BATTERY_COMPENSATION_
+
+#include "vex.h"
+#include "../core/include/utils/scalar.h"
+
+/**
+ * battery_compensation.h
+ *
+ * Drives motors by voltage instead of through their internal velocity loop, scaled
+ * against the measured battery voltage so a given command gives the same motor voltage,
+ * and so the same acceleration, whether the battery is fresh or tired.
+ *
+ * A V5 voltage command is a duty cycle with 12V as full scale: "6V" is half of whatever
+ * the battery is putting out. Asking for (nominal volts x percent) is turned into the
+ * duty cycle that delivers that on the battery as it is now.
+ *
+ * Pick the nominal voltage a little under what the battery sags to late in a match
+ * (default 11V), so full command can still be delivered then.
+ */
+
+#define BATTERY_NOMINAL_V 11.0
+#define MOTOR_FULL_SCALE_V 12.0 // voltage command meaning 100% duty
+#define BATTERY_SAMPLE_MS 10
+
+class BatteryCompensation
+{
+public:
+  /**
+   * Compensate against (battery), so a command of 1.0 gives (nominal_v) at the motor
+   */
+  BatteryCompensation(vex::brain::battery &battery, scalar_t nominal_v = BATTERY_NOMINAL_V);
+
+  /**
+   * Voltage command (-12 -> 12) that puts (percent) (-1.0 -> 1.0) of the nominal voltage
+   * on a motor. Saturates once the battery can't deliver any more.
+   */
+  scalar_t volts(scalar_t percent);
+
+  /**
+   * Voltage command (-12 -> 12) that puts (volts) on a motor with the battery as it is now
+   */
+  scalar_t command_for(scalar_t volts);
+
+  /**
+   * Spin (motor) / (motors) at (percent) (-1.0 -> 1.0) of the nominal voltage
+   */
+  void spin(vex::motor &motor, scalar_t percent);
+  void spin(vex::motor_group &motors, scalar_t percent);
+
+  /**
+   * Battery voltage, low-pass filtered so one motor's current spike doesn't jolt the
+   * others. Re-read at most every BATTERY_SAMPLE_MS, however many motors ask.
+   */
+  scalar_t battery_voltage();
+
+  scalar_t get_nominal_voltage() const;
+
+private:
+  vex::brain::battery &battery;
+  scalar_t nominal_v;
+
+  scalar_t filtered_v = 0;
+  uint32_t last_sample_ms = 0;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef _COLLISION_DETECTOR_
+#define _COLLISION_DETECTOR_
+
+#include <stdint.h>
+#include "vex.h"
+#include "../core/include/utils/scalar.h"
+
+/**
+ * collision_detector.h
+ *
+ * Notices within a few loops when an autonomous drive has run into something, so the step
+ * can give up (or back off) instead of pushing against it until a timeout. Any one of:
+ *  - impact: the IMU feels the robot slowing down harder (impact_g) than the wheels can
+ *    brake it, which only a hit can. Only against the way it's driving: a hit that
+ *    pushes it along (e.g. backing away from a wall it just hit) doesn't stop it.
+ *  - stall: a drive motor draws (stall_current_a) or more while turning slower than
+ *    (stall_rpm), for (confirm_ms)
+ *  - blocked: the robot is (tracking_error) in/s or more slower than it should be by now,
+ *    for (confirm_ms). What it "should" be doing is the command, lagged by how quickly the
+ *    robot speeds up (response_s), so speeding up from rest doesn't count.
+ *
+ * A drive step calls reset() when it starts and update() every loop after. Once something
+ * is detected it stays detected until the next reset().
+ */
+
+#define COLLISION_DETECTOR_MAX_MOTORS 8
+
+class CollisionDetector
+{
+public:
+  struct collision_config_t
+  {
+    scalar_t impact_g;        // horizontal acceleration (g) more than driving can cause
+    scalar_t stall_current_a; // current a motor draws when pushing against something
+    scalar_t stall_rpm;       // slower than this while drawing it is stalled
+    scalar_t max_speed;       // in/s at full drive output
+    scalar_t response_s;      // time constant the robot's speed follows the command with
+    scalar_t tracking_error;  // in/s slower than expected before the robot is blocked
+    scalar_t confirm_ms;      // how long a stall or blocked robot must last
+  };
+
+  enum cause_t
+  {
+    NONE,
+    IMPACT,
+    STALL,
+    BLOCKED
+  };
+
+  CollisionDetector(vex::inertial &imu, collision_config_t &config);
+
+  /**
+   * Watch (motor) for stalls. Returns false if there are too many.
+   */
+  bool add_motor(vex::motor &motor);
+
+  /**
+   * Start watching a new drive: forget anything detected, with the robot at rest
+   */
+  void reset();
+
+  /**
+   * Check the robot, driving towards (direction_deg) (clockwise from the robot's front)
+   * with the drive commanded at (command) (-1.0 -> 1.0), and moving at (speed) in/s that
+   * way. Call it every loop. Returns true once it has hit something.
+   */
+  bool update(scalar_t direction_deg, scalar_t command, scalar_t speed);
+
+  /**
+   * What was detected since the last reset(), or NONE
+   */
+  cause_t get_cause() const;
+
+  static const char *cause_name(cause_t cause);
+
+private:
+  vex::inertial &imu;
+  collision_config_t &config;
+
+  vex::motor *motors[COLLISION_DETECTOR_MAX_MOTORS];
+  int num_motors = 0;
+
+  cause_t cause = NONE;
+  scalar_t expected = 0; // in/s
+  uint32_t stall_ms = 0, blocked_ms = 0;
+  uint32_t last_update_ms = 0;
+  bool updated = false;
+};
+
+#endif
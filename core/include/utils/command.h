@@ -0,0 +1,302 @@
+#ifndef _COMMAND_
+#define _COMMAND_
+
+#include <initializer_list>
+#include <stdint.h>
+#include "vex.h"
+#include "../core/include/utils/scalar.h"
+#include "../core/include/utils/command_profiler.h"
+
+/**
+ * command.h
+ *
+ * Command-based autonomous. A Command is an object with its own state that is started,
+ * run once per scheduler tick until it reports it is finished, and then ended. Commands
+ * are combined into groups (in sequence, in parallel, as a race, or against a deadline)
+ * and run by a CommandScheduler, so that e.g. the drive and an intake can move at the
+ * same time.
+ *
+ * All storage is fixed size: nothing is allocated while commands are being scheduled or
+ * run.
+ */
+
+#define COMMAND_GROUP_MAX 8       // Commands per group
+#define COMMAND_SCHEDULER_MAX 16  // Commands running at once in one scheduler
+#define COMMAND_SUBSYSTEM_MAX 32  // Different subsystems that can be required
+
+class Command
+{
+public:
+  virtual ~Command() {}
+
+  /**
+   * Called once when the command starts
+   */
+  virtual void initialize() {}
+
+  /**
+   * Called every tick while the command is running
+   */
+  virtual void execute() {}
+
+  /**
+   * Called once when the command stops. interrupted is false if it stopped because
+   * is_finished() returned true, and true if it was cancelled or timed out.
+   */
+  virtual void end(bool interrupted) {}
+
+  /**
+   * Checked after every execute(). Return true when the command is done.
+   */
+  virtual bool is_finished() { return false; }
+
+  /**
+   * Stop the command (interrupted) if it runs longer than (seconds). 0 for no timeout.
+   */
+  Command &with_timeout(scalar_t seconds);
+
+  /**
+   * Name the command, for the CommandProfiler report. Must be a string literal or
+   * otherwise outlive the command.
+   */
+  Command &set_name(const char *name);
+
+  const char *get_name() const;
+
+  /**
+   * Mark this command as using a subsystem (any object, e.g. the drivetrain). A
+   * scheduler never runs two commands that require the same subsystem.
+   */
+  Command &add_requirement(const void *subsystem);
+
+  /**
+   * Bitmask of the subsystems this command requires
+   */
+  virtual uint32_t get_requirements() const;
+
+  /**
+   * Start the command: calls initialize() and starts the timeout.
+   * Used by CommandScheduler and the command groups.
+   */
+  void start();
+
+  /**
+   * Run one tick of the command. Returns true, after calling end(), if the command
+   * finished or timed out on this tick.
+   */
+  bool step();
+
+  /**
+   * Stop the command early, calling end(true), if it is running.
+   */
+  void cancel();
+
+  /**
+   * Whether the command has been started and has not yet ended
+   */
+  bool is_running() const;
+
+  /**
+   * Whether the command's last run ended because of its timeout
+   */
+  bool timed_out() const;
+
+protected:
+  uint32_t requirements = 0;
+  const char *name = "command";
+
+private:
+  scalar_t timeout = 0;
+  uint32_t start_time_ms = 0;
+  bool running = false;
+  bool did_time_out = false;
+
+  // CommandProfiler record for the current run, if one is recording
+  int profile_id = -1;
+  uint32_t profile_generation = 0;
+
+  void profile_end(CommandProfiler::end_reason_t reason);
+};
+
+/**
+ * Runs a plain function every tick until it returns true, the same as a GenericAuto state.
+ * The second form passes (arg) to the function, so one function can be reused with
+ * different parameters.
+ */
+class FunctionCommand : public Command
+{
+public:
+  FunctionCommand(bool (*func)());
+  FunctionCommand(bool (*func)(void *), void *arg);
+
+  void execute() override;
+  bool is_finished() override;
+
+private:
+  bool (*func)();
+  bool (*func_arg)(void *);
+  void *arg;
+  bool done = false;
+};
+
+/**
+ * Does nothing for (seconds). Useful in sequences and as a deadline.
+ */
+class WaitCommand : public Command
+{
+public:
+  WaitCommand(scalar_t seconds);
+
+  void initialize() override;
+  bool is_finished() override;
+
+private:
+  uint32_t duration_ms, start_ms = 0;
+};
+
+/**
+ * Base for commands made up of other commands. The group requires every subsystem its
+ * children require.
+ */
+class CommandGroup : public Command
+{
+public:
+  /**
+   * Add a command to the end of the group. Returns false, and leaves the command out, if
+   * the group is full, or if it's one of the groups that run their commands at once
+   * (ParallelGroup, RaceGroup, DeadlineGroup) and the command requires a subsystem
+   * another of them already requires.
+   */
+  bool add(Command &command);
+
+  /**
+   * Whether every command given to the group, in its constructor or add(), was added.
+   * Check it where the group is made: a group missing a command still runs the rest.
+   */
+  bool is_complete() const;
+
+  /**
+   * The group's own requirements, plus everything its commands require
+   */
+  uint32_t get_requirements() const override;
+
+protected:
+  CommandGroup(std::initializer_list<Command *> commands, bool parallel);
+
+  Command *children[COMMAND_GROUP_MAX];
+  int num_children = 0;
+
+private:
+  bool parallel; // children run at once, so mustn't share subsystems
+  bool complete = true;
+};
+
+/**
+ * Runs each command after the previous one finishes
+ */
+class SequentialGroup : public CommandGroup
+{
+public:
+  SequentialGroup(std::initializer_list<Command *> commands = {});
+
+  void initialize() override;
+  void execute() override;
+  void end(bool interrupted) override;
+  bool is_finished() override;
+
+private:
+  int current = 0;
+};
+
+/**
+ * Runs all commands at once, and finishes when all of them have finished.
+ * The commands can't require the same subsystem as each other (see add()).
+ */
+class ParallelGroup : public CommandGroup
+{
+public:
+  ParallelGroup(std::initializer_list<Command *> commands = {});
+
+  void initialize() override;
+  void execute() override;
+  void end(bool interrupted) override;
+  bool is_finished() override;
+};
+
+/**
+ * Runs all commands at once, and finishes as soon as any one of them finishes.
+ * The rest are cancelled.
+ */
+class RaceGroup : public ParallelGroup
+{
+public:
+  RaceGroup(std::initializer_list<Command *> commands = {});
+
+  bool is_finished() override;
+};
+
+/**
+ * Runs all commands at once, and finishes when the first command (the deadline)
+ * finishes. Any others still running are cancelled.
+ */
+class DeadlineGroup : public ParallelGroup
+{
+public:
+  DeadlineGroup(std::initializer_list<Command *> commands = {});
+
+  bool is_finished() override;
+};
+
+/**
+ * Runs commands, one tick at a time, at the control loop rate.
+ */
+class CommandScheduler
+{
+public:
+  /**
+   * Start running a command. Any running command that requires one of the same
+   * subsystems is cancelled first. Returns false if the command could not be scheduled
+   * because too many are already running.
+   */
+  bool schedule(Command &command);
+
+  /**
+   * Stop a running command, calling its end(true)
+   */
+  void cancel(Command &command);
+
+  /**
+   * Stop every running command
+   */
+  void cancel_all();
+
+  /**
+   * Run one tick of every scheduled command, removing those that finish.
+   * Call this once per loop.
+   */
+  void run();
+
+  /**
+   * Whether the command is currently scheduled
+   */
+  bool is_scheduled(Command &command) const;
+
+  /**
+   * Whether no commands are scheduled
+   */
+  bool is_idle() const;
+
+  /**
+   * Call run() every (period_ms) until every scheduled command has finished.
+   */
+  void run_until_idle(uint32_t period_ms = 20);
+
+private:
+  Command *scheduled[COMMAND_SCHEDULER_MAX];
+  int num_scheduled = 0;
+  bool in_run = false;
+
+  void compact();
+};
+
+#endif
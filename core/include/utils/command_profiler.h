@@ -0,0 +1,104 @@
+#ifndef _COMMAND_PROFILER_
+#define _COMMAND_PROFILER_
+
+#include <stdint.h>
+#include "vex.h"
+
+class Command;
+
+#define PROFILER_MAX_RECORDS 96
+#define PROFILER_MAX_DEPTH 8
+
+/**
+ * command_profiler.h
+ *
+ * Records when every command (and every group / routine inside it) starts and ends,
+ * how many ticks it ran, how long it spent actually executing vs waiting for the next
+ * tick, and why it ended. report() prints the whole run as a tree, with the commands
+ * that set the total time (the critical path) marked with '*'.
+ *
+ * Code that runs inside a command can split its time into named phases with
+ * CommandProfiler::phase(), e.g. SwerveDrive::auto_drive marks the time spent turning
+ * the modules before it starts driving as "align".
+ *
+ * Records are kept in a fixed size table; once it is full, later commands are not
+ * recorded.
+ */
+class CommandProfiler
+{
+public:
+  enum end_reason_t
+  {
+    RUNNING, FINISHED, CANCELLED, TIMED_OUT
+  };
+
+  struct record_t
+  {
+    const char *name;
+    bool is_phase;
+    int parent, depth;
+    uint64_t start_us, end_us, busy_us;
+    uint32_t ticks;
+    end_reason_t reason;
+  };
+
+  /**
+   * Start recording (clearing anything recorded before). Only one profiler records
+   * at a time.
+   */
+  void start();
+
+  /**
+   * Stop recording. Commands still running are reported as such.
+   */
+  void stop();
+
+  /**
+   * Print the report to stdout, and a summary of the critical path to (screen) if given
+   */
+  void report(vex::brain::lcd *screen = NULL);
+
+  /**
+   * Records made so far, in the order the commands started
+   */
+  const record_t *get_records(int *count) const;
+
+  /**
+   * Name the part of the running command that the code after this call belongs to,
+   * until the next call or the command ends. NULL ends the current phase.
+   * Does nothing if no profiler is recording.
+   */
+  static void phase(const char *name);
+
+  // Hooks called by Command and CommandScheduler. Record ids are only valid for the
+  // generation (call to start()) they were made in.
+  static CommandProfiler *active;
+  static uint32_t generation;
+
+  int command_started(const char *name);
+  uint64_t enter(int id);
+  void leave(int id, uint64_t enter_us, bool is_tick);
+  void command_ended(int id, end_reason_t reason);
+  void tick_started();
+  void tick_ended();
+
+private:
+  record_t records[PROFILER_MAX_RECORDS];
+  int num_records = 0;
+
+  // Records of the commands currently executing, innermost last, and each one's open phase
+  int stack[PROFILER_MAX_DEPTH];
+  int open_phase[PROFILER_MAX_RECORDS];
+  int stack_depth = 0;
+
+  uint64_t start_us = 0, stop_us = 0;
+  uint64_t tick_start_us = 0, tick_us = 0;
+  uint32_t ticks = 0;
+
+  int innermost() const;
+  void end_phase(int id, uint64_t now);
+  bool is_critical(int id) const;
+  void add_children(int parent, int *order, int *count) const;
+};
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef _FAST_MATH_
+#define _FAST_MATH_
+
+#include <cmath>
+#include "../core/include/utils/scalar.h"
+
+/**
+ * fast_math.h
+ *
+ * Polynomial approximations of the trig functions the drive code calls every loop, and
+ * integer powers for the joystick curves. Defined inline here so they are inlined into
+ * the control loops. sqrt is left to std::sqrt, which the V5's FPU does in hardware.
+ *
+ * Maximum absolute errors (measured over the whole input domain by core/bench/math_bench.cpp):
+ *  fast_atan2  2e-6 rad
+ *  fast_sin    2e-9 in double, 1e-7 in float, for |x| < FAST_MATH_MAX_ANGLE (1e4)
+ *  fast_cos    same as fast_sin
+ *  ipow        exact up to rounding (repeated multiplication)
+ * math_bench fails (core_bench exits non-zero) if any of these are exceeded.
+ *
+ * fast_sin / fast_cos hand angles from FAST_MATH_MAX_ANGLE up, infinities and NaN to
+ * std::sin / std::cos, so they are as accurate (and as slow) as libm there: the range
+ * reduction needs the number of quarter turns to fit in an int, and to be small enough
+ * that its multiples of FAST_MATH_HALF_PI_1 are exact.
+ */
+
+#define FAST_MATH_PI ((scalar_t)3.14159265358979323846)
+#define FAST_MATH_HALF_PI ((scalar_t)1.57079632679489661923)
+
+// PI/2 split into parts with few enough bits that multiples of them are exact (Cody-Waite)
+#define FAST_MATH_HALF_PI_1 ((scalar_t)1.5703125)
+#define FAST_MATH_HALF_PI_2 ((scalar_t)4.837512969970703125e-4)
+#define FAST_MATH_HALF_PI_3 ((scalar_t)7.54978995489188216e-8)
+#define FAST_MATH_QUARTER_PI ((scalar_t)0.78539816339744830962)
+#define FAST_MATH_TWO_OVER_PI ((scalar_t)0.63661977236758134308)
+
+// Under 2^13 quarter turns, so quarter turns * FAST_MATH_HALF_PI_1 (8 bits) fits a float.
+// math_bench measures the error bounds above up to it.
+#define FAST_MATH_MAX_ANGLE ((scalar_t)1e4)
+
+/**
+ * atan(x) for |x| <= 1. 11th order odd minimax polynomial (Hastings).
+ */
+inline scalar_t fast_atan_unit(scalar_t x)
+{
+  scalar_t x2 = x * x;
+  return x * ((scalar_t)0.99997726 + x2 * ((scalar_t)-0.33262347 + x2 * ((scalar_t)0.19354346
+          + x2 * ((scalar_t)-0.11643287 + x2 * ((scalar_t)0.05265332 + x2 * (scalar_t)-0.01172120)))));
+}
+
+/**
+ * Drop-in replacement for atan2(y, x), in radians (-PI -> PI)
+ */
+inline scalar_t fast_atan2(scalar_t y, scalar_t x)
+{
+  scalar_t ax = x < 0 ? -x : x;
+  scalar_t ay = y < 0 ? -y : y;
+
+  if (ax == 0 && ay == 0)
+    return 0;
+
+  // Keep the polynomial's input within [0, 1] by swapping octants
+  scalar_t angle = ay > ax ? FAST_MATH_HALF_PI - fast_atan_unit(ax / ay) : fast_atan_unit(ay / ax);
+
+  if (x < 0)
+    angle = FAST_MATH_PI - angle;
+  return y < 0 ? -angle : angle;
+}
+
+/**
+ * Sine and cosine of (x) radians, computed together.
+ * The angle is reduced to within +-PI/4 of a multiple of PI/2, where short Taylor
+ * polynomials are accurate to about a float ulp.
+ */
+inline void fast_sincos(scalar_t x, scalar_t *sin_out, scalar_t *cos_out)
+{
+  // Written so NaN takes this branch too
+  if (!(x > -FAST_MATH_MAX_ANGLE && x < FAST_MATH_MAX_ANGLE))
+  {
+    *sin_out = std::sin(x);
+    *cos_out = std::cos(x);
+    return;
+  }
+
+  // Nearest quarter turn, and the remainder from it
+  scalar_t quarters = x * FAST_MATH_TWO_OVER_PI;
+  int quadrant = (int)(quarters + (quarters >= 0 ? (scalar_t).5 : (scalar_t)-.5));
+  scalar_t r = ((x - quadrant * FAST_MATH_HALF_PI_1) - quadrant * FAST_MATH_HALF_PI_2) - quadrant * FAST_MATH_HALF_PI_3;
+  scalar_t r2 = r * r;
+
+  scalar_t s = r * (1 + r2 * ((scalar_t)(-1.0 / 6) + r2 * ((scalar_t)(1.0 / 120) + r2 * ((scalar_t)(-1.0 / 5040)
+          + r2 * (scalar_t)(1.0 / 362880)))));
+  scalar_t c = 1 + r2 * ((scalar_t)-.5 + r2 * ((scalar_t)(1.0 / 24) + r2 * ((scalar_t)(-1.0 / 720)
+          + r2 * ((scalar_t)(1.0 / 40320) + r2 * (scalar_t)(-1.0 / 3628800)))));
+
+  switch (quadrant & 3)
+  {
+  case 0:
+    *sin_out = s;
+    *cos_out = c;
+    break;
+  case 1:
+    *sin_out = c;
+    *cos_out = -s;
+    break;
+  case 2:
+    *sin_out = -s;
+    *cos_out = -c;
+    break;
+  default:
+    *sin_out = -c;
+    *cos_out = s;
+    break;
+  }
+}
+
+inline scalar_t fast_sin(scalar_t x)
+{
+  scalar_t s, c;
+  fast_sincos(x, &s, &c);
+  return s;
+}
+
+inline scalar_t fast_cos(scalar_t x)
+{
+  scalar_t s, c;
+  fast_sincos(x, &s, &c);
+  return c;
+}
+
+/**
+ * x to an integer power, by squaring. Replaces pow(x, n), which goes through exp/log.
+ */
+inline scalar_t ipow(scalar_t x, int n)
+{
+  if (n < 0)
+    return 1 / ipow(x, -n);
+
+  scalar_t result = 1;
+  while (n > 0)
+  {
+    if (n & 1)
+      result *= x;
+    x *= x;
+    n >>= 1;
+  }
+  return result;
+}
+
+/**
+ * x to an integer power, keeping the sign of x even for even powers. Used for
+ * joystick / speed curves, where squaring shouldn't turn "backwards" into "forwards".
+ */
+inline scalar_t signed_ipow(scalar_t x, int n)
+{
+  scalar_t result = ipow(x, n);
+  return (n % 2 == 0 && x < 0) ? -result : result;
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef _FIELD_PLANNER_
+#define _FIELD_PLANNER_
+
+#include <stdint.h>
+#include "../core/include/utils/scalar.h"
+#include "../core/include/pathfinder/structs.h"
+
+/**
+ * field_planner.h
+ *
+ * Plans a way across the field around its fixed elements, as a Waypoint list for
+ * SplinePath (pathfinder_prepare), so a new target doesn't mean re-plotting points by
+ * hand.
+ *
+ * The field elements are rectangles and circles. They, and the field walls, are grown by
+ * (robot_radius) onto a grid of FIELD_PLANNER_CELLS x FIELD_PLANNER_CELLS cells, so the
+ * center of the robot can go on any cell left free. plan() searches the grid (A*, moving
+ * to any of the 8 cells around), then pulls the result tight into straight lines between
+ * the fewest corners that can still see each other. Each corner becomes a waypoint, facing
+ * along the way through it.
+ *
+ * Last, the curves a path through the waypoints will actually take (cubic Hermite, with
+ * tangents as long as the distance between the waypoints, as TrajectoryGenerator and
+ * pathfinder's FIT_HERMITE_CUBIC draw them) are checked against the grid. Where one
+ * crosses a blocked cell, a waypoint is added halfway along the straight line under it,
+ * facing along that line, which pulls the curves either side of it in towards the line.
+ *
+ * Everything is in fixed arrays: nothing is allocated, and a plan across the whole field
+ * takes a few milliseconds. The grid is only re-made when the elements change.
+ *
+ * Same frame as pathfinder: x and y in inches, from one corner of the field, angles in
+ * radians counter-clockwise from the x axis.
+ */
+
+#define FIELD_PLANNER_MAX_OBSTACLES 32
+#define FIELD_PLANNER_CELLS 72 // along each side of the field
+
+class FieldPlanner
+{
+public:
+  struct planner_config_t
+  {
+    scalar_t field_size;   // inches along each (square) side
+    scalar_t robot_radius; // inches from the center of the robot to its furthest corner, with margin
+  };
+
+  FieldPlanner(planner_config_t &config);
+
+  /**
+   * Add a rectangular field element, from (x_min, y_min) to (x_max, y_max).
+   * Returns false if there are too many.
+   */
+  bool add_rectangle(scalar_t x_min, scalar_t y_min, scalar_t x_max, scalar_t y_max);
+
+  /**
+   * Add a round field element at (x, y). Returns false if there are too many.
+   */
+  bool add_circle(scalar_t x, scalar_t y, scalar_t radius);
+
+  /**
+   * Remove every field element
+   */
+  void clear();
+
+  /**
+   * Fill (waypoints), with room for (max_waypoints), with a way from (start) to (goal)
+   * around the field elements. The first and last waypoints are (start) and (goal)
+   * themselves. If either is too close to an element or wall, the way goes straight to or
+   * from the nearest clear spot (and that curve isn't checked). Returns the number of
+   * waypoints, or -1 if there's no way there or it needs more waypoints than there's room
+   * for.
+   */
+  int plan(const Waypoint &start, const Waypoint &goal, Waypoint *waypoints, int max_waypoints);
+
+  /**
+   * Whether the center of the robot can be at (x, y) without touching anything
+   */
+  bool is_clear(scalar_t x, scalar_t y);
+
+  /**
+   * Cells the last plan() looked at, for judging how hard it was
+   */
+  int get_expanded() const;
+
+private:
+  struct obstacle_t
+  {
+    bool round;
+    scalar_t x_min, y_min, x_max, y_max; // or, if round, center x and y, and radius
+  };
+
+  planner_config_t &config;
+
+  obstacle_t obstacles[FIELD_PLANNER_MAX_OBSTACLES];
+  int num_obstacles = 0;
+
+  bool grid_ready = false;
+  uint8_t blocked[FIELD_PLANNER_CELLS * FIELD_PLANNER_CELLS];
+
+  // The search: cost to reach each cell, the cell it was reached from, and a heap of the
+  // open cells by estimated total cost, with each cell's place in it (-1 if not in it)
+  float cost[FIELD_PLANNER_CELLS * FIELD_PLANNER_CELLS];
+  float estimate[FIELD_PLANNER_CELLS * FIELD_PLANNER_CELLS];
+  int16_t parent[FIELD_PLANNER_CELLS * FIELD_PLANNER_CELLS];
+  int16_t heap[FIELD_PLANNER_CELLS * FIELD_PLANNER_CELLS];
+  int16_t heap_index[FIELD_PLANNER_CELLS * FIELD_PLANNER_CELLS];
+  uint8_t closed[FIELD_PLANNER_CELLS * FIELD_PLANNER_CELLS];
+  int heap_size = 0;
+  int expanded = 0;
+
+  int16_t corners[FIELD_PLANNER_CELLS * FIELD_PLANNER_CELLS]; // the plan, goal first
+
+  void build_grid();
+  int cell_at(scalar_t x, scalar_t y) const;
+  int nearest_clear(int cell) const;
+  bool line_clear(int from, int to) const;
+  bool curve_clear(const Waypoint &from, const Waypoint &to) const;
+
+  void heap_push(int cell);
+  int heap_pop();
+  void heap_up(int place);
+  void heap_down(int place);
+};
+
+#endif
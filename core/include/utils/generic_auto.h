@@ -7,6 +7,10 @@
 
 typedef bool (*state_ptr)();
 
+/**
+ * Runs a list of states one after another. For anything that needs to run at the same
+ * time, carry parameters, or time out, use the commands in command.h instead.
+ */
 class GenericAuto
 {
   public:
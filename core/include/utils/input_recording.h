@@ -0,0 +1,171 @@
+#ifndef _INPUT_RECORDING_
+#define _INPUT_RECORDING_
+
+#include <stdint.h>
+#include "vex.h"
+#include "../core/include/utils/scalar.h"
+#include "../core/include/utils/command.h"
+
+/**
+ * input_recording.h
+ *
+ * Record a driver's controller inputs at a fixed rate, save them to the SD card, and play
+ * them back in autonomous through the same drive code the driver used.
+ *
+ * Each frame is 10 bytes: the 4 joystick axes, the buttons, and optionally the robot's
+ * heading and distance travelled at that moment. Replays can steer against those to
+ * correct for drift (see ReplayCommand::with_correction).
+ *
+ * File format (little endian): a 16 byte header
+ *   uint32 magic "VXIR", uint16 version, uint16 flags, uint32 period_ms, uint32 frame count
+ * followed by the frames
+ *   int8 axis1..axis4, uint16 buttons, int16 heading (0.01 deg), uint16 distance (0.1 in)
+ */
+
+#define INPUT_RECORDING_MAGIC 0x52495856 // "VXIR"
+#define INPUT_RECORDING_VERSION 1
+#define INPUT_RECORDING_HEADER_BYTES 16
+#define INPUT_RECORDING_FRAME_BYTES 10
+
+class InputRecording
+{
+public:
+  struct frame_t
+  {
+    int8_t axis[4]; // Axis1 -> Axis4, percent
+    uint16_t buttons; // button_t bits
+    scalar_t heading_deg; // -180 -> 180, clockwise positive from where the recording started
+    scalar_t distance_in; // distance travelled since the recording started
+  };
+
+  enum button_t
+  {
+    BUTTON_A = 1 << 0, BUTTON_B = 1 << 1, BUTTON_X = 1 << 2, BUTTON_Y = 1 << 3,
+    BUTTON_UP = 1 << 4, BUTTON_DOWN = 1 << 5, BUTTON_LEFT = 1 << 6, BUTTON_RIGHT = 1 << 7,
+    BUTTON_L1 = 1 << 8, BUTTON_L2 = 1 << 9, BUTTON_R1 = 1 << 10, BUTTON_R2 = 1 << 11
+  };
+
+  /**
+   * Where the heading / distance traces come from, for recording and for correcting a
+   * replay. Implemented by the robot code.
+   */
+  class Sensors
+  {
+  public:
+    virtual ~Sensors() {}
+
+    /**
+     * Called when a recording or replay starts. Heading and distance are measured from here.
+     */
+    virtual void reset() = 0;
+
+    /**
+     * Current heading (degrees, clockwise positive) and distance travelled (inches)
+     */
+    virtual void read(scalar_t *heading_deg, scalar_t *distance_in) = 0;
+  };
+
+  /**
+   * Create a recording with room for (max_frames) frames, sampled every (period_ms).
+   * The buffer is allocated once, here.
+   */
+  InputRecording(uint32_t max_frames, uint32_t period_ms = 10);
+  ~InputRecording();
+
+  /**
+   * Read the controller's axes and buttons into a frame
+   */
+  static frame_t sample(vex::controller &controller);
+
+  /**
+   * Clear the recording and start sampling (controller), and (sensors) if given, in a
+   * background task until stop_recording() is called or the buffer is full.
+   */
+  void start_recording(vex::controller &controller, Sensors *sensors = NULL);
+
+  /**
+   * Stop a recording started with start_recording(), waiting (up to a frame) for the
+   * background task to finish
+   */
+  void stop_recording();
+
+  bool is_recording() const;
+
+  /**
+   * Number of frames recorded / loaded
+   */
+  uint32_t size() const;
+
+  uint32_t get_period_ms() const;
+
+  /**
+   * Whether the frames include heading / distance
+   */
+  bool has_sensors() const;
+
+  /**
+   * Get frame (index), 0 -> size() - 1
+   */
+  frame_t get(uint32_t index) const;
+
+  /**
+   * Write the recording to (filename) on the SD card. Returns false if it couldn't.
+   */
+  bool save(vex::brain::sdcard &sd, const char *filename);
+
+  /**
+   * Replace the recording with the one in (filename) on the SD card. Returns false,
+   * leaving the recording empty, if the file is missing, damaged or too big.
+   */
+  bool load(vex::brain::sdcard &sd, const char *filename);
+
+private:
+  uint8_t *buffer; // header, then encoded frames
+  uint32_t max_frames, num_frames = 0;
+  uint32_t period_ms;
+  bool sensors_recorded = false;
+
+  volatile bool recording = false;
+  volatile bool task_running = false; // until the task has stopped touching the buffer
+  vex::controller *controller = NULL;
+  Sensors *sensors = NULL;
+
+  void append(const frame_t &frame);
+  static int record_task(void *self);
+};
+
+/**
+ * Plays an InputRecording back, passing each frame to (drive): the same function the
+ * driver control loop uses to turn controller inputs into motion. Frames are picked by
+ * elapsed time, so the replay keeps pace with the recording whatever the tick rate.
+ */
+class ReplayCommand : public Command
+{
+public:
+  ReplayCommand(InputRecording &recording, void (*drive)(const InputRecording::frame_t &));
+
+  /**
+   * Correct the replay against the recorded traces: (heading_gain) percent of rotation
+   * (Axis1) per degree of heading error, and (distance_gain) extra fraction of lateral
+   * speed (Axis3, Axis4) per inch the robot is behind or ahead of the recording.
+   * Only used if the recording was made with sensors.
+   */
+  ReplayCommand &with_correction(InputRecording::Sensors &sensors, scalar_t heading_gain, scalar_t distance_gain);
+
+  void initialize() override;
+  void execute() override;
+  void end(bool interrupted) override;
+  bool is_finished() override;
+
+private:
+  InputRecording &recording;
+  void (*drive)(const InputRecording::frame_t &);
+
+  InputRecording::Sensors *sensors = NULL;
+  scalar_t heading_gain = 0, distance_gain = 0;
+
+  uint32_t start_ms = 0;
+  bool done = false;
+};
+
+#endif
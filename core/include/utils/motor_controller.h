@@ -0,0 +1,138 @@
+#ifndef _MOTOR_CONTROLLER_
+#define _MOTOR_CONTROLLER_
+
+#include "vex.h"
+#include "../core/include/utils/scalar.h"
+#include "../core/include/utils/battery_compensation.h"
+#include "../core/include/utils/state_observer.h"
+
+/**
+ * motor_controller.h
+ *
+ * Velocity and position control of a motor (or motor group) run on the brain instead of
+ * by the motor's own velocity loop, commanding battery-compensated voltage directly.
+ *
+ * Output volts = kS * sign(v) + kV * v + kA * a          (feedforward)
+ *              + kP * (v - measured) + kI * integral      (feedback)
+ *
+ * where v and a are the velocity (rpm) and acceleration (rpm/s) setpoints. The
+ * feedforward does most of the work, so the feedback only corrects what it got wrong,
+ * and the motor responds in one loop instead of waiting on its internal one.
+ *
+ * All controllers are updated together by one background task every
+ * MOTOR_CONTROLLER_PERIOD_MS, started the first time any of them is commanded, so the
+ * loop runs faster than the 20ms autonomous / driver loops that set the targets.
+ */
+
+#define MOTOR_CONTROLLER_PERIOD_MS 5
+#define MOTOR_CONTROLLER_MAX 16
+
+class MotorController
+{
+public:
+  struct config_t
+  {
+    scalar_t ks, kv, ka; // volts, volts per rpm, volts per rpm/s
+    scalar_t kp, ki;     // volts per rpm of error, volts per rpm-second of error
+    scalar_t position_p; // position mode: rpm per degree of error
+    scalar_t max_rpm;    // speed a set_speed() of 1.0 means
+  };
+
+  /**
+   * Control (motor) / (motors), outputting through (compensation)
+   */
+  MotorController(vex::motor &motor, config_t &config, BatteryCompensation &compensation);
+  MotorController(vex::motor_group &motors, config_t &config, BatteryCompensation &compensation);
+  ~MotorController();
+
+  // The background task holds a pointer to it, and it owns its observer
+  MotorController(const MotorController &) = delete;
+  MotorController &operator=(const MotorController &) = delete;
+
+  /**
+   * Run at (rpm), and (accel_rpm_s) if the setpoint is changing, e.g. from a motion
+   * profile. The setpoint keeps following (accel_rpm_s) until the next call.
+   */
+  void set_velocity(scalar_t rpm, scalar_t accel_rpm_s = 0);
+
+  /**
+   * Run at (percent) (-1.0 -> 1.0) of the configured max_rpm
+   */
+  void set_speed(scalar_t percent);
+
+  /**
+   * Move to (degrees) of motor rotation, no faster than (max_rpm), or the configured
+   * max_rpm if not given
+   */
+  void set_position(scalar_t degrees, scalar_t max_rpm);
+  void set_position(scalar_t degrees);
+
+  /**
+   * Stop controlling, and stop the motor with its brake mode
+   */
+  void stop();
+
+  /**
+   * Reverse the motor (setReversed), which the controller assumes is off when it's made.
+   * The motor's readings change sign with it, so the loop's state is flipped to match
+   * instead of seeing a jump.
+   */
+  void set_reversed(bool reversed);
+
+  /**
+   * Take velocity and position from an observer fed the encoder every loop (see
+   * state_observer.h), in degrees, instead of the motor's own velocity, which is filtered
+   * with a lag and stepped. Set it before the controller is first commanded.
+   */
+  void set_observer(StateObserver::observer_config_t &config);
+
+  /**
+   * Velocity (rpm) and position (degrees), from the observer if there is one
+   */
+  scalar_t get_velocity();
+  scalar_t get_position();
+  scalar_t get_max_rpm() const;
+
+  /**
+   * Volts the loop asked for on its last update
+   */
+  scalar_t get_output_volts() const;
+
+  /**
+   * One iteration of the loop, (dt) seconds after the last. Called by the background task.
+   */
+  void update(scalar_t dt);
+
+private:
+  enum mode_t
+  {
+    STOPPED, VELOCITY, POSITION
+  };
+
+  vex::motor *motor;
+  vex::motor_group *motors;
+  config_t &config;
+  BatteryCompensation &compensation;
+
+  volatile mode_t mode = STOPPED;
+  bool reversed = false;
+  scalar_t target_rpm = 0, target_accel = 0;
+  scalar_t target_deg = 0, max_position_rpm = 0;
+  scalar_t integral = 0, output_volts = 0;
+  StateObserver *observer = NULL;
+
+  scalar_t read_velocity();
+  scalar_t read_position();
+  void output(scalar_t volts);
+
+  static MotorController *controllers[MOTOR_CONTROLLER_MAX];
+  static int num_controllers;
+  static bool task_started;
+
+  static vex::mutex &controllers_lock();
+  void add_to_task();
+  static void start_task();
+  static int control_task();
+};
+
+#endif
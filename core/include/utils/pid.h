@@ -3,6 +3,8 @@
 
 #include <cmath>
 #include "vex.h"
+#include "../core/include/utils/scalar.h"
+#include "../core/include/utils/state_observer.h"
 
 using namespace vex;
 
@@ -11,20 +13,26 @@ class PID
 public:
   struct pid_config_t
   {
-    double p, i, d, f;
-    double deadband, on_target_time;
+    scalar_t p, i, d, f;
+    scalar_t deadband, on_target_time;
+    StateObserver::observer_config_t *observer; // for the derivative term, see set_observer(). NULL for none
   };
 
   /**
    * Create the PID object
    */
   PID(pid_config_t &config);
+  ~PID();
+
+  // Owns its observer
+  PID(const PID &) = delete;
+  PID &operator=(const PID &) = delete;
 
   /**
    * Update the PID loop by taking the time difference from last update,
    * and running the PID formula with the new sensor data
    */
-  void update(double sensorVal);
+  void update(scalar_t sensorVal);
 
   /**
    * Reset the PID loop by resetting time since 0 and accumulated error.
@@ -34,23 +42,23 @@ public:
   /**
    * Gets the current PID out value, from when update() was last run
    */
-  double get();
+  scalar_t get();
 
   /**
    * Get the delta between the current sensor data and the target
    */
-  double get_error();
+  scalar_t get_error();
 
   /**
    * Set the target for the PID loop, where the robot is trying to end up
    */
-  void set_target(double target);
+  void set_target(scalar_t target);
 
   /**
    * Set the limits on the PID out. The PID out will "clip" itself to be 
    * between the limits.
    */
-  void set_limits(double lower, double upper);
+  void set_limits(scalar_t lower, scalar_t upper);
 
   /**
    * Returns true if the loop is within [deadband] for [on_target_time]
@@ -58,17 +66,24 @@ public:
    */
   bool is_on_target();
 
+  /**
+   * Take the derivative term from an observer fed the error (see state_observer.h),
+   * instead of differencing the error, which is noisy at fast loop rates
+   */
+  void set_observer(StateObserver::observer_config_t &config);
+
 private:
   pid_config_t &config;
 
-  double last_error = 0, accum_error = 0;
-  double last_time = 0, on_target_last_time = 0;
-  double lower_limit = 0, upper_limit = 0;
+  scalar_t last_error = 0, accum_error = 0;
+  scalar_t last_time = 0, on_target_last_time = 0;
+  scalar_t lower_limit = 0, upper_limit = 0;
 
-  double target = 0, sensor_val = 0, out = 0;
+  scalar_t target = 0, sensor_val = 0, out = 0;
   bool is_checking_on_target = false;
 
   timer pid_timer;
+  StateObserver *observer = NULL;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,141 @@
+#ifndef _POSE_ESTIMATOR_
+#define _POSE_ESTIMATOR_
+
+#include <stdint.h>
+#include "vex.h"
+#include "../core/include/utils/scalar.h"
+
+/**
+ * pose_estimator.h
+ *
+ * Extended Kalman filter for the robot's pose and velocity, fusing wheel odometry with
+ * the IMU instead of trusting either one alone.
+ *
+ * State: x, y (inches), heading (radians), forward and left speed (inches/s, in the
+ * robot's frame) and turn rate (radians/s). Same frame as TankOdometry and PurePursuit:
+ * heading counter-clockwise positive, the opposite way to the IMU.
+ *
+ *  - predict() steps the state forward to a time, with the IMU's acceleration as the input
+ *  - add_odometry(), add_heading() and add_yaw_rate() correct it with measurements
+ *
+ * Every measurement carries the time it was actually taken, since sensor readings
+ * arrive late (the motors filter their velocity, the IMU reports every 10ms). The filter
+ * keeps the last POSE_ESTIMATOR_HISTORY steps: a measurement older than the latest step
+ * is fused at the step it belongs to, and the steps after it are replayed, so the
+ * estimate is as if it had arrived on time.
+ *
+ * A wheel speed too far from the prediction to be noise (slip_gate standard deviations)
+ * is ignored: the wheels are slipping, and the IMU's acceleration carries the estimate
+ * until they grip again.
+ *
+ * All measurements are of one state each, so updates are scalar: no matrix inverse.
+ */
+
+#define POSE_ESTIMATOR_HISTORY 32
+#define POSE_ESTIMATOR_MAX_MEASUREMENTS 6 // per step
+
+class PoseEstimator
+{
+public:
+  struct estimator_config_t
+  {
+    scalar_t accel_noise;     // in/s^2, how far the IMU acceleration is from the truth
+    scalar_t yaw_accel_noise; // rad/s^2, how quickly the turn rate can change unmeasured
+    scalar_t odometry_noise;  // in/s, wheel speed (slip, scrub)
+    scalar_t heading_noise;   // rad, IMU heading
+    scalar_t yaw_rate_noise;  // rad/s, IMU turn rate
+    scalar_t slip_gate;       // standard deviations off before a wheel speed is ignored as slip, 0 to never
+  };
+
+  struct state_t
+  {
+    scalar_t x, y, heading;
+    scalar_t forward, left, omega;
+  };
+
+  PoseEstimator(estimator_config_t &config);
+
+  /**
+   * Start over, certain the robot is in (state) at (time_ms)
+   */
+  void reset(const state_t &state, uint32_t time_ms);
+
+  /**
+   * Step the estimate forward to (time_ms), with the robot accelerating at
+   * (accel_forward), (accel_left) in/s^2 as measured by the IMU. Call it every loop.
+   */
+  void predict(uint32_t time_ms, scalar_t accel_forward, scalar_t accel_left);
+
+  /**
+   * Wheel speeds (inches/s, robot frame) as they were at (time_ms)
+   */
+  void add_odometry(uint32_t time_ms, scalar_t forward, scalar_t left);
+
+  /**
+   * IMU heading (radians, counter-clockwise) as it was at (time_ms)
+   */
+  void add_heading(uint32_t time_ms, scalar_t heading);
+
+  /**
+   * IMU turn rate (radians/s, counter-clockwise) as it was at (time_ms)
+   */
+  void add_yaw_rate(uint32_t time_ms, scalar_t omega);
+
+  /**
+   * The estimate as of the last predict()
+   */
+  state_t get_state() const;
+
+  /**
+   * Standard deviation of the position estimate, inches
+   */
+  scalar_t get_position_error() const;
+
+  /**
+   * Measurements older than the history, which were dropped
+   */
+  int get_dropped() const;
+
+  /**
+   * Whether the latest wheel speed was ignored as slip
+   */
+  bool is_slipping() const;
+
+private:
+  enum
+  {
+    X, Y, HEADING, FORWARD, LEFT, OMEGA, N
+  };
+
+  struct measurement_t
+  {
+    int index;
+    scalar_t value, variance;
+    scalar_t gate; // standard deviations, 0 for none
+  };
+
+  struct step_t
+  {
+    uint32_t time_ms;
+    scalar_t dt, accel_forward, accel_left;
+    scalar_t prior[N], prior_cov[N][N]; // after predicting, before this step's measurements
+    measurement_t measurements[POSE_ESTIMATOR_MAX_MEASUREMENTS];
+    int num_measurements;
+  };
+
+  estimator_config_t &config;
+
+  scalar_t state[N];
+  scalar_t cov[N][N];
+
+  step_t history[POSE_ESTIMATOR_HISTORY];
+  int newest = 0, num_steps = 0;
+  int dropped = 0;
+  bool slipping = false;
+
+  void propagate(scalar_t dt, scalar_t accel_forward, scalar_t accel_left);
+  void correct(const measurement_t &m);
+  void add_measurement(uint32_t time_ms, int index, scalar_t value, scalar_t stddev, scalar_t gate);
+};
+
+#endif
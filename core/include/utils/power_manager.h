@@ -0,0 +1,92 @@
+#ifndef _POWER_MANAGER_
+#define _POWER_MANAGER_
+
+#include "vex.h"
+#include "../core/include/utils/scalar.h"
+
+/**
+ * power_manager.h
+ *
+ * Shares a total current budget between the drive and steering motors of a swerve drive,
+ * so hard direction changes don't pull the battery down into a brownout or hit the
+ * motors' current limits all at once.
+ *
+ * Every POWER_MANAGER_PERIOD_MS it reads each motor's current and the battery voltage:
+ *  - the budget shrinks as the battery sags towards the brownout voltage
+ *  - steering is served first, with a share of the budget that grows with the worst
+ *    module's alignment error (a module pointing the wrong way wastes drive power)
+ *  - drive gets the rest
+ * Each side's output is scaled down while it draws more than its share, and recovers
+ * gradually once it doesn't. On top of that, drive commands are slew-rate limited as they
+ * speed up or reverse, which is where the current spikes come from.
+ */
+
+#define POWER_MANAGER_PERIOD_MS 10
+#define POWER_MANAGER_MAX_MODULES 4
+
+class PowerManager
+{
+public:
+  struct power_config_t
+  {
+    scalar_t current_budget_a;      // total current for all the motors
+    scalar_t sag_start_v;           // battery voltage where the budget starts shrinking
+    scalar_t brownout_v;            // battery voltage where it reaches its minimum
+    scalar_t drive_slew_per_s;      // fastest a drive command may speed up (1.0 = full speed)
+    scalar_t steering_priority_deg; // alignment error at which steering may take the whole budget
+  };
+
+  PowerManager(vex::brain::battery &battery, power_config_t &config);
+
+  /**
+   * Manage a module's motors. Returns the module's index for drive_output() and
+   * steering_scale(), or -1 if there are too many.
+   */
+  int add_module(vex::motor &drive, vex::motor &direction);
+
+  /**
+   * The drive command (-1.0 -> 1.0) module (index) may have instead of (percent):
+   * slew-rate limited and scaled to the drive's share of the budget. (reversed) is true
+   * if the drive motor runs backwards to the way the module points.
+   */
+  scalar_t drive_output(int index, scalar_t percent, bool reversed);
+
+  /**
+   * Fraction of full steering speed module (index) may use, given it is
+   * (alignment_error_deg) from where it should point
+   */
+  scalar_t steering_scale(int index, scalar_t alignment_error_deg);
+
+  /**
+   * Current budget (A) after battery sag, and the total drawn, as of the last update
+   */
+  scalar_t get_budget() const;
+  scalar_t get_total_current() const;
+
+  scalar_t get_drive_scale() const;
+  scalar_t get_steering_scale() const;
+
+private:
+  struct module_t
+  {
+    vex::motor *drive, *direction;
+    scalar_t last_output; // as the motor turns, not the way the module points
+    uint32_t last_output_ms;
+    scalar_t alignment_error;
+  };
+
+  vex::brain::battery &battery;
+  power_config_t &config;
+
+  module_t modules[POWER_MANAGER_MAX_MODULES];
+  int num_modules = 0;
+
+  scalar_t budget_a = 0, total_a = 0;
+  scalar_t drive_scale = 1, steer_scale = 1;
+  uint32_t last_update_ms = 0;
+  bool updated = false;
+
+  void update();
+};
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef _PURE_PURSUIT_
+#define _PURE_PURSUIT_
+
+#include <stdint.h>
+#include "../core/include/utils/scalar.h"
+#include "../core/include/pathfinder/structs.h"
+#include "../core/include/subsystems/tank_drive.h"
+#include "../core/include/subsystems/swerve_drive.h"
+#include "../core/include/subsystems/mecanum_drive.h"
+#include "../core/include/utils/tank_odometry.h"
+
+/**
+ * pure_pursuit.h
+ *
+ * Pure pursuit path following for tank, mecanum and swerve drives: each loop, find the
+ * point on the path nearest the robot, then steer for the point (lookahead) inches
+ * further along it.
+ *
+ * Paths can have thousands of points, so finding the nearest one is kept cheap:
+ *  - normally only a window of the path just ahead of the last nearest point is
+ *    searched, so progress along the path only ever goes forward
+ *  - if the robot is further from that window than (relocate_distance), e.g. on the first
+ *    call or after being pushed, a grid index built with the path finds it instead by
+ *    checking just the cells around the robot
+ *
+ * The lookahead grows with speed, from (lookahead_min) to (lookahead_max), for stability
+ * at speed and accuracy when slow. Speed is limited on the path where it curves, so
+ * sideways acceleration stays under (max_lateral_a), and slows to a stop at the end.
+ *
+ * Poses are in the pathfinder frame, as TankOdometry's: x and y in inches, heading in
+ * radians counter-clockwise positive. Paths are followed driving forwards.
+ */
+class PurePursuit
+{
+public:
+  struct pursuit_config_t
+  {
+    scalar_t lookahead_min;     // inches, at rest
+    scalar_t lookahead_max;     // inches
+    scalar_t lookahead_gain;    // extra lookahead per in/s of speed (seconds)
+    scalar_t max_v;             // in/s
+    scalar_t min_v;             // in/s, so the robot never stalls short of the end
+    scalar_t max_a;             // in/s^2, speeding up and slowing down
+    scalar_t max_lateral_a;     // in/s^2, around curves
+    scalar_t kv;                // drive output (-1.0 -> 1.0) per in/s
+    scalar_t track_width;       // inches, tank drives only
+    scalar_t spacing;           // inches between points when a path is made from waypoints
+    scalar_t search_distance;   // inches of path ahead searched each loop
+    scalar_t relocate_distance; // inches off the window before searching the whole path
+    scalar_t end_tolerance;     // inches from the end to call the path done
+  };
+
+  struct pose_t
+  {
+    scalar_t x, y, heading;
+  };
+
+  struct target_t
+  {
+    scalar_t x, y;      // the lookahead point
+    scalar_t curvature; // of the arc from the robot to it, 1/inches, left positive
+    scalar_t speed;     // in/s the robot should drive at
+    scalar_t remaining; // inches of path left
+    int index;          // nearest point on the path
+    bool finished;
+  };
+
+  PurePursuit(pursuit_config_t &config);
+  ~PurePursuit();
+
+  /**
+   * Follow the center of a pathfinder trajectory
+   */
+  bool set_path(const Segment *segments, int length);
+
+  /**
+   * Follow straight lines between (waypoints) (their angles are ignored), split up
+   * every (spacing) inches
+   */
+  bool set_path(const Waypoint *waypoints, int count);
+
+  /**
+   * Where the robot at (pose) should head for, and how fast. Call it every loop.
+   */
+  target_t update(const pose_t &pose);
+
+  /**
+   * Drive along the path, with the pose from (odometry). Returns true when finished.
+   */
+  bool follow(TankDrive &drive, TankOdometry &odometry);
+
+  /**
+   * Drive along the path, with the robot at (pose). The robot's heading is left alone:
+   * it goes straight for the lookahead point. Returns true when finished.
+   */
+  bool follow(SwerveDrive &drive, const pose_t &pose);
+  bool follow(MecanumDrive &drive, const pose_t &pose);
+
+  /**
+   * Number of points on the path
+   */
+  int get_length() const;
+
+private:
+  pursuit_config_t &config;
+
+  // The path, one array per field
+  scalar_t *xs = NULL, *ys = NULL;
+  scalar_t *distances = NULL; // along the path from the start
+  scalar_t *speeds = NULL;    // fastest allowed at each point
+  int length = 0;
+
+  // Grid index: the points in cell c are cell_points[cell_start[c] -> cell_start[c + 1]]
+  int *cell_start = NULL, *cell_points = NULL;
+  int cells_x = 0, cells_y = 0;
+  scalar_t grid_x = 0, grid_y = 0, cell_size = 1;
+
+  int nearest = 0;
+  bool located = false;
+  scalar_t last_speed = 0;
+  uint32_t last_update_ms = 0;
+
+  bool allocate(int length);
+  void release();
+  void prepare();
+  void build_index();
+  int search_window(const pose_t &pose, scalar_t &best_sq);
+  int search_index(const pose_t &pose);
+  void lookahead_point(const pose_t &pose, scalar_t lookahead, scalar_t &x, scalar_t &y);
+};
+
+#endif
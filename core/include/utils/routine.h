@@ -0,0 +1,125 @@
+#ifndef _ROUTINE_
+#define _ROUTINE_
+
+#include <initializer_list>
+#include "../core/include/utils/command.h"
+
+/**
+ * routine.h
+ *
+ * Autonomous routines that read top to bottom, but don't block. A Routine is a Command
+ * whose body is written between ROUTINE_BEGIN and ROUTINE_END, and can pause at any
+ * ROUTINE_AWAIT* point. Each tick the body picks up where it paused, so any number of
+ * routines run side by side on one CommandScheduler with no extra vex::tasks.
+ *
+ *  class ScoreRoutine : public Routine
+ *  {
+ *    void body() override
+ *    {
+ *      ROUTINE_BEGIN();
+ *      ROUTINE_AWAIT(drive.auto_drive(0, .5, 24));
+ *      ROUTINE_AWAIT_ALL(&lift_up, &intake_out);
+ *      ROUTINE_WAIT_MS(250);
+ *      ROUTINE_AWAIT(drive.auto_turn(90, .5));
+ *      ROUTINE_END();
+ *    }
+ *  };
+ *
+ * The body is resumed with a switch on the line number, so:
+ *  - local variables do not survive an await; keep state in members of the routine
+ *  - only one await per line, and no awaits inside another switch statement
+ * Everything the routine needs lives in the object itself, so its size is fixed at
+ * compile time.
+ */
+
+class Routine : public Command
+{
+public:
+  Routine();
+
+  void initialize() override;
+  void execute() override;
+  void end(bool interrupted) override;
+  bool is_finished() override;
+
+protected:
+  /**
+   * The routine itself, written between ROUTINE_BEGIN() and ROUTINE_END()
+   */
+  virtual void body() = 0;
+
+  /**
+   * Start the commands for a ROUTINE_AWAIT_ALL / ROUTINE_AWAIT_ANY
+   */
+  void start_awaiting(std::initializer_list<Command *> commands);
+
+  /**
+   * Run one tick of the awaited commands. Returns true once all of them have finished,
+   * or if (any) is set, once one of them has (cancelling the rest).
+   */
+  bool step_awaiting(bool any);
+
+  int resume_line = 0;
+  uint32_t wait_start_ms = 0;
+  bool done = false;
+
+private:
+  Command *awaiting[COMMAND_GROUP_MAX];
+  int num_awaiting = 0;
+};
+
+#define ROUTINE_BEGIN()                                                     \
+  switch (resume_line)                                                      \
+  {                                                                         \
+  case 0:
+
+#define ROUTINE_END()                                                       \
+  }                                                                         \
+  done = true;
+
+/**
+ * Pause until (condition) is true. It is evaluated once per tick, so a non-blocking
+ * function that returns true when it is finished (e.g. SwerveDrive::auto_drive) can be
+ * called directly.
+ */
+#define ROUTINE_AWAIT(condition)                                            \
+  do                                                                        \
+  {                                                                         \
+    resume_line = __LINE__;                                                 \
+  case __LINE__:                                                            \
+    if (!(condition))                                                       \
+      return;                                                               \
+  } while (0)
+
+/**
+ * Pause for (ms) milliseconds
+ */
+#define ROUTINE_WAIT_MS(ms)                                                 \
+  do                                                                        \
+  {                                                                         \
+    wait_start_ms = vexSystemTimeGet();                                     \
+    ROUTINE_AWAIT(vexSystemTimeGet() - wait_start_ms >= (uint32_t)(ms));    \
+  } while (0)
+
+/**
+ * Run the commands (pointers) at the same time, and pause until all have finished
+ */
+#define ROUTINE_AWAIT_ALL(...)                                              \
+  do                                                                        \
+  {                                                                         \
+    start_awaiting({__VA_ARGS__});                                          \
+    ROUTINE_AWAIT(step_awaiting(false));                                    \
+  } while (0)
+
+/**
+ * Run the commands (pointers) at the same time, and pause until one has finished.
+ * The others are cancelled.
+ */
+#define ROUTINE_AWAIT_ANY(...)                                              \
+  do                                                                        \
+  {                                                                         \
+    start_awaiting({__VA_ARGS__});                                          \
+    ROUTINE_AWAIT(step_awaiting(true));                                     \
+  } while (0)
+
+#endif
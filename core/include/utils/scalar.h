@@ -0,0 +1,19 @@
+#ifndef _SCALAR_
+#define _SCALAR_
+
+/**
+ * The floating point type used by the core control code (PID, Vector, drive classes).
+ *
+ * Defaults to double. Define CORE_FLOAT_MATH (e.g. "DEFINES += -DCORE_FLOAT_MATH" in the makefile)
+ * to build the control path in single precision, which the V5's Cortex-A9 runs faster.
+ *
+ * Pathfinder's structs (Segment, Spline, ...) stay double either way, since the library
+ * is linked pre-built.
+ */
+#ifdef CORE_FLOAT_MATH
+typedef float scalar_t;
+#else
+typedef double scalar_t;
+#endif
+
+#endif
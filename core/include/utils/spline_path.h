@@ -4,6 +4,8 @@
 #include "../core/include/pathfinder.h"
 
 #include "../core/include/subsystems/tank_drive.h"
+#include "../core/include/utils/tank_odometry.h"
+#include "../core/include/utils/trajectory_generator.h"
 
 
 class SplinePath
@@ -13,29 +15,82 @@ public:
   {
     // drive_pid controls the speed at which the robot drives forward,
     // turn_p is for turning the robot based on the desired heading
-    float drive_p = .1, drive_i = 0, drive_d = 0;
-    float turn_p = .05;
+    scalar_t drive_p = .1, drive_i = 0, drive_d = 0;
+    scalar_t turn_p = .05;
+
+    // Pose feedback (see set_odometry()). b is how hard lateral error is corrected
+    // (2 / m^2 ~= .0013 / in^2), zeta damps it (0 -> 1).
+    scalar_t ramsete_b = .0013, ramsete_zeta = .7;
+
+    // Output per in/s the robot is short of the commanded speed, measured by odometry
+    // (smoothest with TankOdometry::set_observer())
+    scalar_t velocity_p = 0;
 
     // Maximum velocity, acceleration, and jerk the robot is allowed to achieve (Jerk doesn't matter THAT much...)
-    double max_v = 10, max_a = 20, max_j = 100;
+    scalar_t max_v = 10, max_a = 20, max_j = 100;
+
+    // Replanning, with pose feedback only: once the robot is more than replan_distance
+    // inches from where the path says it should be (e.g. after being bumped), a new
+    // trajectory is made from its pose and speed to the waypoints it hasn't reached yet,
+    // and followed from then on. 0 never replans. A replan taking longer than
+    // replan_budget_ms is dropped: the robot has moved on from where it started.
+    scalar_t replan_distance = 0;
+    scalar_t replan_budget_ms = 50;
 
     // kv and ka are constants fed into the spline system, and are multiplied by the
     // velocity setpoint and acceleration setpoint inside the main pathfinder stuff.
     // Generally 1/max_v is sufficient for kv (does NOT work for ka)
-    float kv = 1.0 / max_v, ka = 0;
+    scalar_t kv = 1 / max_v, ka = 0;
 
     // Time delta between loops inside the pathfinder calls
-    double dt = .01;
+    scalar_t dt = .01;
 
     // Misc robot info
-    double wheel_diam = 4;
+    scalar_t wheel_diam = 4;
     int ticks_per_rev = 900; // 300 with blues, 900 with greens, 1800 with reds
-    double wheelbase_width = 11.5;
+    scalar_t wheelbase_width = 11.5;
+  };
+
+  // One of the paths given to run_paths()
+  struct path_t
+  {
+    Waypoint *points;
+    int length;
   };
 
   SplinePath(TankDrive &drive_system, vex::inertial &imu, vex::motor &l_enc, vex::motor &r_enc, motion_profile_t &motion_profile);
 
-  bool run_path(Waypoint *point_list, int list_length);
+  /**
+   * Makes the robot follow a predetermined path defined by point_list array,
+   * with list_length number of waypoints. The first waypoint should be the
+   * starting position.
+   *
+   * With pose feedback (see set_odometry()), the path can end still moving, at end_v
+   * in/s, instead of stopped. The drive is then left running, and the next call to
+   * run_path must carry on from where this one ended: it starts at that speed instead
+   * of from rest.
+   *
+   * Returns true when the path has finished
+   */
+  bool run_path(Waypoint *point_list, int list_length, scalar_t end_v = 0);
+
+  /**
+   * Follow (paths) one after another, like calling run_path on each in turn, but without
+   * stopping between them where one carries straight on into the next (starting where
+   * it ended, facing the same way). At each of those the robot goes as fast as it still
+   * can slow down in time for the next stop. Needs pose feedback: with the encoders it
+   * stops after each path.
+   *
+   * Returns true when the last path has finished
+   */
+  bool run_paths(path_t *paths, int num_paths);
+
+  /**
+   * Follow paths with pose feedback from (odometry) instead of following each side's
+   * encoder on its own: x, y and heading errors against the center trajectory are all
+   * corrected, so sideways error can't build up. Pass NULL to go back to the encoders.
+   */
+  void set_odometry(TankOdometry *odometry);
 
 private:
   bool run_path_init = true;
@@ -43,6 +98,7 @@ private:
 
   TrajectoryCandidate candidate;
   Segment *center_traj, *left_traj, *right_traj;
+  int center_length = 0;
 
   EncoderFollower *left_follower, *right_follower;
   EncoderConfig enc_conf;
@@ -52,6 +108,39 @@ private:
   vex::inertial &imu;
 
   motion_profile_t &motion_profile;
+
+  TankOdometry *odometry = NULL;
+  uint32_t start_ms = 0;
+
+  // Paths run without stopping between them (see run_path's end_v). carry_v is the
+  // speed the last one ended at, which the next one starts at.
+  scalar_t path_end_v = 0, carry_v = 0;
+  int path_index = 0; // in run_paths()
+
+  // Replanning (see motion_profile_t). A task makes the new trajectory in pending_traj,
+  // and the control loop swaps it with center_traj once it's ready.
+  TrajectoryGenerator::generator_config_t generator_config;
+  TrajectoryGenerator generator;
+  Waypoint waypoints[TRAJECTORY_MAX_WAYPOINTS];
+  int num_waypoints = 0;
+  int waypoint_segments[TRAJECTORY_MAX_WAYPOINTS]; // where center_traj reaches each one
+  Segment *pending_traj = NULL;
+  int pending_length = 0, capacity = 0;
+  int pending_waypoint_segments[TRAJECTORY_MAX_WAYPOINTS];
+
+  Waypoint replan_start;
+  scalar_t replan_speed = 0;
+  int replan_from = 0;
+  uint32_t replan_ms = 0;
+  volatile uint32_t next_replan_ms = 0;
+  volatile bool replanning = false, replan_ready = false;
+  vex::mutex replan_lock;
+
+  bool follow_pose();
+  void finish_path();
+  void start_replan(const TankOdometry::pose_t &pose, int index);
+  void take_replan();
+  static int replan_task(void *self);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef _STATE_OBSERVER_
+#define _STATE_OBSERVER_
+
+#include "../core/include/utils/scalar.h"
+
+/**
+ * state_observer.h
+ *
+ * Smooth position, velocity and acceleration from noisy position samples (encoder
+ * readings, a PID's error), with less lag than differencing and then low-pass filtering.
+ *
+ * A Kalman filter on a constant-acceleration model: each update predicts the three
+ * forward by the time since the last, then corrects them with the new sample. Once it
+ * settles it is an alpha-beta-gamma filter, with gains set by how noisy the samples are
+ * (position_noise) against how suddenly the motion can change (jerk_noise):
+ *  - raise jerk_noise for a faster, noisier estimate
+ *  - raise position_noise for a smoother, slower one
+ * The gains are worked out each update from the real time step, so loop jitter doesn't
+ * turn into velocity noise.
+ */
+class StateObserver
+{
+public:
+  struct observer_config_t
+  {
+    scalar_t position_noise; // standard deviation of a sample, in its units
+    scalar_t jerk_noise;     // units/s^3 the acceleration can wander by, per root second
+  };
+
+  StateObserver(observer_config_t &config);
+
+  /**
+   * Forget the state. The next update starts over at rest, at that sample.
+   */
+  void reset();
+
+  /**
+   * Flip the sign of the state, for when the samples change sign (e.g. a motor being set
+   * reversed), so the estimate carries on instead of seeing a jump
+   */
+  void negate();
+
+  /**
+   * Fuse a new (position) sample, taken (dt) seconds after the last
+   */
+  void update(scalar_t position, scalar_t dt);
+
+  scalar_t get_position() const;
+  scalar_t get_velocity() const;     // units/s
+  scalar_t get_acceleration() const; // units/s^2
+
+private:
+  observer_config_t &config;
+
+  scalar_t state[3];  // position, velocity, acceleration
+  scalar_t cov[3][3]; // of the state
+  bool initialized = false;
+};
+
+#endif
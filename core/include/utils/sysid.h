@@ -0,0 +1,99 @@
+#ifndef _SYSID_
+#define _SYSID_
+
+#include <initializer_list>
+#include <stdint.h>
+#include "vex.h"
+#include "../core/include/utils/scalar.h"
+#include "../core/include/utils/command.h"
+#include "../core/include/utils/battery_compensation.h"
+
+/**
+ * sysid.h
+ *
+ * Characterizes a set of motors driving one mechanism, to find the kS / kV / kA of
+ *   volts = kS * sign(v) + kV * v + kA * a
+ * for the feedforward in motor_controller.h, and from those, the feedback gains.
+ *
+ * Runs four tests, resting in between:
+ *   1, 2  quasistatic forward / reverse: voltage ramped up slowly, so acceleration is
+ *         ~0 and volts against velocity gives kS and kV
+ *   3, 4  dynamic forward / reverse: a voltage step, where acceleration dominates and
+ *         gives kA
+ * logging voltage, velocity and position every SYSID_PERIOD_MS to a CSV file on the SD
+ * card. Fit it on a computer with core/tools/sysid_fit.cpp:
+ *
+ *   make -f host.mk tools
+ *   build/host/sysid_fit sysid_drive.csv
+ *
+ * The mechanism moves a long way: give a drivetrain the room, or lift it.
+ */
+
+#define SYSID_PERIOD_MS 5
+#define SYSID_MAX_MOTORS 4
+
+class SysIdCommand : public Command
+{
+public:
+  struct sysid_config_t
+  {
+    scalar_t ramp_volts_per_s = 1; // quasistatic ramp rate
+    scalar_t ramp_max_volts = 6;   // quasistatic tests end here
+    scalar_t step_volts = 6;       // dynamic test voltage
+    scalar_t step_seconds = 1.5;   // dynamic test length
+    scalar_t rest_seconds = 1;     // coast between tests
+  };
+
+  /**
+   * Characterize (motors), all driven at the same voltage through (compensation), and
+   * write the log to (filename) on (sd). Velocity and position are averaged over the
+   * motors. The log buffer is allocated once, here.
+   */
+  SysIdCommand(BatteryCompensation &compensation, vex::brain::sdcard &sd, const char *filename,
+               std::initializer_list<vex::motor *> motors);
+  SysIdCommand(BatteryCompensation &compensation, vex::brain::sdcard &sd, const char *filename,
+               std::initializer_list<vex::motor *> motors, const sysid_config_t &config);
+  ~SysIdCommand();
+
+  void initialize() override;
+  void end(bool interrupted) override;
+  bool is_finished() override;
+
+  /**
+   * Whether the last run's log was written to the SD card
+   */
+  bool saved() const;
+
+private:
+  struct sample_t
+  {
+    uint32_t time_ms;
+    uint8_t test;
+    float volts, velocity_rpm, position_deg;
+  };
+
+  BatteryCompensation &compensation;
+  vex::brain::sdcard &sd;
+  const char *filename;
+  vex::motor *motors[SYSID_MAX_MOTORS];
+  int num_motors = 0;
+  sysid_config_t config;
+
+  sample_t *samples;
+  uint32_t max_samples, num_samples = 0;
+
+  volatile bool task_running = false, abort = false;
+  bool log_saved = false;
+
+  void init(std::initializer_list<vex::motor *> motors);
+  void set_volts(scalar_t volts);
+  scalar_t velocity();
+  scalar_t position();
+
+  bool run_test(uint8_t test, scalar_t ramp, scalar_t volts, scalar_t seconds);
+  void rest(scalar_t seconds);
+  bool save();
+  static int test_task(void *self);
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef _TANK_ODOMETRY_
+#define _TANK_ODOMETRY_
+
+#include <stdint.h>
+#include "vex.h"
+#include "../core/include/utils/scalar.h"
+#include "../core/include/utils/state_observer.h"
+
+/**
+ * tank_odometry.h
+ *
+ * Tracks the position of a differential (tank) drive on the field from the distance
+ * each side's wheels have turned and the IMU's heading.
+ *
+ * The pose is in the same frame as a pathfinder trajectory: x and y in inches,
+ * heading in radians, counter-clockwise positive (the opposite way to the IMU). Each
+ * update moves the robot along the arc between the last heading and the new one, so
+ * curves don't collect error the way a straight line per step would.
+ *
+ * The IMU is trusted for heading since wheel scrub makes encoder heading drift quickly.
+ */
+class TankOdometry
+{
+public:
+  struct pose_t
+  {
+    scalar_t x, y;     // inches
+    scalar_t heading;  // radians, counter-clockwise positive
+  };
+
+  /**
+   * Track a drive from its (left_motors), (right_motors) and (imu). (wheel_diam) is in
+   * inches, and the wheels turn once per motor revolution (as in TankDrive).
+   */
+  TankOdometry(vex::motor_group &left_motors, vex::motor_group &right_motors, vex::inertial &imu, scalar_t wheel_diam);
+  ~TankOdometry();
+
+  // Owns its observer
+  TankOdometry(const TankOdometry &) = delete;
+  TankOdometry &operator=(const TankOdometry &) = delete;
+
+  /**
+   * Read the sensors and move the pose along the arc driven since the last update.
+   * Call it every loop of whatever uses the pose.
+   */
+  void update();
+
+  /**
+   * Say the robot is at (pose) now, e.g. the start of a path
+   */
+  void set_position(const pose_t &pose);
+
+  /**
+   * The pose as of the last update
+   */
+  pose_t get_position() const;
+
+  /**
+   * Speed along the robot's heading as of the last update, inches per second
+   */
+  scalar_t get_speed() const;
+
+  /**
+   * Acceleration along the robot's heading, inches per second^2. Only with an observer.
+   */
+  scalar_t get_acceleration() const;
+
+  /**
+   * Take speed and acceleration from an observer fed the distance driven (see
+   * state_observer.h), in inches, instead of differencing it each update
+   */
+  void set_observer(StateObserver::observer_config_t &config);
+
+private:
+  vex::motor_group &left_motors, &right_motors;
+  vex::inertial &imu;
+  scalar_t wheel_diam;
+
+  pose_t pose = {0, 0, 0};
+  scalar_t speed = 0;
+  StateObserver *observer = NULL;
+
+  scalar_t last_left = 0, last_right = 0, last_imu_deg = 0;
+  uint32_t last_update_ms = 0;
+  bool initialized = false;
+
+  scalar_t left_inches();
+  scalar_t right_inches();
+};
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef _THERMAL_MODEL_
+#define _THERMAL_MODEL_
+
+#include <stdint.h>
+#include "vex.h"
+#include "../core/include/utils/scalar.h"
+
+/**
+ * thermal_model.h
+ *
+ * Predicts when motors will get hot enough for the V5 firmware to start cutting their
+ * current limit, and lowers the limit gradually beforehand (with setMaxTorque, the same
+ * lever the firmware uses). Running a little gentler all along keeps more speed over a
+ * skills run than running flat out and being cut to half.
+ *
+ * Each motor is modeled as a single thermal mass heated by its winding losses:
+ *   C dT/dt = I^2 R - (T - ambient) / R_th
+ * Every THERMAL_MODEL_PERIOD_MS the estimate is stepped with the measured current, and
+ * pulled towards temperature() (which only reads in coarse steps, so only once the
+ * estimate leaves the band the reading allows). From the estimate and the recent
+ * heating the model works out how long until the motor reaches (derate_c - margin_c).
+ * Once that is within (horizon_s), the current limit is capped, more the closer it gets,
+ * towards what the motor can hold indefinitely without getting there.
+ *
+ * For checking the model against the motors, each one also keeps a prediction made
+ * (prediction_s) ago to compare with what the motor actually reads now: see
+ * get_telemetry() and print_telemetry().
+ */
+
+#define THERMAL_MODEL_PERIOD_MS 100
+#define THERMAL_MODEL_MAX_MOTORS 8
+
+class ThermalModel
+{
+public:
+  struct thermal_config_t
+  {
+    scalar_t derate_c;         // temperature where the firmware starts cutting current
+    scalar_t margin_c;         // stay this far below it
+    scalar_t horizon_s;        // start capping when the margin is this close
+    scalar_t thermal_ohms;     // C/W, motor to ambient
+    scalar_t thermal_mass;     // J/C
+    scalar_t winding_ohms;     // heating resistance
+    scalar_t ambient_c;
+    scalar_t sensor_step_c;    // resolution of temperature()
+    scalar_t correction_per_s; // how fast the estimate is pulled towards temperature()
+    scalar_t demand_tau_s;     // heating is averaged over about this long
+    scalar_t prediction_s;     // telemetry: how far ahead predictions are checked
+  };
+
+  struct telemetry_t
+  {
+    scalar_t measured_c;        // temperature() now
+    scalar_t estimated_c;       // the model's estimate now
+    scalar_t predicted_c;       // the last prediction to come due
+    scalar_t actual_c;          // what temperature() read when it did
+    scalar_t prediction_error;  // actual - predicted (0 until the first one comes due)
+    scalar_t seconds_to_derate; // at the current heating, or -1 if never
+    scalar_t cap;               // fraction of the full current limit, 0 -> 1
+  };
+
+  ThermalModel(thermal_config_t &config);
+
+  /**
+   * Model (motor), and manage its current limit. Returns its index for get_telemetry(),
+   * or -1 if there are too many.
+   */
+  int add_motor(vex::motor &motor);
+
+  /**
+   * Step the model and re-apply the current limits, at most every THERMAL_MODEL_PERIOD_MS
+   * however often it is called. Call it wherever the motors are commanded.
+   */
+  void update();
+
+  /**
+   * Estimated and predicted temperatures of motor (index), as of the last update
+   */
+  telemetry_t get_telemetry(int index) const;
+
+  /**
+   * Print every motor's telemetry to stderr, one line each
+   */
+  void print_telemetry() const;
+
+private:
+  struct motor_t
+  {
+    vex::motor *motor;
+    scalar_t estimate_c;
+    scalar_t demand_w;     // averaged winding losses, had the output not been capped
+    scalar_t cap;
+    scalar_t seconds_to_derate;
+    scalar_t measured_c;
+
+    scalar_t prediction_c; // made at prediction_ms for (prediction_s) later
+    uint32_t prediction_ms;
+    bool prediction_made;
+    scalar_t last_predicted_c, last_actual_c;
+  };
+
+  thermal_config_t &config;
+
+  motor_t motors[THERMAL_MODEL_MAX_MOTORS];
+  int num_motors = 0;
+
+  uint32_t last_update_ms = 0;
+  bool updated = false;
+
+  void update_motor(motor_t &motor, scalar_t dt, uint32_t now);
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef _TRACTION_CONTROL_
+#define _TRACTION_CONTROL_
+
+#include "vex.h"
+#include "../core/include/utils/scalar.h"
+#include "../core/include/utils/vector.h"
+
+class SwerveModule;
+
+/**
+ * traction_control.h
+ *
+ * Wheel slip detection and traction control for a swerve drive.
+ *
+ * Every TRACTION_CONTROL_PERIOD_MS it estimates how fast the chassis is really moving: the
+ * IMU's acceleration is integrated, and pulled towards what the gripping wheels say. From
+ * that and the gyro's turn rate comes the speed of the floor under each wheel, along the
+ * way the wheel points. A wheel more than (slip_speed) off that, compared against the
+ * chassis speed from the IMU and the *other* wheels, is slipping: spinning up under hard
+ * acceleration, or skidding under hard braking.
+ *
+ * While a wheel slips, its drive command is held at the floor's speed until it grips
+ * again. Then it may lead the floor by most of what it led by when it broke loose, and
+ * that grows back gradually: it keeps just under where the wheel lets go, which is as
+ * much acceleration as the carpet can give.
+ *
+ * Distance is counted with the floor's speed while a wheel slips, so get_distance() only
+ * counts where the robot actually went.
+ */
+
+#define TRACTION_CONTROL_PERIOD_MS 10
+#define TRACTION_CONTROL_MAX_MODULES 4
+
+class TractionControl
+{
+public:
+  struct traction_config_t
+  {
+    scalar_t max_wheel_speed;     // in/s, wheel speed at full drive output
+    scalar_t slip_speed;          // in/s off the floor's speed before a wheel is slipping
+    scalar_t grip_speed;          // in/s off it before it grips again, below slip_speed
+    scalar_t min_lead;            // in/s ahead of the floor a wheel may always be driven
+    scalar_t lead_recovery_per_s; // in/s per second the allowed lead grows back
+    scalar_t correction_per_s;    // how quickly the chassis speed follows the gripping wheels
+  };
+
+  TractionControl(vex::inertial &imu, traction_config_t &config);
+
+  /**
+   * Watch (module), whose center is (x), (y) inches from the robot's (right and forward).
+   * Returns the module's index for drive_output() and the rest, or -1 if there are too many.
+   */
+  int add_module(SwerveModule &module, scalar_t x, scalar_t y);
+
+  /**
+   * The drive command (-1.0 -> 1.0) module (index) may have instead of (percent): close
+   * enough to the floor's speed that the wheel grips. (reversed) is true if the drive motor
+   * runs backwards to the way the module points.
+   */
+  scalar_t drive_output(int index, scalar_t percent, bool reversed);
+
+  /**
+   * Whether module (index) was slipping as of the last update
+   */
+  bool is_slipping(int index);
+
+  /**
+   * Inches module (index) has really rolled since reset_distance(), along the way it
+   * points: counted with the floor's speed while it slips
+   */
+  scalar_t get_distance(int index);
+  void reset_distance(int index);
+
+  /**
+   * The chassis' speed, from the IMU and the gripping wheels: x to the right and y
+   * forward, inches / second
+   */
+  Vector::point_t get_velocity();
+
+private:
+  struct module_t
+  {
+    SwerveModule *module;
+    scalar_t x, y;
+    scalar_t command;        // in/s last asked for, along the module
+    scalar_t wheel_speed;    // in/s along the module
+    scalar_t floor_speed;    // in/s of the floor under the wheel along the module
+    scalar_t lead_limit;     // in/s the command may be ahead of the floor
+    scalar_t learned_lead;   // in/s it was ahead by when the wheel last broke loose, scaled down
+    bool slipping;
+    scalar_t distance;
+    scalar_t last_rolling; // in/s the floor was moving under it, last update
+  };
+
+  vex::inertial &imu;
+  traction_config_t &config;
+
+  module_t modules[TRACTION_CONTROL_MAX_MODULES];
+  int num_modules = 0;
+
+  scalar_t vx = 0, vy = 0; // chassis, in/s
+  uint32_t last_update_ms = 0, all_slipping_ms = 0;
+  bool updated = false;
+
+  void update();
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef _TRAJECTORY_GENERATOR_
+#define _TRAJECTORY_GENERATOR_
+
+#include <stddef.h>
+#include "../core/include/utils/scalar.h"
+#include "../core/include/pathfinder/structs.h"
+
+/**
+ * trajectory_generator.h
+ *
+ * Makes trajectories through waypoints like pathfinder_prepare / pathfinder_generate do,
+ * into the same Segments (so pathfinder's modifiers and followers take them), but
+ * starting and ending at any speed instead of at rest. That's what a path re-made partway
+ * through, from the robot's current pose and speed, needs, and what paths driven one
+ * after another without stopping between them need.
+ *
+ * Each pair of waypoints is joined by a cubic Hermite curve, and the trajectory steps
+ * along them every (dt): speeding up at (max_a) to (max_v), and slowing down in time to
+ * stop at the last waypoint. Its cost is fixed by the waypoints and the room given for
+ * segments, not by how the curves come out, so it can run under a time budget.
+ *
+ * Same frame as pathfinder: x and y in inches, angles and headings in radians,
+ * counter-clockwise from the x axis.
+ */
+
+#define TRAJECTORY_MAX_WAYPOINTS 16
+#define TRAJECTORY_SAMPLES 64 // per curve, for measuring along it
+
+class TrajectoryGenerator
+{
+public:
+  struct generator_config_t
+  {
+    scalar_t max_v; // in/s
+    scalar_t max_a; // in/s^2
+    scalar_t dt;    // seconds between segments
+  };
+
+  TrajectoryGenerator(generator_config_t &config);
+
+  /**
+   * Fill (segments), with room for (max_length), with a trajectory through (waypoints),
+   * starting at (start_v) in/s and ending at (end_v). If the path is too short to get
+   * from one to the other at max_a, it ends as close to (end_v) as it can. If
+   * (waypoint_segments) isn't NULL, it gets the index of the first segment at or past each
+   * waypoint. Returns the number of segments, or -1 if they don't fit or the waypoints are
+   * unusable.
+   */
+  int generate(const Waypoint *waypoints, int count, scalar_t start_v, scalar_t end_v, Segment *segments,
+               int max_length, int *waypoint_segments = NULL);
+
+private:
+  struct curve_t
+  {
+    double x0, y0, dx0, dy0; // start point and tangent
+    double x1, y1, dx1, dy1; // end point and tangent
+  };
+
+  generator_config_t &config;
+
+  curve_t curves[TRAJECTORY_MAX_WAYPOINTS - 1];
+  double distances[TRAJECTORY_MAX_WAYPOINTS - 1][TRAJECTORY_SAMPLES + 1]; // along each curve, at each sample
+
+  void point(const curve_t &c, double t, double &x, double &y, double &heading) const;
+};
+
+#endif
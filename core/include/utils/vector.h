@@ -2,6 +2,7 @@
 #define _VECTOR_
 
 #include <cmath>
+#include "../core/include/utils/scalar.h"
 
 #define PI 3.141592654
 
@@ -11,7 +12,7 @@ public:
 
     struct point_t
     {
-        double x, y;
+        scalar_t x, y;
     };
 
     /**
@@ -20,7 +21,7 @@ public:
      * @param dir Direction, in radians. 'foward' is 0, clockwise positive when viewed from the top.
      * @param mag Magnitude.
      */ 
-    Vector(double dir, double mag);
+    Vector(scalar_t dir, scalar_t mag);
     
     /**
      * Construct a vector object from a cartesian point.
@@ -35,22 +36,22 @@ public:
      * 
      * Use r2d() to convert.
      */
-    double get_dir() const;
+    scalar_t get_dir() const;
 
     /**
      * Get the magnitude of the vector
      */
-    double get_mag() const;
+    scalar_t get_mag() const;
 
     /**
      * Get the X component of the vector; positive to the right.
      */
-    double get_x() const;
+    scalar_t get_x() const;
 
     /**
      * Get the Y component of the vector, positive forward.
      */
-    double get_y() const;
+    scalar_t get_y() const;
 
 
     Vector operator+(const Vector &other);
@@ -58,18 +59,18 @@ public:
 
 private:
 
-    double dir, mag;
+    scalar_t dir, mag;
 
 };
 
 /**
  * General function for converting degrees to radians
  */
-double deg2rad(double deg);
+scalar_t deg2rad(scalar_t deg);
 
 /**
  * General function for converting radians to degrees
  */
-double rad2deg(double r);
+scalar_t rad2deg(scalar_t r);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,122 @@
+#ifndef _SIM_MOTOR_MODEL_
+#define _SIM_MOTOR_MODEL_
+
+#include "sim/vex_units.h"
+
+namespace sim
+{
+
+/**
+ * Physics model of a single V5 smart motor, measured at the cartridge output shaft.
+ *
+ * Electrical: brushed DC motor with the V5 firmware's 2.5A current limit and thermal
+ * derating. Control: the motor's own velocity / position loops are modeled as
+ * simple P loops with a feedforward, run every physics step.
+ */
+class MotorModel
+{
+public:
+  enum mode_t
+  {
+    COAST, BRAKE, HOLD, VELOCITY, POSITION, VOLTAGE
+  };
+
+  MotorModel();
+
+  /**
+   * Configure the cartridge (36, 18 or 6 to 1)
+   */
+  void set_cartridge(vex::gearSetting gears);
+
+  void command_velocity(double rpm);
+  void command_position(double deg, double max_rpm);
+  void command_voltage(double volts);
+  void command_stop(vex::brakeType mode);
+
+  /**
+   * Motor torque (Nm at the output shaft) for the current command and speed,
+   * given the battery voltage. Does not change any state.
+   */
+  double drive_torque(double battery_v) const;
+
+  /**
+   * Integrate one physics step. external_torque is any load torque applied by the
+   * mechanism (Nm, at the output shaft). If the mechanism fixes the speed of this
+   * motor (e.g. a wheel gripping the floor), use set_velocity() afterwards.
+   */
+  void step(double dt, double battery_v, double external_torque);
+
+  /**
+   * Overwrite the shaft speed, in rad/s, for kinematically constrained mechanisms
+   */
+  void set_velocity(double rad_per_sec);
+
+  double free_speed() const; // rad/s at 12V
+  double stall_torque() const; // Nm
+  double rotor_inertia() const; // kg*m^2, reflected to the output
+
+  // Configuration
+  vex::gearSetting gears;
+  double ratio;
+  bool reversed;
+  double load_inertia; // kg*m^2 of the attached mechanism
+  double load_friction; // Nm of coulomb friction in the mechanism
+  double max_torque_pct;
+  vex::brakeType stopping;
+  bool claimed; // Stepped by a mechanism model instead of by the world
+
+  // Command
+  mode_t mode;
+  double target_rpm, target_deg, target_volts;
+
+  // State
+  double position_rad, velocity_rad, current_a, voltage_v, torque_nm, temperature_c;
+  double position_offset_rad;
+  bool installed;
+};
+
+/**
+ * The V5 battery: an ideal source with internal resistance, sagging as charge is used.
+ */
+class BatteryModel
+{
+public:
+  BatteryModel();
+
+  void step(double dt, double current_a);
+
+  /**
+   * Start from (pct) percent charge instead of full
+   */
+  void set_charge(double pct);
+
+  double voltage_v, current_a, capacity_pct, temperature_c;
+  double nominal_v, internal_ohms, capacity_mah;
+
+private:
+  double used_mah;
+};
+
+/**
+ * The V5 inertial sensor. Stays at zero until calibrated, like the real sensor.
+ */
+class ImuModel
+{
+public:
+  ImuModel();
+
+  /**
+   * Update from the chassis: heading (deg, clockwise), rate (deg/s) and
+   * acceleration in the robot frame (g's)
+   */
+  void update(double heading_deg, double rate_dps, double ax_g, double ay_g);
+
+  bool installed;
+  uint64_t calibration_done_us;
+  double heading_deg, rate_dps, ax_g, ay_g;
+  double heading_offset, rotation_offset;
+};
+
+} // namespace sim
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef _SIM_SCHEDULER_
+#define _SIM_SCHEDULER_
+
+#include <stdint.h>
+#include <functional>
+
+/**
+ * scheduler.h
+ *
+ * The virtual clock and the cooperative task scheduler behind vex::task / vexDelay.
+ *
+ * Like VEXos, exactly one task runs at a time, and it keeps running until it sleeps or
+ * yields. When every task is asleep, the clock jumps straight to the earliest wake up
+ * time (stepping the physics along the way), so the robot program runs as fast as the
+ * host can execute it unless a real time factor is set.
+ */
+namespace sim
+{
+
+/**
+ * Current virtual time, in microseconds
+ */
+uint64_t time_us();
+
+/**
+ * Put the calling task to sleep until the virtual clock reaches wake_us.
+ */
+void sleep_until(uint64_t wake_us);
+
+/**
+ * Put the calling task to sleep for (us) virtual microseconds
+ */
+void sleep_for(uint64_t us);
+
+/**
+ * Let every other task that is ready at the current time run once.
+ */
+void yield();
+
+/**
+ * Charge the calling task for reading a device. Busy-waits such as
+ * "while(imu.isCalibrating());" never yield, so each poll advances the clock a little
+ * to keep them from hanging the simulation.
+ */
+void poll();
+
+/**
+ * Start a new task. It first runs the next time the calling task yields.
+ * @returns the task's id
+ */
+int spawn(std::function<int()> fn, const char *name);
+
+/**
+ * Stop a task. It will never be scheduled again.
+ */
+void kill(int id);
+
+/**
+ * Id of the running task
+ */
+int current_task();
+
+/**
+ * Run at (factor) times real time. 0 (default) runs as fast as possible.
+ */
+void set_realtime_factor(double factor);
+
+/**
+ * Print the per-task cycle time statistics
+ */
+void print_task_stats();
+
+} // namespace sim
+
+#endif
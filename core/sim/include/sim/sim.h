@@ -0,0 +1,75 @@
+#ifndef _SIM_SIM_
+#define _SIM_SIM_
+
+#include <stdint.h>
+#include "sim/scheduler.h"
+#include "sim/world.h"
+#include "sim/swerve_model.h"
+
+/**
+ * sim.h
+ *
+ * Host simulation of the V5 for running robot code on Linux. The robot program is
+ * built unchanged against the stand-in vex API in core/sim/include, and started like
+ * any other executable. Run-time options come from the environment:
+ *
+ *  SIM_MODE      auto (default), driver, match or skills
+ *  SIM_SPEED     real time factor, 0 (default) for as fast as possible
+ *  SIM_TRACE     csv file to write the robot state to every 10ms
+ *  SIM_INPUT     csv file of controller inputs: time_ms, axis1-4, buttons
+ *  SIM_SDCARD    directory standing in for the SD card (default "sdcard")
+ *  SIM_POLL_US   virtual time charged for each device read (default 20)
+ *  SIM_BATTERY   battery charge at the start, in percent (default 100)
+ *
+ * When the selected period(s) are over, a report with timing and the final pose is
+ * printed and the program exits.
+ */
+namespace sim
+{
+
+struct sim_config_t
+{
+  enum mode_t
+  {
+    AUTO, DRIVER, MATCH, SKILLS
+  };
+
+  mode_t mode;
+  double realtime_factor;
+  const char *trace_path;
+  const char *input_path;
+  const char *sdcard_dir;
+  uint64_t poll_cost_us;
+  double battery_pct;
+};
+
+/**
+ * Options, read from the environment on first use
+ */
+sim_config_t &config();
+
+/**
+ * Build the robot's drivetrain model. Implemented by each project (sim/robot_model.cpp)
+ * with its own ports and dimensions.
+ */
+void configure_robot(World &world);
+
+/**
+ * Set a controller's inputs. Axis values are -100 -> 100.
+ */
+void set_controller_axis(int controller, int axis, int32_t value);
+void set_controller_buttons(int controller, uint32_t pressed_mask);
+
+/**
+ * Apply the SIM_INPUT script for the current time, if there is one
+ */
+void update_input();
+
+/**
+ * Print the report and end the simulation.
+ */
+void finish(int exit_code);
+
+} // namespace sim
+
+#endif
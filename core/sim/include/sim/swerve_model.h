@@ -0,0 +1,65 @@
+#ifndef _SIM_SWERVE_MODEL_
+#define _SIM_SWERVE_MODEL_
+
+#include "sim/world.h"
+
+namespace sim
+{
+
+/**
+ * Four module swerve drive, with the direction motor geared to both the module and
+ * (through the coaxial drive gearing) the wheel.
+ *
+ * Each wheel either grips the floor, in which case it moves with the chassis and the
+ * drive motor carries a quarter of the robot's mass, or it slips, in which case it
+ * spins on its own and pushes the chassis with the kinetic friction force.
+ */
+class SwerveModel : public ChassisModel
+{
+public:
+  struct module_t
+  {
+    int32_t drive_port, dir_port;
+    double x, y; // Location on the robot, inches (x right, y forward from center)
+  };
+
+  struct swerve_config_t
+  {
+    module_t modules[4];
+
+    double dir_ratio; // module degrees per direction motor degree
+    double drive_ratio; // wheel revs per drive motor rev
+    double coupling; // wheel revs per direction motor rev
+    double wheel_diam; // inches
+
+    double mass; // kg
+    double friction_coeff; // wheel <-> floor
+  };
+
+  SwerveModel(swerve_config_t &config);
+
+  void attach(World &world) override;
+  void step(World &world, double dt) override;
+  void trace_header(FILE *f) override;
+  void trace(FILE *f) override;
+
+  /**
+   * Module angle relative to the robot, degrees clockwise
+   */
+  double module_angle(int i);
+
+  /**
+   * Whether the wheel on module i lost traction in the last step
+   */
+  bool is_slipping(int i);
+
+private:
+  swerve_config_t config;
+
+  double wheel_speed[4]; // contact speed of each wheel along its heading, m/s
+  bool slipping[4];
+};
+
+} // namespace sim
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef _SIM_VEX_BRAIN_
+#define _SIM_VEX_BRAIN_
+
+#include "sim/vex_units.h"
+#include "sim/vex_timer.h"
+#include "sim/vex_triport.h"
+
+namespace vex
+{
+
+/**
+ * The V5 brain. The screen is echoed to stdout, and the SD card is a directory on
+ * the host (SIM_SDCARD, default "sdcard").
+ */
+class brain
+{
+public:
+  class lcd
+  {
+  public:
+    lcd();
+
+    void print(const char *format, ...);
+    void printAt(int32_t x, int32_t y, const char *format, ...);
+    void setCursor(int32_t row, int32_t col);
+    void newLine();
+    void clearScreen();
+    void clearLine();
+    void clearLine(int32_t row);
+    int32_t row();
+    int32_t column();
+
+  private:
+    int32_t cursor_row, cursor_col;
+  };
+
+  class battery
+  {
+  public:
+    double capacity(percentUnits units = percentUnits::pct);
+    double voltage(voltageUnits units = voltageUnits::volt);
+    double current(currentUnits units = currentUnits::amp);
+    double temperature(percentUnits units = percentUnits::pct);
+  };
+
+  class sdcard
+  {
+  public:
+    bool isInserted();
+    int32_t loadfile(const char *name, uint8_t *buffer, int32_t len);
+    int32_t savefile(const char *name, uint8_t *buffer, int32_t len);
+    int32_t appendfile(const char *name, uint8_t *buffer, int32_t len);
+    int32_t size(const char *name);
+    bool exists(const char *name);
+  };
+
+  brain();
+
+  lcd Screen;
+  battery Battery;
+  sdcard SDcard;
+  timer Timer;
+  triport ThreeWirePort;
+};
+
+} // namespace vex
+
+#endif
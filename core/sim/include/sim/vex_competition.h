@@ -0,0 +1,31 @@
+#ifndef _SIM_VEX_COMPETITION_
+#define _SIM_VEX_COMPETITION_
+
+#include "sim/vex_units.h"
+
+namespace vex
+{
+
+/**
+ * Competition control. Registering the callbacks starts the simulated field
+ * controller, which runs the period(s) selected with SIM_MODE and then ends the
+ * simulation with a report (see sim/sim.h).
+ */
+class competition
+{
+public:
+  competition();
+
+  void autonomous(void (*callback)(void));
+  void drivercontrol(void (*callback)(void));
+
+  bool isEnabled();
+  bool isDriverControl();
+  bool isAutonomous();
+  bool isCompetitionSwitch();
+  bool isFieldControl();
+};
+
+} // namespace vex
+
+#endif
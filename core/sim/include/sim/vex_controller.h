@@ -0,0 +1,70 @@
+#ifndef _SIM_VEX_CONTROLLER_
+#define _SIM_VEX_CONTROLLER_
+
+#include "sim/vex_units.h"
+
+namespace vex
+{
+
+/**
+ * V5 controller. Inputs come from the sim's input script (SIM_INPUT) or from
+ * sim::set_controller_axis / sim::set_controller_buttons.
+ */
+class controller
+{
+public:
+  class axis
+  {
+  public:
+    axis(controllerType id, int32_t index);
+
+    int32_t value();
+    int32_t position(percentUnits units = percentUnits::pct);
+
+  private:
+    controllerType id;
+    int32_t index;
+  };
+
+  class button
+  {
+  public:
+    button(controllerType id, int32_t index);
+
+    bool pressing();
+
+  private:
+    controllerType id;
+    int32_t index;
+  };
+
+  class lcd
+  {
+  public:
+    void print(const char *format, ...);
+    void setCursor(int32_t row, int32_t col);
+    void clearScreen();
+    void clearLine(int32_t row);
+  };
+
+  enum button_id_t
+  {
+    BTN_L1, BTN_L2, BTN_R1, BTN_R2, BTN_UP, BTN_DOWN, BTN_LEFT, BTN_RIGHT,
+    BTN_X, BTN_B, BTN_Y, BTN_A
+  };
+
+  controller(controllerType id = controllerType::primary);
+
+  void rumble(const char *pattern);
+  bool installed();
+
+  axis Axis1, Axis2, Axis3, Axis4;
+  button ButtonL1, ButtonL2, ButtonR1, ButtonR2;
+  button ButtonUp, ButtonDown, ButtonLeft, ButtonRight;
+  button ButtonX, ButtonB, ButtonY, ButtonA;
+  lcd Screen;
+};
+
+} // namespace vex
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef _SIM_VEX_IMU_
+#define _SIM_VEX_IMU_
+
+#include "sim/vex_units.h"
+
+namespace sim
+{
+class ImuModel;
+}
+
+namespace vex
+{
+
+/**
+ * V5 inertial sensor. Rotation is clockwise positive, viewed from the top.
+ */
+class inertial
+{
+public:
+  inertial(int32_t index, turnType dir = turnType::right);
+
+  void calibrate(int32_t value = 0);
+  void startCalibration(int32_t value = 0);
+  bool isCalibrating();
+
+  void resetHeading();
+  void resetRotation();
+  void setHeading(double value, rotationUnits units);
+  void setRotation(double value, rotationUnits units);
+
+  double heading(rotationUnits units = rotationUnits::deg);
+  double rotation(rotationUnits units = rotationUnits::deg);
+  double angle(rotationUnits units = rotationUnits::deg);
+  double roll(rotationUnits units = rotationUnits::deg);
+  double pitch(rotationUnits units = rotationUnits::deg);
+  double yaw(rotationUnits units = rotationUnits::deg);
+  double orientation(orientationType type, rotationUnits units);
+
+  double gyroRate(axisType axis, velocityUnits units);
+
+  /**
+   * Acceleration along an axis of the sensor, in g's
+   */
+  double acceleration(axisType axis);
+
+  bool installed();
+
+private:
+  int32_t port;
+  sim::ImuModel *model;
+};
+
+} // namespace vex
+
+#endif
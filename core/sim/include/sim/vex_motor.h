@@ -0,0 +1,144 @@
+#ifndef _SIM_VEX_MOTOR_
+#define _SIM_VEX_MOTOR_
+
+#include "sim/vex_units.h"
+
+namespace sim
+{
+class MotorModel;
+}
+
+namespace vex
+{
+
+/**
+ * V5 smart motor. All state lives in the simulated device on the same port, so two
+ * motor objects sharing a port behave like they do on the robot.
+ */
+class motor
+{
+public:
+  motor(int32_t index);
+  motor(int32_t index, bool reverse);
+  motor(int32_t index, gearSetting gears);
+  motor(int32_t index, gearSetting gears, bool reverse);
+
+  void setReversed(bool value);
+  void setVelocity(double velocity, velocityUnits units);
+  void setVelocity(double velocity, percentUnits units);
+  void setStopping(brakeType mode);
+  void setBrake(brakeType mode);
+  void setMaxTorque(double value, percentUnits units);
+  void setTimeout(int32_t time, timeUnits units);
+
+  void resetPosition();
+  void resetRotation();
+  void setPosition(double value, rotationUnits units);
+  void setRotation(double value, rotationUnits units);
+
+  void spin(directionType dir);
+  void spin(directionType dir, double velocity, velocityUnits units);
+  void spin(directionType dir, double velocity, percentUnits units);
+  void spin(directionType dir, double voltage, voltageUnits units);
+
+  bool spinTo(double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion = true);
+  bool spinTo(double rotation, rotationUnits units, bool waitForCompletion = true);
+  bool spinToPosition(double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion = true);
+  bool spinFor(double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion = true);
+
+  bool isSpinning();
+  bool isDone();
+
+  void stop();
+  void stop(brakeType mode);
+
+  double rotation(rotationUnits units);
+  double position(rotationUnits units);
+  double velocity(velocityUnits units);
+  double velocity(percentUnits units);
+  double current(currentUnits units = currentUnits::amp);
+  double current(percentUnits units);
+  double voltage(voltageUnits units = voltageUnits::volt);
+  double power(powerUnits units = powerUnits::watt);
+  double torque(torqueUnits units = torqueUnits::Nm);
+  double efficiency(percentUnits units = percentUnits::pct);
+  double temperature(percentUnits units = percentUnits::pct);
+  double temperature(temperatureUnits units);
+
+  bool installed();
+  int32_t index();
+
+private:
+  friend class motor_group;
+
+  double to_rpm(double velocity, velocityUnits units);
+  double from_deg(double deg, rotationUnits units);
+  double to_deg(double value, rotationUnits units);
+
+  int32_t port;
+  gearSetting gears;
+  double set_velocity_rpm;
+  sim::MotorModel *model;
+};
+
+/**
+ * A set of motors commanded together. Readings come from the first motor.
+ */
+class motor_group
+{
+public:
+  motor_group();
+
+  template <typename... Args>
+  motor_group(motor &m1, Args &... m2) : count_(0)
+  {
+    add(m1, m2...);
+  }
+
+  int32_t count();
+
+  void setVelocity(double velocity, velocityUnits units);
+  void setVelocity(double velocity, percentUnits units);
+  void setStopping(brakeType mode);
+  void setReversed(bool value);
+  void resetPosition();
+  void resetRotation();
+  void setPosition(double value, rotationUnits units);
+
+  void spin(directionType dir);
+  void spin(directionType dir, double velocity, velocityUnits units);
+  void spin(directionType dir, double velocity, percentUnits units);
+  void spin(directionType dir, double voltage, voltageUnits units);
+  bool spinTo(double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion = true);
+
+  void stop();
+  void stop(brakeType mode);
+
+  double rotation(rotationUnits units);
+  double position(rotationUnits units);
+  double velocity(velocityUnits units);
+  double velocity(percentUnits units);
+  double current(currentUnits units = currentUnits::amp);
+  double voltage(voltageUnits units = voltageUnits::volt);
+  double temperature(percentUnits units = percentUnits::pct);
+
+  static const int32_t max_motors = 8;
+
+private:
+  void add() {}
+
+  template <typename... Args>
+  void add(motor &m, Args &... rest)
+  {
+    if (count_ < max_motors)
+      motors[count_++] = &m;
+    add(rest...);
+  }
+
+  motor *motors[max_motors];
+  int32_t count_;
+};
+
+} // namespace vex
+
+#endif
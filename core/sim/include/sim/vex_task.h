@@ -0,0 +1,60 @@
+#ifndef _SIM_VEX_TASK_
+#define _SIM_VEX_TASK_
+
+#include "sim/vex_units.h"
+
+namespace vex
+{
+
+/**
+ * A VEXos task. Tasks in the simulator are real host threads, but only one of them
+ * runs at a time and they hand over at the same points VEXos would switch: a delay,
+ * a yield, or waiting on a mutex.
+ */
+class task
+{
+public:
+  task();
+  task(int (*callback)(void));
+  task(int (*callback)(void *), void *arg);
+
+  void stop();
+  void setPriority(int32_t priority);
+  int32_t priority();
+
+  static void sleep(uint32_t time);
+  static void yield();
+
+  static const int32_t taskPriorityNormal = 7;
+
+private:
+  int id;
+  int32_t prio;
+};
+
+/**
+ * Cooperative mutex; waiting on a locked mutex yields to other tasks
+ */
+class mutex
+{
+public:
+  mutex();
+
+  void lock();
+  bool try_lock();
+  void unlock();
+
+private:
+  bool locked;
+};
+
+namespace this_thread
+{
+int32_t get_id();
+void sleep_for(uint32_t time_ms);
+void yield();
+} // namespace this_thread
+
+} // namespace vex
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef _SIM_VEX_TIMER_
+#define _SIM_VEX_TIMER_
+
+#include "sim/vex_units.h"
+
+namespace vex
+{
+
+/**
+ * Stopwatch running on the simulator's virtual clock
+ */
+class timer
+{
+public:
+  timer();
+
+  /**
+   * Time since the last reset, in milliseconds
+   */
+  uint32_t time() const;
+  double time(timeUnits units) const;
+
+  /**
+   * Time since the last reset, in seconds
+   */
+  double value() const;
+
+  void clear();
+  void reset();
+
+  static uint32_t system();
+  static uint64_t systemHighResolution();
+
+private:
+  uint64_t start_us;
+};
+
+/**
+ * Suspend the calling task, same as vexDelay()
+ */
+void wait(double time, timeUnits units);
+
+} // namespace vex
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef _SIM_VEX_TRIPORT_
+#define _SIM_VEX_TRIPORT_
+
+#include "sim/vex_units.h"
+
+namespace vex
+{
+
+/**
+ * The 8 three wire ports on the brain. Outputs are only recorded; nothing is
+ * connected to them in the simulated world.
+ */
+class triport
+{
+public:
+  class port
+  {
+  public:
+    port();
+    port(int32_t id);
+
+    void set(bool value);
+    int32_t value();
+    int32_t id() const;
+
+  private:
+    int32_t id_;
+  };
+
+  triport();
+
+  port A, B, C, D, E, F, G, H;
+};
+
+class digital_out
+{
+public:
+  digital_out(triport::port port);
+
+  void set(bool value);
+  int32_t value();
+
+private:
+  triport::port port;
+};
+
+class digital_in
+{
+public:
+  digital_in(triport::port port);
+
+  int32_t value();
+
+private:
+  triport::port port;
+};
+
+} // namespace vex
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef _SIM_VEX_UNITS_
+#define _SIM_VEX_UNITS_
+
+#include <stdint.h>
+
+namespace vex
+{
+
+enum class timeUnits { sec, msec };
+enum class velocityUnits { pct, rpm, dps };
+enum class rotationUnits { deg, rev, raw };
+enum class voltageUnits { volt, mV };
+enum class currentUnits { amp };
+enum class percentUnits { pct };
+enum class torqueUnits { Nm, InLb };
+enum class powerUnits { watt };
+enum class temperatureUnits { celsius, fahrenheit };
+enum class analogUnits { pct, range8bit, range10bit, range12bit, mV };
+enum class directionType { fwd, rev, undefined };
+enum class brakeType { coast, brake, hold, undefined };
+enum class gearSetting { ratio36_1, ratio18_1, ratio6_1 };
+enum class axisType { xaxis, yaxis, zaxis };
+enum class orientationType { roll, pitch, yaw };
+enum class turnType { left, right };
+enum class controllerType { primary, partner };
+
+const timeUnits sec = timeUnits::sec;
+const timeUnits msec = timeUnits::msec;
+
+// Smart ports are zero indexed, same as the real SDK
+const int32_t PORT1 = 0, PORT2 = 1, PORT3 = 2, PORT4 = 3, PORT5 = 4, PORT6 = 5, PORT7 = 6;
+const int32_t PORT8 = 7, PORT9 = 8, PORT10 = 9, PORT11 = 10, PORT12 = 11, PORT13 = 12, PORT14 = 13;
+const int32_t PORT15 = 14, PORT16 = 15, PORT17 = 16, PORT18 = 17, PORT19 = 18, PORT20 = 19, PORT21 = 20;
+
+} // namespace vex
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef _SIM_WORLD_
+#define _SIM_WORLD_
+
+#include <stdint.h>
+#include <stdio.h>
+#include "sim/motor_model.h"
+
+namespace sim
+{
+
+class World;
+
+/**
+ * Robot position on the field. x and y are in inches (x right, y forward from the
+ * starting position), heading is in degrees, clockwise positive from the top, which
+ * matches the IMU and the Vector class.
+ */
+struct pose_t
+{
+  double x, y, heading;
+};
+
+/**
+ * Base for drivetrain models. A chassis model reads the motors it is built from and
+ * moves the robot around the field each physics step.
+ */
+class ChassisModel
+{
+public:
+  virtual ~ChassisModel() {}
+
+  /**
+   * Hook the model into the world, e.g. to set the load each motor sees.
+   */
+  virtual void attach(World &world) = 0;
+
+  /**
+   * Step all the motors owned by the chassis, and the chassis itself.
+   */
+  virtual void step(World &world, double dt) = 0;
+
+  /**
+   * Write the names of the chassis specific trace columns, each preceded by a comma
+   */
+  virtual void trace_header(FILE *f) {}
+
+  /**
+   * Write this step's chassis specific columns to the trace file
+   */
+  virtual void trace(FILE *f) {}
+
+  pose_t pose = {0, 0, 0};
+
+  // Velocity in the robot frame (inches/s, inches/s, deg/s clockwise)
+  double vx = 0, vy = 0, omega = 0;
+
+  // Acceleration in the robot frame (inches/s^2)
+  double ax = 0, ay = 0;
+};
+
+/**
+ * Everything that exists in the simulation: the devices on each smart port, the
+ * battery, the controllers and the drivetrain connecting it all.
+ */
+class World
+{
+public:
+  static const int32_t num_ports = 21;
+
+  static World &instance();
+
+  MotorModel &motor(int32_t port);
+  ImuModel &imu(int32_t port);
+
+  /**
+   * Set the drivetrain model. The world takes ownership.
+   */
+  void set_chassis(ChassisModel *chassis);
+
+  /**
+   * Step the physics forward until the world's clock reaches t_us.
+   */
+  void advance_to(uint64_t t_us);
+
+  /**
+   * Write a row of the trace file every trace_period_us, if SIM_TRACE is set.
+   */
+  void open_trace(const char *path, uint64_t period_us);
+
+  BatteryModel battery;
+  ChassisModel *chassis;
+
+  int32_t axis[2][4];
+  uint32_t buttons[2];
+  bool triport_out[8];
+
+  uint64_t time_us;
+  uint64_t step_us;
+
+  // Set false to let the clock run without simulating anything, e.g. for benchmarks
+  bool physics_enabled;
+
+  // Extremes seen over the whole run, for the final report
+  double peak_current_a, min_battery_v, peak_temperature_c;
+
+private:
+  World();
+
+  void step(double dt);
+
+  MotorModel motors[num_ports];
+  ImuModel imus[num_ports];
+
+  FILE *trace_file;
+  uint64_t trace_period_us, next_trace_us;
+};
+
+} // namespace sim
+
+#endif
@@ -0,0 +1,38 @@
+/**
+ * v5.h (simulation)
+ *
+ * Host stand-in for the low level VEX V5 C API. Only the handful of calls the robot
+ * code actually uses are provided; time is virtual and owned by the sim scheduler
+ * (see sim/scheduler.h), so vexDelay() returns as soon as every other task has had
+ * its turn rather than after wall-clock time has passed.
+ */
+#ifndef _SIM_V5_
+#define _SIM_V5_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Suspend the calling task for the given number of (virtual) milliseconds.
+ */
+void vexDelay(uint32_t timems);
+
+/**
+ * Virtual time since the program started, in milliseconds
+ */
+uint32_t vexSystemTimeGet(void);
+
+/**
+ * Virtual time since the program started, in microseconds
+ */
+uint64_t vexSystemHighResTimeGet(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
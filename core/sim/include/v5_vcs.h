@@ -0,0 +1,23 @@
+/**
+ * v5_vcs.h (simulation)
+ *
+ * Host stand-in for the VEX V5 C++ API. Every device is backed by a model in the
+ * simulated world (see sim/world.h), so robot code written against vex.h compiles
+ * and runs unchanged on Linux.
+ */
+#ifndef _SIM_V5_VCS_
+#define _SIM_V5_VCS_
+
+#include "v5.h"
+
+#include "sim/vex_units.h"
+#include "sim/vex_timer.h"
+#include "sim/vex_task.h"
+#include "sim/vex_motor.h"
+#include "sim/vex_imu.h"
+#include "sim/vex_triport.h"
+#include "sim/vex_brain.h"
+#include "sim/vex_controller.h"
+#include "sim/vex_competition.h"
+
+#endif
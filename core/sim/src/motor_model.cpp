@@ -0,0 +1,218 @@
+#include "sim/motor_model.h"
+#include <math.h>
+
+// V5 motor characteristics, at the 36:1 (red) cartridge output
+#define STALL_TORQUE_36 2.1 // Nm
+#define FREE_SPEED_36 (100.0 * 2.0 * M_PI / 60.0) // rad/s at 12V
+#define CURRENT_LIMIT 2.5 // A
+#define MAX_VOLTS 12.0
+#define ARMATURE_OHMS 3.0
+#define WINDING_OHMS 1.5 // The part of the resistance that heats the motor
+#define ROTOR_INERTIA 1.0e-6 // kg*m^2 before the cartridge
+#define MOTOR_FRICTION_36 0.05 // Nm
+
+// Thermal model: time constant of a few minutes, ~55C after sustained stall
+#define AMBIENT_C 25.0
+#define THERMAL_OHMS 3.5 // C per W
+#define THERMAL_MASS 60.0 // J per C
+
+// Internal control loops of the motor firmware
+#define VEL_KP 5.0 // multiple of the back-emf constant
+#define POS_KP 20.0 // 1/s
+
+#define SUBSTEPS 10
+
+namespace
+{
+double clamp(double val, double lim)
+{
+  return val > lim ? lim : (val < -lim ? -lim : val);
+}
+} // namespace
+
+sim::MotorModel::MotorModel()
+    : gears(vex::gearSetting::ratio18_1), ratio(18), reversed(false), load_inertia(0), load_friction(0),
+      max_torque_pct(100), stopping(vex::brakeType::coast), claimed(false), mode(COAST), target_rpm(0), target_deg(0), target_volts(0), position_rad(0),
+      velocity_rad(0), current_a(0), voltage_v(0), torque_nm(0), temperature_c(AMBIENT_C),
+      position_offset_rad(0), installed(false)
+{
+}
+
+void sim::MotorModel::set_cartridge(vex::gearSetting gears)
+{
+  this->gears = gears;
+  switch (gears)
+  {
+  case vex::gearSetting::ratio36_1:
+    ratio = 36;
+    break;
+  case vex::gearSetting::ratio6_1:
+    ratio = 6;
+    break;
+  default:
+    ratio = 18;
+    break;
+  }
+}
+
+double sim::MotorModel::free_speed() const { return FREE_SPEED_36 * 36.0 / ratio; }
+double sim::MotorModel::stall_torque() const { return STALL_TORQUE_36 * ratio / 36.0; }
+double sim::MotorModel::rotor_inertia() const { return ROTOR_INERTIA * ratio * ratio; }
+
+void sim::MotorModel::command_velocity(double rpm)
+{
+  mode = VELOCITY;
+  target_rpm = rpm;
+}
+
+void sim::MotorModel::command_position(double deg, double max_rpm)
+{
+  mode = POSITION;
+  target_deg = deg;
+  target_rpm = fabs(max_rpm);
+}
+
+void sim::MotorModel::command_voltage(double volts)
+{
+  mode = VOLTAGE;
+  target_volts = volts;
+}
+
+void sim::MotorModel::command_stop(vex::brakeType brake)
+{
+  switch (brake)
+  {
+  case vex::brakeType::hold:
+    mode = HOLD;
+    target_deg = (position_rad - position_offset_rad) * 180.0 / M_PI;
+    target_rpm = free_speed() * 60.0 / (2.0 * M_PI);
+    break;
+  case vex::brakeType::brake:
+    mode = BRAKE;
+    break;
+  default:
+    mode = COAST;
+    break;
+  }
+}
+
+double sim::MotorModel::drive_torque(double battery_v) const
+{
+  double ke = MAX_VOLTS / free_speed();
+  double kt = stall_torque() / CURRENT_LIMIT;
+  double volts = 0;
+
+  if (mode == COAST)
+    return 0;
+
+  // Velocity setpoint for the closed loop modes
+  double target_w = 0;
+  if (mode == VELOCITY)
+    target_w = target_rpm * 2.0 * M_PI / 60.0;
+  else if (mode == POSITION || mode == HOLD)
+  {
+    double err = target_deg * M_PI / 180.0 - (position_rad - position_offset_rad);
+    target_w = clamp(POS_KP * err, target_rpm * 2.0 * M_PI / 60.0);
+  }
+
+  // Voltage commands are a duty cycle with MAX_VOLTS as full scale, so they sag with
+  // the battery. The internal loops regulate against the actual battery voltage.
+  if (mode == VOLTAGE)
+    volts = clamp(target_volts, MAX_VOLTS) * battery_v / MAX_VOLTS;
+  else if (mode != BRAKE)
+    volts = target_w * ke + VEL_KP * ke * (target_w - velocity_rad);
+
+  volts = clamp(volts, fmin(MAX_VOLTS, battery_v));
+
+  // Current limit shrinks as the motor heats up
+  double limit = CURRENT_LIMIT * max_torque_pct / 100.0;
+  if (temperature_c >= 65)
+    limit = 0;
+  else if (temperature_c >= 60)
+    limit *= .25;
+  else if (temperature_c >= 55)
+    limit *= .5;
+
+  double amps = clamp((volts - ke * velocity_rad) / ARMATURE_OHMS, limit);
+  return kt * amps;
+}
+
+void sim::MotorModel::step(double dt, double battery_v, double external_torque)
+{
+  double ke = MAX_VOLTS / free_speed();
+  double kt = stall_torque() / CURRENT_LIMIT;
+  double inertia = rotor_inertia() + load_inertia;
+  double friction = MOTOR_FRICTION_36 * ratio / 36.0 + load_friction;
+  double sub_dt = dt / SUBSTEPS;
+
+  double heat = 0;
+  for (int i = 0; i < SUBSTEPS; i++)
+  {
+    torque_nm = drive_torque(battery_v);
+    current_a = torque_nm / kt;
+    voltage_v = mode == COAST ? ke * velocity_rad : current_a * ARMATURE_OHMS + ke * velocity_rad;
+
+    double net = torque_nm + external_torque;
+
+    // Coulomb friction, which can hold the shaft still
+    if (fabs(velocity_rad) < 1e-6 && fabs(net) <= friction)
+      velocity_rad = 0;
+    else
+    {
+      double new_vel = velocity_rad + (net - (velocity_rad >= 0 ? friction : -friction)) / inertia * sub_dt;
+      // Friction stops the shaft, it does not reverse it
+      if (fabs(net) <= friction && new_vel * velocity_rad < 0)
+        new_vel = 0;
+      velocity_rad = new_vel;
+    }
+
+    position_rad += velocity_rad * sub_dt;
+    heat += current_a * current_a * WINDING_OHMS * sub_dt;
+  }
+
+  temperature_c += (heat - (temperature_c - AMBIENT_C) / THERMAL_OHMS * dt) / THERMAL_MASS;
+}
+
+void sim::MotorModel::set_velocity(double rad_per_sec)
+{
+  velocity_rad = rad_per_sec;
+}
+
+sim::BatteryModel::BatteryModel()
+    : voltage_v(12.8), current_a(0), capacity_pct(100), temperature_c(AMBIENT_C), nominal_v(12.8),
+      internal_ohms(0.15), capacity_mah(1100), used_mah(0)
+{
+}
+
+void sim::BatteryModel::step(double dt, double current_a)
+{
+  this->current_a = current_a;
+  used_mah += current_a * dt * 1000.0 / 3600.0;
+  capacity_pct = 100.0 * (1.0 - used_mah / capacity_mah);
+  if (capacity_pct < 0)
+    capacity_pct = 0;
+
+  // Open circuit voltage falls off roughly linearly with charge used (12.8 -> 11.5V)
+  double open_v = nominal_v - 1.3 * (1.0 - capacity_pct / 100.0);
+  voltage_v = open_v - current_a * internal_ohms;
+}
+
+void sim::BatteryModel::set_charge(double pct)
+{
+  used_mah = capacity_mah * (1.0 - pct / 100.0);
+  step(0, current_a);
+}
+
+sim::ImuModel::ImuModel()
+    : installed(false), calibration_done_us(0), heading_deg(0), rate_dps(0), ax_g(0), ay_g(0), heading_offset(0),
+      rotation_offset(0)
+{
+}
+
+void sim::ImuModel::update(double heading_deg, double rate_dps, double ax_g, double ay_g)
+{
+  this->heading_deg = heading_deg;
+  this->rate_dps = rate_dps;
+  this->ax_g = ax_g;
+  this->ay_g = ay_g;
+}
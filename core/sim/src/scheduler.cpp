@@ -0,0 +1,241 @@
+#include "sim/scheduler.h"
+#include "sim/sim.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+
+namespace
+{
+
+typedef std::chrono::steady_clock host_clock;
+
+struct task_t
+{
+  int id;
+  const char *name;
+  uint64_t wake_us;
+  bool alive;
+
+  // Host time spent running between sleeps
+  host_clock::time_point cycle_start;
+  uint64_t cycles;
+  double cycle_total_us, cycle_max_us;
+};
+
+std::mutex sched_mutex;
+std::condition_variable sched_cv;
+std::vector<task_t *> tasks;
+task_t *running = NULL;
+uint64_t now_us = 0;
+
+double realtime_factor = 0;
+host_clock::time_point wall_start;
+
+thread_local task_t *self = NULL;
+
+/**
+ * The first thread to touch the scheduler (main()) becomes task 0
+ */
+task_t *this_task()
+{
+  if (self == NULL)
+  {
+    self = new task_t{(int)tasks.size(), "main", now_us, true, host_clock::now(), 0, 0, 0};
+    tasks.push_back(self);
+    if (running == NULL)
+    {
+      running = self;
+      realtime_factor = sim::config().realtime_factor;
+      wall_start = host_clock::now();
+    }
+  }
+  return self;
+}
+
+/**
+ * Move the virtual clock (and the physics with it), holding back to real time if
+ * a factor was set.
+ */
+void advance_clock(uint64_t t_us)
+{
+  if (t_us <= now_us)
+    return;
+
+  now_us = t_us;
+  sim::World::instance().advance_to(now_us);
+
+  if (realtime_factor > 0)
+    std::this_thread::sleep_until(wall_start + std::chrono::microseconds((uint64_t)(now_us / realtime_factor)));
+}
+
+/**
+ * Pick the next task to run: earliest wake time first, round robin between tasks
+ * that are ready at the same time.
+ */
+task_t *next_task(task_t *from)
+{
+  task_t *best = NULL;
+  size_t n = tasks.size();
+  for (size_t i = 1; i <= n; i++)
+  {
+    task_t *t = tasks[(from->id + i) % n];
+    if (t->alive && (best == NULL || t->wake_us < best->wake_us))
+      best = t;
+  }
+  return best;
+}
+
+void end_cycle(task_t *t)
+{
+  double us = std::chrono::duration<double, std::micro>(host_clock::now() - t->cycle_start).count();
+  t->cycles++;
+  t->cycle_total_us += us;
+  if (us > t->cycle_max_us)
+    t->cycle_max_us = us;
+}
+
+/**
+ * Hand the processor to the next task and block until it is our turn again.
+ * Called with the lock held.
+ */
+void switch_task(std::unique_lock<std::mutex> &lock, task_t *me)
+{
+  task_t *next = next_task(me);
+  if (next == NULL)
+  {
+    lock.unlock();
+    sim::finish(0);
+  }
+
+  advance_clock(next->wake_us);
+
+  if (next != me)
+  {
+    running = next;
+    sched_cv.notify_all();
+    sched_cv.wait(lock, [me] { return running == me; });
+  }
+
+  me->cycle_start = host_clock::now();
+}
+
+} // namespace
+
+uint64_t sim::time_us()
+{
+  return now_us;
+}
+
+void sim::sleep_until(uint64_t wake_us)
+{
+  std::unique_lock<std::mutex> lock(sched_mutex);
+  task_t *me = this_task();
+
+  if (wake_us > now_us)
+    end_cycle(me);
+
+  me->wake_us = wake_us < now_us ? now_us : wake_us;
+  switch_task(lock, me);
+}
+
+void sim::sleep_for(uint64_t us)
+{
+  sleep_until(now_us + us);
+}
+
+void sim::yield()
+{
+  sleep_until(now_us);
+}
+
+void sim::poll()
+{
+  std::unique_lock<std::mutex> lock(sched_mutex);
+  task_t *me = this_task();
+  uint64_t t = now_us + config().poll_cost_us;
+
+  // Only switch tasks if somebody else is due to run, otherwise just move the clock
+  for (size_t i = 0; i < tasks.size(); i++)
+  {
+    if (tasks[i] != me && tasks[i]->alive && tasks[i]->wake_us <= t)
+    {
+      me->wake_us = t;
+      switch_task(lock, me);
+      return;
+    }
+  }
+
+  advance_clock(t);
+}
+
+int sim::spawn(std::function<int()> fn, const char *name)
+{
+  std::unique_lock<std::mutex> lock(sched_mutex);
+  this_task();
+
+  task_t *t = new task_t{(int)tasks.size(), name, now_us, true, host_clock::now(), 0, 0, 0};
+  tasks.push_back(t);
+
+  std::thread([t, fn] {
+    {
+      std::unique_lock<std::mutex> lock(sched_mutex);
+      self = t;
+      sched_cv.wait(lock, [t] { return running == t; });
+      t->cycle_start = host_clock::now();
+    }
+
+    fn();
+
+    std::unique_lock<std::mutex> lock(sched_mutex);
+    t->alive = false;
+    end_cycle(t);
+    switch_task(lock, t);
+  }).detach();
+
+  return t->id;
+}
+
+void sim::kill(int id)
+{
+  std::unique_lock<std::mutex> lock(sched_mutex);
+  task_t *me = this_task();
+
+  if (id < 0 || id >= (int)tasks.size())
+    return;
+
+  tasks[id]->alive = false;
+
+  // A task stopping itself never comes back
+  if (tasks[id] == me)
+  {
+    end_cycle(me);
+    switch_task(lock, me);
+  }
+}
+
+int sim::current_task()
+{
+  std::unique_lock<std::mutex> lock(sched_mutex);
+  return this_task()->id;
+}
+
+void sim::set_realtime_factor(double factor)
+{
+  std::unique_lock<std::mutex> lock(sched_mutex);
+  realtime_factor = factor;
+  wall_start = host_clock::now() - std::chrono::microseconds((uint64_t)(factor > 0 ? now_us / factor : 0));
+}
+
+void sim::print_task_stats()
+{
+  printf("%-16s %10s %14s %14s\n", "task", "cycles", "mean (us)", "max (us)");
+  for (size_t i = 0; i < tasks.size(); i++)
+  {
+    task_t *t = tasks[i];
+    printf("%-16s %10llu %14.2f %14.2f\n", t->name, (unsigned long long)t->cycles,
+           t->cycles > 0 ? t->cycle_total_us / t->cycles : 0.0, t->cycle_max_us);
+  }
+}
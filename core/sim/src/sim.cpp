@@ -0,0 +1,140 @@
+#include "sim/sim.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+struct input_row_t
+{
+  uint64_t time_us;
+  int32_t axis[4];
+  uint32_t buttons;
+};
+
+std::vector<input_row_t> input_rows;
+size_t next_input = 0;
+bool input_loaded = false;
+
+std::chrono::steady_clock::time_point host_start = std::chrono::steady_clock::now();
+
+const char *env_or(const char *name, const char *fallback)
+{
+  const char *val = getenv(name);
+  return (val != NULL && val[0] != '\0') ? val : fallback;
+}
+
+void load_input(const char *path)
+{
+  FILE *f = fopen(path, "r");
+  if (f == NULL)
+  {
+    fprintf(stderr, "sim: could not open input file %s\n", path);
+    return;
+  }
+
+  char line[256];
+  while (fgets(line, sizeof(line), f) != NULL)
+  {
+    double t;
+    input_row_t row;
+    if (sscanf(line, "%lf,%d,%d,%d,%d,%u", &t, &row.axis[0], &row.axis[1], &row.axis[2], &row.axis[3],
+               &row.buttons) == 6)
+    {
+      row.time_us = (uint64_t)(t * 1000);
+      input_rows.push_back(row);
+    }
+  }
+
+  fclose(f);
+}
+} // namespace
+
+sim::sim_config_t &sim::config()
+{
+  static sim_config_t conf;
+  static bool loaded = false;
+
+  if (!loaded)
+  {
+    loaded = true;
+
+    const char *mode = env_or("SIM_MODE", "auto");
+    if (strcmp(mode, "driver") == 0)
+      conf.mode = sim_config_t::DRIVER;
+    else if (strcmp(mode, "match") == 0)
+      conf.mode = sim_config_t::MATCH;
+    else if (strcmp(mode, "skills") == 0)
+      conf.mode = sim_config_t::SKILLS;
+    else
+      conf.mode = sim_config_t::AUTO;
+
+    conf.realtime_factor = atof(env_or("SIM_SPEED", "0"));
+    conf.trace_path = env_or("SIM_TRACE", NULL);
+    conf.input_path = env_or("SIM_INPUT", NULL);
+    conf.sdcard_dir = env_or("SIM_SDCARD", "sdcard");
+    conf.poll_cost_us = (uint64_t)atoi(env_or("SIM_POLL_US", "20"));
+    conf.battery_pct = atof(env_or("SIM_BATTERY", "100"));
+  }
+
+  return conf;
+}
+
+void sim::set_controller_axis(int controller, int axis, int32_t value)
+{
+  World::instance().axis[controller == 0 ? 0 : 1][axis & 3] = value;
+}
+
+void sim::set_controller_buttons(int controller, uint32_t pressed_mask)
+{
+  World::instance().buttons[controller == 0 ? 0 : 1] = pressed_mask;
+}
+
+void sim::update_input()
+{
+  if (config().input_path == NULL)
+    return;
+
+  if (!input_loaded)
+  {
+    input_loaded = true;
+    load_input(config().input_path);
+  }
+
+  World &world = World::instance();
+  while (next_input < input_rows.size() && input_rows[next_input].time_us <= world.time_us)
+  {
+    input_row_t &row = input_rows[next_input++];
+    for (int i = 0; i < 4; i++)
+      world.axis[0][i] = row.axis[i];
+    world.buttons[0] = row.buttons;
+  }
+}
+
+void sim::finish(int exit_code)
+{
+  World &world = World::instance();
+  double host_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - host_start).count();
+  double sim_s = world.time_us / 1e6;
+
+  printf("\n==== Simulation Report ====\n");
+  printf("simulated time:  %.3f s\n", sim_s);
+  printf("host time:       %.3f s (%.1fx real time)\n", host_s, host_s > 0 ? sim_s / host_s : 0.0);
+
+  if (world.chassis != NULL)
+  {
+    pose_t &p = world.chassis->pose;
+    printf("final pose:      x=%.2f in, y=%.2f in, heading=%.2f deg\n", p.x, p.y, p.heading);
+  }
+
+  printf("battery:         %.2f V min, %.1f%% left, %.2f A peak\n", world.min_battery_v, world.battery.capacity_pct,
+         world.peak_current_a);
+  printf("motor temp:      %.1f C peak\n\n", world.peak_temperature_c);
+
+  print_task_stats();
+
+  fflush(NULL); // _Exit skips flushing, and the trace file needs it too
+  _Exit(exit_code);
+}
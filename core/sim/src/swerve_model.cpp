@@ -0,0 +1,152 @@
+#include "sim/swerve_model.h"
+#include <math.h>
+
+#define METERS_PER_INCH 0.0254
+#define GRAVITY 9.81 // m/s^2
+
+// Scrub torque the direction motor has to overcome to turn a module, Nm at the motor
+#define MODULE_SCRUB_TORQUE 0.04
+#define MODULE_INERTIA 2.0e-4 // kg*m^2 at the direction motor
+
+sim::SwerveModel::SwerveModel(swerve_config_t &config)
+    : config(config)
+{
+  for (int i = 0; i < 4; i++)
+  {
+    wheel_speed[i] = 0;
+    slipping[i] = false;
+  }
+}
+
+void sim::SwerveModel::attach(World &world)
+{
+  for (int i = 0; i < 4; i++)
+  {
+    MotorModel &drive = world.motor(config.modules[i].drive_port);
+    MotorModel &dir = world.motor(config.modules[i].dir_port);
+
+    drive.claimed = true;
+    dir.claimed = true;
+    dir.load_inertia = MODULE_INERTIA;
+    dir.load_friction = MODULE_SCRUB_TORQUE;
+  }
+}
+
+double sim::SwerveModel::module_angle(int i)
+{
+  return fmod(World::instance().motor(config.modules[i].dir_port).position_rad * config.dir_ratio * 180.0 / M_PI, 360.0);
+}
+
+bool sim::SwerveModel::is_slipping(int i)
+{
+  return slipping[i];
+}
+
+void sim::SwerveModel::step(World &world, double dt)
+{
+  double r = config.wheel_diam / 2.0 * METERS_PER_INCH;
+  double quarter_mass = config.mass / 4.0;
+  double max_accel = config.friction_coeff * GRAVITY; // What the wheels can push before they slip
+  double traction = quarter_mass * max_accel;
+  double battery_v = world.battery.voltage_v;
+
+  // Chassis velocity before this step, robot frame, m/s and rad/s (clockwise)
+  double v_x = vx * METERS_PER_INCH, v_y = vy * METERS_PER_INCH, w = omega * M_PI / 180.0;
+
+  double ux[4], uy[4], contact[4];
+  double sum_x = 0, sum_y = 0, sum_w = 0, sum_r2 = 0;
+
+  for (int i = 0; i < 4; i++)
+  {
+    module_t &m = config.modules[i];
+    MotorModel &dir = world.motor(m.dir_port);
+    MotorModel &drive = world.motor(m.drive_port);
+
+    dir.step(dt, battery_v, 0);
+
+    double phi = dir.position_rad * config.dir_ratio;
+    double rx = m.x * METERS_PER_INCH, ry = m.y * METERS_PER_INCH;
+    ux[i] = sin(phi);
+    uy[i] = cos(phi);
+
+    // How fast the floor under this wheel is moving along the wheel's heading
+    double floor_speed = (v_x + w * ry) * ux[i] + (v_y - w * rx) * uy[i];
+
+    // Try moving with the chassis: the motor pushes a quarter of the robot
+    MotorModel grip = drive;
+    grip.load_inertia = quarter_mass * (r * config.drive_ratio) * (r * config.drive_ratio);
+    grip.step(dt, battery_v, 0);
+    double grip_speed = (grip.velocity_rad * config.drive_ratio + config.coupling * dir.velocity_rad) * r;
+
+    bool regrip = slipping[i] && fabs(wheel_speed[i] - floor_speed) < max_accel * dt;
+    if ((!slipping[i] || regrip) && fabs(grip_speed - floor_speed) <= max_accel * dt)
+    {
+      drive = grip;
+      slipping[i] = false;
+      contact[i] = grip_speed;
+    }
+    else
+    {
+      // Slipping: the wheel spins up on its own, and only kinetic friction reaches the chassis
+      double dir_sign = wheel_speed[i] > floor_speed ? 1.0 : -1.0;
+      if (!slipping[i])
+        dir_sign = grip_speed > floor_speed ? 1.0 : -1.0;
+
+      drive.step(dt, battery_v, -dir_sign * traction * r * config.drive_ratio);
+      slipping[i] = true;
+      contact[i] = floor_speed + dir_sign * max_accel * dt;
+    }
+
+    wheel_speed[i] = (drive.velocity_rad * config.drive_ratio + config.coupling * dir.velocity_rad) * r;
+
+    // Least squares fit of the chassis motion to every wheel's contact velocity
+    sum_x += contact[i] * ux[i];
+    sum_y += contact[i] * uy[i];
+    sum_w += contact[i] * (ux[i] * ry - uy[i] * rx);
+    sum_r2 += rx * rx + ry * ry;
+  }
+
+  double new_vx = sum_x / 4.0, new_vy = sum_y / 4.0, new_w = sum_r2 > 0 ? sum_w / sum_r2 : 0;
+
+  // Wheels that grip turn at whatever speed the chassis drags them
+  for (int i = 0; i < 4; i++)
+  {
+    if (slipping[i])
+      continue;
+
+    module_t &m = config.modules[i];
+    MotorModel &dir = world.motor(m.dir_port);
+    MotorModel &drive = world.motor(m.drive_port);
+    double rx = m.x * METERS_PER_INCH, ry = m.y * METERS_PER_INCH;
+    double along = (new_vx + new_w * ry) * ux[i] + (new_vy - new_w * rx) * uy[i];
+
+    drive.set_velocity((along / r - config.coupling * dir.velocity_rad) / config.drive_ratio);
+    wheel_speed[i] = along;
+  }
+
+  // Acceleration felt by the IMU, including the centripetal part
+  ax = ((new_vx - v_x) / dt + new_w * new_vy) / METERS_PER_INCH;
+  ay = ((new_vy - v_y) / dt - new_w * new_vx) / METERS_PER_INCH;
+
+  vx = new_vx / METERS_PER_INCH;
+  vy = new_vy / METERS_PER_INCH;
+  omega = new_w * 180.0 / M_PI;
+
+  // Move the robot on the field
+  double theta = pose.heading * M_PI / 180.0;
+  pose.x += (vx * cos(theta) + vy * sin(theta)) * dt;
+  pose.y += (-vx * sin(theta) + vy * cos(theta)) * dt;
+  pose.heading += omega * dt;
+}
+
+void sim::SwerveModel::trace_header(FILE *f)
+{
+  for (int i = 0; i < 4; i++)
+    fprintf(f, ",mod%d_angle,mod%d_speed,mod%d_slip", i, i, i);
+}
+
+void sim::SwerveModel::trace(FILE *f)
+{
+  for (int i = 0; i < 4; i++)
+    fprintf(f, ",%.2f,%.3f,%d", module_angle(i), wheel_speed[i] / METERS_PER_INCH, slipping[i] ? 1 : 0);
+}
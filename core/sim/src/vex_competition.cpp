@@ -0,0 +1,94 @@
+#include "v5_vcs.h"
+#include "sim/sim.h"
+
+#define AUTO_TIME_US 15000000
+#define DRIVER_TIME_US 105000000
+#define SKILLS_TIME_US 60000000
+
+namespace
+{
+enum period_t
+{
+  DISABLED, AUTONOMOUS, DRIVER
+};
+
+void (*auto_callback)(void) = NULL;
+void (*driver_callback)(void) = NULL;
+period_t period = DISABLED;
+bool field_started = false;
+
+/**
+ * Run one period of the match in its own task, then disable the robot like the field
+ * controller would.
+ */
+void run_period(period_t p, void (*callback)(void), uint64_t duration_us)
+{
+  if (callback == NULL)
+    return;
+
+  period = p;
+  int id = sim::spawn([callback] {
+    callback();
+    return 0;
+  }, p == AUTONOMOUS ? "autonomous" : "drivercontrol");
+
+  sim::sleep_for(duration_us);
+  sim::kill(id);
+  period = DISABLED;
+
+  for (int32_t i = 0; i < sim::World::num_ports; i++)
+    sim::World::instance().motor(i).command_stop(vex::brakeType::coast);
+}
+
+int field_control()
+{
+  switch (sim::config().mode)
+  {
+  case sim::sim_config_t::DRIVER:
+    run_period(DRIVER, driver_callback, DRIVER_TIME_US);
+    break;
+  case sim::sim_config_t::MATCH:
+    run_period(AUTONOMOUS, auto_callback, AUTO_TIME_US);
+    run_period(DRIVER, driver_callback, DRIVER_TIME_US);
+    break;
+  case sim::sim_config_t::SKILLS:
+    run_period(AUTONOMOUS, auto_callback, SKILLS_TIME_US);
+    break;
+  default:
+    run_period(AUTONOMOUS, auto_callback, AUTO_TIME_US);
+    break;
+  }
+
+  sim::finish(0);
+  return 0;
+}
+
+void start_field()
+{
+  if (field_started)
+    return;
+
+  field_started = true;
+  sim::spawn(field_control, "field");
+}
+} // namespace
+
+vex::competition::competition() {}
+
+void vex::competition::autonomous(void (*callback)(void))
+{
+  auto_callback = callback;
+  start_field();
+}
+
+void vex::competition::drivercontrol(void (*callback)(void))
+{
+  driver_callback = callback;
+  start_field();
+}
+
+bool vex::competition::isEnabled() { return period != DISABLED; }
+bool vex::competition::isDriverControl() { return period == DRIVER; }
+bool vex::competition::isAutonomous() { return period == AUTONOMOUS; }
+bool vex::competition::isCompetitionSwitch() { return false; }
+bool vex::competition::isFieldControl() { return true; }
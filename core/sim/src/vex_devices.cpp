@@ -0,0 +1,192 @@
+#include "v5_vcs.h"
+#include "sim/sim.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string>
+#include <sys/stat.h>
+
+// ============ triport ============
+
+vex::triport::port::port() : id_(0) {}
+vex::triport::port::port(int32_t id) : id_(id) {}
+
+void vex::triport::port::set(bool value) { sim::World::instance().triport_out[id_] = value; }
+int32_t vex::triport::port::value() { return sim::World::instance().triport_out[id_] ? 1 : 0; }
+int32_t vex::triport::port::id() const { return id_; }
+
+vex::triport::triport() : A(0), B(1), C(2), D(3), E(4), F(5), G(6), H(7) {}
+
+vex::digital_out::digital_out(triport::port port) : port(port) {}
+void vex::digital_out::set(bool value) { port.set(value); }
+int32_t vex::digital_out::value() { return port.value(); }
+
+vex::digital_in::digital_in(triport::port port) : port(port) {}
+int32_t vex::digital_in::value() { return port.value(); }
+
+// ============ brain ============
+
+namespace
+{
+void print_screen(const char *screen, const char *format, va_list args)
+{
+  printf("[%s %7.3f] ", screen, sim::time_us() / 1e6);
+  vprintf(format, args);
+  printf("\n");
+}
+
+std::string sd_path(const char *name)
+{
+  return std::string(sim::config().sdcard_dir) + "/" + name;
+}
+} // namespace
+
+vex::brain::brain() {}
+
+vex::brain::lcd::lcd() : cursor_row(1), cursor_col(1) {}
+
+void vex::brain::lcd::print(const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  print_screen("brain", format, args);
+  va_end(args);
+}
+
+void vex::brain::lcd::printAt(int32_t x, int32_t y, const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  print_screen("brain", format, args);
+  va_end(args);
+}
+
+void vex::brain::lcd::setCursor(int32_t row, int32_t col)
+{
+  cursor_row = row;
+  cursor_col = col;
+}
+
+void vex::brain::lcd::newLine()
+{
+  cursor_row++;
+  cursor_col = 1;
+}
+
+void vex::brain::lcd::clearScreen() {}
+void vex::brain::lcd::clearLine() {}
+void vex::brain::lcd::clearLine(int32_t row) {}
+int32_t vex::brain::lcd::row() { return cursor_row; }
+int32_t vex::brain::lcd::column() { return cursor_col; }
+
+double vex::brain::battery::capacity(percentUnits units) { return sim::World::instance().battery.capacity_pct; }
+
+double vex::brain::battery::voltage(voltageUnits units)
+{
+  sim::poll();
+  double v = sim::World::instance().battery.voltage_v;
+  return units == voltageUnits::mV ? v * 1000.0 : v;
+}
+
+double vex::brain::battery::current(currentUnits units)
+{
+  sim::poll();
+  return sim::World::instance().battery.current_a;
+}
+
+double vex::brain::battery::temperature(percentUnits units) { return sim::World::instance().battery.temperature_c; }
+
+bool vex::brain::sdcard::isInserted()
+{
+  struct stat st;
+  return stat(sim::config().sdcard_dir, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+int32_t vex::brain::sdcard::loadfile(const char *name, uint8_t *buffer, int32_t len)
+{
+  FILE *f = fopen(sd_path(name).c_str(), "rb");
+  if (f == NULL)
+    return 0;
+
+  int32_t read = (int32_t)fread(buffer, 1, len, f);
+  fclose(f);
+  return read;
+}
+
+int32_t vex::brain::sdcard::savefile(const char *name, uint8_t *buffer, int32_t len)
+{
+  FILE *f = fopen(sd_path(name).c_str(), "wb");
+  if (f == NULL)
+    return 0;
+
+  int32_t written = (int32_t)fwrite(buffer, 1, len, f);
+  fclose(f);
+  return written;
+}
+
+int32_t vex::brain::sdcard::appendfile(const char *name, uint8_t *buffer, int32_t len)
+{
+  FILE *f = fopen(sd_path(name).c_str(), "ab");
+  if (f == NULL)
+    return 0;
+
+  int32_t written = (int32_t)fwrite(buffer, 1, len, f);
+  fclose(f);
+  return written;
+}
+
+int32_t vex::brain::sdcard::size(const char *name)
+{
+  struct stat st;
+  if (stat(sd_path(name).c_str(), &st) != 0)
+    return 0;
+  return (int32_t)st.st_size;
+}
+
+bool vex::brain::sdcard::exists(const char *name)
+{
+  struct stat st;
+  return stat(sd_path(name).c_str(), &st) == 0;
+}
+
+// ============ controller ============
+
+vex::controller::axis::axis(controllerType id, int32_t index) : id(id), index(index) {}
+
+int32_t vex::controller::axis::value() { return position() * 127 / 100; }
+
+int32_t vex::controller::axis::position(percentUnits units)
+{
+  sim::poll();
+  return sim::World::instance().axis[id == controllerType::primary ? 0 : 1][index];
+}
+
+vex::controller::button::button(controllerType id, int32_t index) : id(id), index(index) {}
+
+bool vex::controller::button::pressing()
+{
+  sim::poll();
+  return (sim::World::instance().buttons[id == controllerType::primary ? 0 : 1] >> index) & 1;
+}
+
+void vex::controller::lcd::print(const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  print_screen("controller", format, args);
+  va_end(args);
+}
+
+void vex::controller::lcd::setCursor(int32_t row, int32_t col) {}
+void vex::controller::lcd::clearScreen() {}
+void vex::controller::lcd::clearLine(int32_t row) {}
+
+vex::controller::controller(controllerType id)
+    : Axis1(id, 0), Axis2(id, 1), Axis3(id, 2), Axis4(id, 3),
+      ButtonL1(id, BTN_L1), ButtonL2(id, BTN_L2), ButtonR1(id, BTN_R1), ButtonR2(id, BTN_R2),
+      ButtonUp(id, BTN_UP), ButtonDown(id, BTN_DOWN), ButtonLeft(id, BTN_LEFT), ButtonRight(id, BTN_RIGHT),
+      ButtonX(id, BTN_X), ButtonB(id, BTN_B), ButtonY(id, BTN_Y), ButtonA(id, BTN_A)
+{
+}
+
+void vex::controller::rumble(const char *pattern) {}
+bool vex::controller::installed() { return true; }
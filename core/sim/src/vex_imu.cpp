@@ -0,0 +1,108 @@
+#include "v5_vcs.h"
+#include "sim/sim.h"
+#include <math.h>
+
+#define CALIBRATION_TIME_US 2000000
+
+vex::inertial::inertial(int32_t index, turnType dir)
+    : port(index), model(&sim::World::instance().imu(index))
+{
+  model->installed = true;
+}
+
+void vex::inertial::calibrate(int32_t value) { startCalibration(value); }
+
+void vex::inertial::startCalibration(int32_t value)
+{
+  model->calibration_done_us = sim::time_us() + CALIBRATION_TIME_US;
+  model->heading_offset = model->heading_deg;
+  model->rotation_offset = model->heading_deg;
+}
+
+bool vex::inertial::isCalibrating()
+{
+  sim::poll();
+  return sim::time_us() < model->calibration_done_us;
+}
+
+void vex::inertial::resetHeading() { model->heading_offset = model->heading_deg; }
+void vex::inertial::resetRotation() { model->rotation_offset = model->heading_deg; }
+
+void vex::inertial::setHeading(double value, rotationUnits units)
+{
+  model->heading_offset = model->heading_deg - (units == rotationUnits::rev ? value * 360.0 : value);
+}
+
+void vex::inertial::setRotation(double value, rotationUnits units)
+{
+  model->rotation_offset = model->heading_deg - (units == rotationUnits::rev ? value * 360.0 : value);
+}
+
+double vex::inertial::rotation(rotationUnits units)
+{
+  if (isCalibrating())
+    return 0;
+
+  double deg = model->heading_deg - model->rotation_offset;
+  return units == rotationUnits::rev ? deg / 360.0 : deg;
+}
+
+double vex::inertial::heading(rotationUnits units)
+{
+  if (isCalibrating())
+    return 0;
+
+  double deg = fmod(model->heading_deg - model->heading_offset, 360.0);
+  if (deg < 0)
+    deg += 360.0;
+  return units == rotationUnits::rev ? deg / 360.0 : deg;
+}
+
+double vex::inertial::angle(rotationUnits units) { return heading(units); }
+double vex::inertial::roll(rotationUnits units) { return 0; }
+double vex::inertial::pitch(rotationUnits units) { return 0; }
+
+double vex::inertial::yaw(rotationUnits units)
+{
+  double deg = heading(rotationUnits::deg);
+  deg -= deg > 180 ? 360 : 0;
+  return units == rotationUnits::rev ? deg / 360.0 : deg;
+}
+
+double vex::inertial::orientation(orientationType type, rotationUnits units)
+{
+  switch (type)
+  {
+  case orientationType::roll:
+    return roll(units);
+  case orientationType::pitch:
+    return pitch(units);
+  default:
+    return yaw(units);
+  }
+}
+
+double vex::inertial::gyroRate(axisType axis, velocityUnits units)
+{
+  sim::poll();
+  if (axis != axisType::zaxis || isCalibrating())
+    return 0;
+
+  return units == velocityUnits::rpm ? model->rate_dps / 6.0 : model->rate_dps;
+}
+
+double vex::inertial::acceleration(axisType axis)
+{
+  sim::poll();
+  switch (axis)
+  {
+  case axisType::xaxis:
+    return model->ax_g;
+  case axisType::yaxis:
+    return model->ay_g;
+  default:
+    return 1.0;
+  }
+}
+
+bool vex::inertial::installed() { return model->installed; }
@@ -0,0 +1,292 @@
+#include "v5_vcs.h"
+#include "sim/sim.h"
+#include <math.h>
+
+#define TORQUE_INLB_PER_NM 8.8507
+
+vex::motor::motor(int32_t index)
+    : motor(index, gearSetting::ratio18_1, false)
+{
+}
+
+vex::motor::motor(int32_t index, bool reverse)
+    : motor(index, gearSetting::ratio18_1, reverse)
+{
+}
+
+vex::motor::motor(int32_t index, gearSetting gears)
+    : motor(index, gears, false)
+{
+}
+
+vex::motor::motor(int32_t index, gearSetting gears, bool reverse)
+    : port(index), gears(gears), set_velocity_rpm(0), model(&sim::World::instance().motor(index))
+{
+  model->installed = true;
+  model->reversed = reverse;
+  model->set_cartridge(gears);
+
+  // Same default as the SDK: 50%
+  set_velocity_rpm = to_rpm(50, velocityUnits::pct);
+}
+
+double vex::motor::to_rpm(double velocity, velocityUnits units)
+{
+  switch (units)
+  {
+  case velocityUnits::pct:
+    return velocity / 100.0 * (3600.0 / model->ratio);
+  case velocityUnits::dps:
+    return velocity / 6.0;
+  default:
+    return velocity;
+  }
+}
+
+double vex::motor::to_deg(double value, rotationUnits units)
+{
+  switch (units)
+  {
+  case rotationUnits::rev:
+    return value * 360.0;
+  case rotationUnits::raw:
+    return value * 360.0 / (50.0 * model->ratio); // 1800 ticks/rev on a red cartridge
+  default:
+    return value;
+  }
+}
+
+double vex::motor::from_deg(double deg, rotationUnits units)
+{
+  switch (units)
+  {
+  case rotationUnits::rev:
+    return deg / 360.0;
+  case rotationUnits::raw:
+    return deg * (50.0 * model->ratio) / 360.0;
+  default:
+    return deg;
+  }
+}
+
+void vex::motor::setReversed(bool value) { model->reversed = value; }
+void vex::motor::setVelocity(double velocity, velocityUnits units) { set_velocity_rpm = to_rpm(velocity, units); }
+void vex::motor::setVelocity(double velocity, percentUnits units) { setVelocity(velocity, velocityUnits::pct); }
+void vex::motor::setStopping(brakeType mode) { model->stopping = mode; }
+void vex::motor::setBrake(brakeType mode) { setStopping(mode); }
+void vex::motor::setMaxTorque(double value, percentUnits units) { model->max_torque_pct = value; }
+void vex::motor::setTimeout(int32_t time, timeUnits units) {}
+
+void vex::motor::resetPosition() { model->position_offset_rad = model->position_rad; }
+void vex::motor::resetRotation() { resetPosition(); }
+
+void vex::motor::setPosition(double value, rotationUnits units)
+{
+  double sign = model->reversed ? -1.0 : 1.0;
+  model->position_offset_rad = model->position_rad - sign * to_deg(value, units) * M_PI / 180.0;
+}
+
+void vex::motor::setRotation(double value, rotationUnits units) { setPosition(value, units); }
+
+void vex::motor::spin(directionType dir)
+{
+  double sign = (model->reversed ? -1.0 : 1.0) * (dir == directionType::rev ? -1.0 : 1.0);
+  model->command_velocity(sign * set_velocity_rpm);
+}
+
+void vex::motor::spin(directionType dir, double velocity, velocityUnits units)
+{
+  setVelocity(velocity, units);
+  spin(dir);
+}
+
+void vex::motor::spin(directionType dir, double velocity, percentUnits units)
+{
+  spin(dir, velocity, velocityUnits::pct);
+}
+
+void vex::motor::spin(directionType dir, double voltage, voltageUnits units)
+{
+  double sign = (model->reversed ? -1.0 : 1.0) * (dir == directionType::rev ? -1.0 : 1.0);
+  model->command_voltage(sign * (units == voltageUnits::mV ? voltage / 1000.0 : voltage));
+}
+
+bool vex::motor::spinTo(double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion)
+{
+  double sign = model->reversed ? -1.0 : 1.0;
+  setVelocity(velocity, units_v);
+  model->command_position(sign * to_deg(rotation, units), set_velocity_rpm);
+
+  if (!waitForCompletion)
+    return false;
+
+  while (!isDone())
+    sim::sleep_for(10000);
+
+  return true;
+}
+
+bool vex::motor::spinTo(double rotation, rotationUnits units, bool waitForCompletion)
+{
+  return spinTo(rotation, units, set_velocity_rpm, velocityUnits::rpm, waitForCompletion);
+}
+
+bool vex::motor::spinToPosition(double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion)
+{
+  return spinTo(rotation, units, velocity, units_v, waitForCompletion);
+}
+
+bool vex::motor::spinFor(double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion)
+{
+  return spinTo(position(units) + rotation, units, velocity, units_v, waitForCompletion);
+}
+
+bool vex::motor::isSpinning()
+{
+  sim::poll();
+  return fabs(model->velocity_rad) > 0.01;
+}
+
+bool vex::motor::isDone()
+{
+  sim::poll();
+  if (model->mode != sim::MotorModel::POSITION)
+    return true;
+
+  double err_deg = model->target_deg - (model->position_rad - model->position_offset_rad) * 180.0 / M_PI;
+  return fabs(err_deg) < 1.0 && fabs(model->velocity_rad) < 0.5;
+}
+
+void vex::motor::stop() { stop(model->stopping); }
+void vex::motor::stop(brakeType mode) { model->command_stop(mode); }
+
+double vex::motor::rotation(rotationUnits units) { return position(units); }
+
+double vex::motor::position(rotationUnits units)
+{
+  sim::poll();
+  double sign = model->reversed ? -1.0 : 1.0;
+  return from_deg(sign * (model->position_rad - model->position_offset_rad) * 180.0 / M_PI, units);
+}
+
+double vex::motor::velocity(velocityUnits units)
+{
+  sim::poll();
+  double rpm = (model->reversed ? -1.0 : 1.0) * model->velocity_rad * 60.0 / (2.0 * M_PI);
+  switch (units)
+  {
+  case velocityUnits::pct:
+    return rpm / (3600.0 / model->ratio) * 100.0;
+  case velocityUnits::dps:
+    return rpm * 6.0;
+  default:
+    return rpm;
+  }
+}
+
+double vex::motor::velocity(percentUnits units) { return velocity(velocityUnits::pct); }
+
+double vex::motor::current(currentUnits units)
+{
+  sim::poll();
+  return fabs(model->current_a);
+}
+
+double vex::motor::current(percentUnits units) { return current(currentUnits::amp) / 2.5 * 100.0; }
+
+double vex::motor::voltage(voltageUnits units)
+{
+  sim::poll();
+  double volts = (model->reversed ? -1.0 : 1.0) * model->voltage_v;
+  return units == voltageUnits::mV ? volts * 1000.0 : volts;
+}
+
+double vex::motor::power(powerUnits units)
+{
+  sim::poll();
+  return fabs(model->torque_nm * model->velocity_rad);
+}
+
+double vex::motor::torque(torqueUnits units)
+{
+  sim::poll();
+  double nm = fabs(model->torque_nm);
+  return units == torqueUnits::InLb ? nm * TORQUE_INLB_PER_NM : nm;
+}
+
+double vex::motor::efficiency(percentUnits units)
+{
+  double in = fabs(model->voltage_v * model->current_a);
+  return in > 0 ? power() / in * 100.0 : 0;
+}
+
+double vex::motor::temperature(percentUnits units)
+{
+  sim::poll();
+  // The SDK reports 0% at 20C up to 100% at 70C
+  double pct = (model->temperature_c - 20.0) * 2.0;
+  return pct < 0 ? 0 : (pct > 100 ? 100 : pct);
+}
+
+double vex::motor::temperature(temperatureUnits units)
+{
+  sim::poll();
+  double c = model->temperature_c;
+  return units == temperatureUnits::fahrenheit ? c * 9.0 / 5.0 + 32.0 : c;
+}
+
+bool vex::motor::installed() { return model->installed; }
+int32_t vex::motor::index() { return port; }
+
+// ============ motor_group ============
+
+vex::motor_group::motor_group() : count_(0) {}
+
+int32_t vex::motor_group::count() { return count_; }
+
+#define EACH_MOTOR(call)                                                                                               \
+  for (int32_t i = 0; i < count_; i++)                                                                                 \
+    motors[i]->call;
+
+void vex::motor_group::setVelocity(double velocity, velocityUnits units) { EACH_MOTOR(setVelocity(velocity, units)) }
+void vex::motor_group::setVelocity(double velocity, percentUnits units) { EACH_MOTOR(setVelocity(velocity, units)) }
+void vex::motor_group::setStopping(brakeType mode) { EACH_MOTOR(setStopping(mode)) }
+void vex::motor_group::setReversed(bool value) { EACH_MOTOR(setReversed(value)) }
+void vex::motor_group::resetPosition() { EACH_MOTOR(resetPosition()) }
+void vex::motor_group::resetRotation() { EACH_MOTOR(resetRotation()) }
+void vex::motor_group::setPosition(double value, rotationUnits units) { EACH_MOTOR(setPosition(value, units)) }
+void vex::motor_group::spin(directionType dir) { EACH_MOTOR(spin(dir)) }
+void vex::motor_group::spin(directionType dir, double velocity, velocityUnits units) { EACH_MOTOR(spin(dir, velocity, units)) }
+void vex::motor_group::spin(directionType dir, double velocity, percentUnits units) { EACH_MOTOR(spin(dir, velocity, units)) }
+void vex::motor_group::spin(directionType dir, double voltage, voltageUnits units) { EACH_MOTOR(spin(dir, voltage, units)) }
+void vex::motor_group::stop() { EACH_MOTOR(stop()) }
+void vex::motor_group::stop(brakeType mode) { EACH_MOTOR(stop(mode)) }
+
+bool vex::motor_group::spinTo(double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion)
+{
+  EACH_MOTOR(spinTo(rotation, units, velocity, units_v, false))
+
+  if (!waitForCompletion)
+    return false;
+
+  for (int32_t i = 0; i < count_; i++)
+    while (!motors[i]->isDone())
+      sim::sleep_for(10000);
+
+  return true;
+}
+
+double vex::motor_group::rotation(rotationUnits units) { return position(units); }
+double vex::motor_group::position(rotationUnits units) { return count_ > 0 ? motors[0]->position(units) : 0; }
+double vex::motor_group::velocity(velocityUnits units) { return count_ > 0 ? motors[0]->velocity(units) : 0; }
+double vex::motor_group::velocity(percentUnits units) { return count_ > 0 ? motors[0]->velocity(units) : 0; }
+double vex::motor_group::voltage(voltageUnits units) { return count_ > 0 ? motors[0]->voltage(units) : 0; }
+double vex::motor_group::temperature(percentUnits units) { return count_ > 0 ? motors[0]->temperature(units) : 0; }
+
+double vex::motor_group::current(currentUnits units)
+{
+  double total = 0;
+  for (int32_t i = 0; i < count_; i++)
+    total += motors[i]->current(units);
+  return total;
+}
@@ -0,0 +1,93 @@
+#include "v5_vcs.h"
+#include "sim/sim.h"
+
+// ============ v5.h ============
+
+void vexDelay(uint32_t timems) { sim::sleep_for((uint64_t)timems * 1000); }
+uint32_t vexSystemTimeGet(void) { return (uint32_t)(sim::time_us() / 1000); }
+uint64_t vexSystemHighResTimeGet(void) { return sim::time_us(); }
+
+// ============ timer ============
+
+vex::timer::timer() : start_us(sim::time_us()) {}
+
+uint32_t vex::timer::time() const
+{
+  sim::poll();
+  return (uint32_t)((sim::time_us() - start_us) / 1000);
+}
+
+double vex::timer::time(timeUnits units) const
+{
+  return units == timeUnits::sec ? value() : value() * 1000.0;
+}
+
+double vex::timer::value() const
+{
+  sim::poll();
+  return (sim::time_us() - start_us) / 1e6;
+}
+
+void vex::timer::clear() { start_us = sim::time_us(); }
+void vex::timer::reset() { start_us = sim::time_us(); }
+uint32_t vex::timer::system() { return vexSystemTimeGet(); }
+uint64_t vex::timer::systemHighResolution() { return vexSystemHighResTimeGet(); }
+
+void vex::wait(double time, timeUnits units)
+{
+  sim::sleep_for((uint64_t)(units == timeUnits::sec ? time * 1e6 : time * 1e3));
+}
+
+// ============ task ============
+
+vex::task::task() : id(-1), prio(taskPriorityNormal) {}
+
+vex::task::task(int (*callback)(void)) : prio(taskPriorityNormal)
+{
+  id = sim::spawn([callback] { return callback(); }, "task");
+}
+
+vex::task::task(int (*callback)(void *), void *arg) : prio(taskPriorityNormal)
+{
+  id = sim::spawn([callback, arg] { return callback(arg); }, "task");
+}
+
+void vex::task::stop()
+{
+  if (id >= 0)
+    sim::kill(id);
+}
+
+// Priorities are recorded but every task gets an equal turn, as in VEXos when all tasks yield regularly
+void vex::task::setPriority(int32_t priority) { prio = priority; }
+int32_t vex::task::priority() { return prio; }
+
+void vex::task::sleep(uint32_t time) { vexDelay(time); }
+void vex::task::yield() { sim::yield(); }
+
+// ============ mutex ============
+
+vex::mutex::mutex() : locked(false) {}
+
+void vex::mutex::lock()
+{
+  while (locked)
+    sim::sleep_for(1000);
+  locked = true;
+}
+
+bool vex::mutex::try_lock()
+{
+  if (locked)
+    return false;
+  locked = true;
+  return true;
+}
+
+void vex::mutex::unlock() { locked = false; }
+
+// ============ this_thread ============
+
+int32_t vex::this_thread::get_id() { return sim::current_task(); }
+void vex::this_thread::sleep_for(uint32_t time_ms) { vexDelay(time_ms); }
+void vex::this_thread::yield() { sim::yield(); }
@@ -0,0 +1,149 @@
+#include "sim/world.h"
+#include "sim/sim.h"
+#include <math.h>
+
+#define G_INCHES (9.81 / 0.0254) // gravity, in/s^2
+#define BRAIN_CURRENT 0.3 // A drawn by the brain itself
+
+sim::World &sim::World::instance()
+{
+  static World world;
+  static bool configured = false;
+
+  if (!configured)
+  {
+    configured = true;
+    configure_robot(world);
+    world.battery.set_charge(config().battery_pct);
+    world.min_battery_v = world.battery.voltage_v;
+    if (config().trace_path != NULL)
+      world.open_trace(config().trace_path, 10000);
+  }
+
+  return world;
+}
+
+sim::World::World()
+    : chassis(NULL), time_us(0), step_us(1000), physics_enabled(true), peak_current_a(0), min_battery_v(battery.voltage_v),
+      peak_temperature_c(0), trace_file(NULL), trace_period_us(0), next_trace_us(0)
+{
+  for (int i = 0; i < 2; i++)
+  {
+    for (int j = 0; j < 4; j++)
+      axis[i][j] = 0;
+    buttons[i] = 0;
+  }
+
+  for (int i = 0; i < 8; i++)
+    triport_out[i] = false;
+}
+
+sim::MotorModel &sim::World::motor(int32_t port)
+{
+  if (port < 0 || port >= num_ports)
+    port = 0;
+  return motors[port];
+}
+
+sim::ImuModel &sim::World::imu(int32_t port)
+{
+  if (port < 0 || port >= num_ports)
+    port = 0;
+  return imus[port];
+}
+
+void sim::World::set_chassis(ChassisModel *chassis)
+{
+  if (this->chassis != NULL)
+    delete this->chassis;
+
+  this->chassis = chassis;
+  chassis->attach(*this);
+}
+
+void sim::World::open_trace(const char *path, uint64_t period_us)
+{
+  trace_file = fopen(path, "w");
+  if (trace_file == NULL)
+  {
+    fprintf(stderr, "sim: could not open trace file %s\n", path);
+    return;
+  }
+
+  trace_period_us = period_us;
+  fprintf(trace_file, "time,x,y,heading,vx,vy,omega,battery_v");
+  if (chassis != NULL)
+    chassis->trace_header(trace_file);
+  fprintf(trace_file, "\n");
+}
+
+void sim::World::advance_to(uint64_t t_us)
+{
+  if (!physics_enabled)
+  {
+    time_us = t_us;
+    return;
+  }
+
+  while (time_us + step_us <= t_us)
+  {
+    step(step_us / 1e6);
+    time_us += step_us;
+
+    if (trace_file != NULL && time_us >= next_trace_us)
+    {
+      next_trace_us += trace_period_us;
+
+      pose_t p = chassis != NULL ? chassis->pose : pose_t{0, 0, 0};
+      fprintf(trace_file, "%.3f,%.3f,%.3f,%.3f", time_us / 1e6, p.x, p.y, p.heading);
+      if (chassis != NULL)
+      {
+        fprintf(trace_file, ",%.3f,%.3f,%.3f", chassis->vx, chassis->vy, chassis->omega);
+        fprintf(trace_file, ",%.3f", battery.voltage_v);
+        chassis->trace(trace_file);
+      }
+      else
+        fprintf(trace_file, ",0,0,0,%.3f", battery.voltage_v);
+      fprintf(trace_file, "\n");
+    }
+  }
+}
+
+void sim::World::step(double dt)
+{
+  update_input();
+
+  if (chassis != NULL)
+    chassis->step(*this, dt);
+
+  // Anything not part of the drivetrain spins freely with whatever is attached to it
+  double battery_current = BRAIN_CURRENT;
+  for (int i = 0; i < num_ports; i++)
+  {
+    MotorModel &m = motors[i];
+    if (!m.installed)
+      continue;
+
+    if (!m.claimed)
+      m.step(dt, battery.voltage_v, 0);
+
+    battery_current += fabs(m.voltage_v * m.current_a) / battery.voltage_v;
+
+    if (m.temperature_c > peak_temperature_c)
+      peak_temperature_c = m.temperature_c;
+  }
+
+  battery.step(dt, battery_current);
+
+  if (battery_current > peak_current_a)
+    peak_current_a = battery_current;
+  if (battery.voltage_v < min_battery_v)
+    min_battery_v = battery.voltage_v;
+
+  if (chassis == NULL)
+    return;
+
+  for (int i = 0; i < num_ports; i++)
+    if (imus[i].installed)
+      imus[i].update(chassis->pose.heading, chassis->omega, chassis->ax / G_INCHES, chassis->ay / G_INCHES);
+}
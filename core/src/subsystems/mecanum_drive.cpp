@@ -1,4 +1,5 @@
 #include "../core/include/subsystems/mecanum_drive.h"
+#include "../core/include/utils/fast_math.h"
 
 MecanumDrive::MecanumDrive(vex::motor &left_front, vex::motor &right_front, vex::motor &left_rear, vex::motor &right_rear)
 : left_front(left_front), right_front(right_front), left_rear(left_rear), right_rear(right_rear)
@@ -16,36 +17,78 @@ MecanumDrive::MecanumDrive(vex::motor &left_front, vex::motor &right_front, vex:
  * @param power=2 how much of a "curve" there should be on drive controls; better for low speed maneuvers.
  *                Leave blank for a default curve of 2 (higher means more fidelity)
  */
-void MecanumDrive::drive(double left_y, double left_x, double right_x, int power)
+void MecanumDrive::drive(scalar_t left_y, scalar_t left_x, scalar_t right_x, int power)
 {
   // LATERAL CONTROLS - convert cartesion to a vector
-  double magnitude = sqrt(pow(left_y / 100.0, 2) + pow(left_x / 100.0, 2));
-  magnitude = pow(magnitude, power);
+  scalar_t magnitude = std::sqrt((left_y / 100) * (left_y / 100) + (left_x / 100) * (left_x / 100));
+  magnitude = ipow(magnitude, power);
 
-  double direction = atan2(left_x / 100.0, left_y / 100.0);
+  scalar_t direction = fast_atan2(left_x / 100, left_y / 100);
 
   // ROTATIONAL CONTROLS - just the right x joystick
-  // Ternary makes sure that if the "power" is even, the rotation keeps it's sign
-  double rotation = right_x / 100.0;
-  rotation = (power%2 == 0 ? rotation < 0 ? -1.0 : 1.0 : 1.0) * pow(rotation, power);
+  // signed_ipow makes sure that if the "power" is even, the rotation keeps it's sign
+  scalar_t rotation = signed_ipow(right_x / 100, power);
 
 
   // ALGORITHM - "rotate" the vector by 45 degrees and apply each corner to a wheel
   // .. Oh, and mix rotation too
-  double lf = (magnitude * cos(direction - (PI / 4.0))) + rotation;
-  double rf = (magnitude * cos(direction + (PI / 4.0))) - rotation;
-  double lr = (magnitude * cos(direction + (PI / 4.0))) + rotation;
-  double rr = (magnitude * cos(direction - (PI / 4.0))) - rotation;
+  // The two diagonals share a cosine, so only two are computed
+  scalar_t diag_a = magnitude * fast_cos(direction - FAST_MATH_QUARTER_PI);
+  scalar_t diag_b = magnitude * fast_cos(direction + FAST_MATH_QUARTER_PI);
+  scalar_t lf = diag_a + rotation;
+  scalar_t rf = diag_b - rotation;
+  scalar_t lr = diag_b + rotation;
+  scalar_t rr = diag_a - rotation;
 
   // Limit the output between -1.0 and +1.0
-  lf = lf > 1.0 ? 1.0 : (lf < -1.0 ? -1.0 : lf);
-  rf = rf > 1.0 ? 1.0 : (rf < -1.0 ? -1.0 : rf);
-  lr = lr > 1.0 ? 1.0 : (lr < -1.0 ? -1.0 : lr);
-  rr = rr > 1.0 ? 1.0 : (rr < -1.0 ? -1.0 : rr);
+  lf = lf > 1 ? 1 : (lf < -1 ? -1 : lf);
+  rf = rf > 1 ? 1 : (rf < -1 ? -1 : rf);
+  lr = lr > 1 ? 1 : (lr < -1 ? -1 : lr);
+  rr = rr > 1 ? 1 : (rr < -1 ? -1 : rr);
 
   // Finally, spin the motors
-  left_front.spin(vex::directionType::fwd, lf * 100.0, vex::velocityUnits::pct);
-  right_front.spin(vex::directionType::fwd, rf * 100.0, vex::velocityUnits::pct);
-  left_rear.spin(vex::directionType::fwd, lr * 100.0, vex::velocityUnits::pct);
-  right_rear.spin(vex::directionType::fwd, rr * 100.0, vex::velocityUnits::pct);
+  if(controllers[0] != NULL && controllers[1] != NULL && controllers[2] != NULL && controllers[3] != NULL)
+  {
+    controllers[0]->set_speed(lf);
+    controllers[1]->set_speed(rf);
+    controllers[2]->set_speed(lr);
+    controllers[3]->set_speed(rr);
+    return;
+  }
+
+  if(compensation != NULL)
+  {
+    compensation->spin(left_front, lf);
+    compensation->spin(right_front, rf);
+    compensation->spin(left_rear, lr);
+    compensation->spin(right_rear, rr);
+    return;
+  }
+
+  left_front.spin(vex::directionType::fwd, lf * 100, vex::velocityUnits::pct);
+  right_front.spin(vex::directionType::fwd, rf * 100, vex::velocityUnits::pct);
+  left_rear.spin(vex::directionType::fwd, lr * 100, vex::velocityUnits::pct);
+  right_rear.spin(vex::directionType::fwd, rr * 100, vex::velocityUnits::pct);
+}
+
+/**
+ * Drive the wheels by battery-compensated voltage (see battery_compensation.h) instead of
+ * the motors' velocity loops. Pass NULL to go back to velocity control.
+ */
+void MecanumDrive::set_battery_compensation(BatteryCompensation *compensation)
+{
+  this->compensation = compensation;
+}
+
+/**
+ * Run each wheel with our own velocity loop (see motor_controller.h) instead of the
+ * motors' internal ones. Pass NULL for all four to go back to those.
+ */
+void MecanumDrive::set_controllers(MotorController *left_front, MotorController *right_front, MotorController *left_rear,
+                                   MotorController *right_rear)
+{
+  controllers[0] = left_front;
+  controllers[1] = right_front;
+  controllers[2] = left_rear;
+  controllers[3] = right_rear;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "../core/include/subsystems/swerve_drive.h"
+#include "../core/include/utils/command_profiler.h"
 #include <iostream>
 
 using namespace std;
@@ -22,29 +23,29 @@ SwerveDrive::SwerveDrive(SwerveModule &left_front, SwerveModule &left_rear, Swer
  */
 void SwerveDrive::drive(int32_t leftY, int32_t leftX, int32_t rightX)
 {
-    Vector::point_t p = {.x=(leftX / 100.0), .y=(leftY / 100.0)};
+    Vector::point_t p = {.x=(leftX / (scalar_t)100), .y=(leftY / (scalar_t)100)};
 
     Vector input_lat(p);
 
     // Lateral Deadband
-    if(fabs(input_lat.get_mag()) < LAT_DEADBAND)
+    if(std::fabs(input_lat.get_mag()) < LAT_DEADBAND)
         Vector input_lat(0,0);
 
     // Rotational Deadband
-    if(fabs(rightX / 100.0) < LAT_DEADBAND)
+    if(std::fabs(rightX / (scalar_t)100) < LAT_DEADBAND)
         rightX = 0;
 
     // printf("distance: %f\n", left_front.get_distance_driven());
 
     // Convert input to a vector, and pass into main control method
-    this->drive(input_lat, rightX / 100.0);    
+    this->drive(input_lat, rightX / (scalar_t)100);    
 }
 
 /**
  * The main control method. Takes a vector and a rotation, and performs vector math to
  * calculate the position/speed for each wheel.
  */
-void SwerveDrive::drive(Vector lateral, double rotation)
+void SwerveDrive::drive(Vector lateral, scalar_t rotation)
 {
     // Each wheel has a different rotation vector
     Vector rot_lf(deg2rad(45), rotation);
@@ -65,6 +66,26 @@ void SwerveDrive::drive(Vector lateral, double rotation)
     left_rear.set(rad2deg(lr_out.get_dir()), lr_out.get_mag());
 }
 
+/**
+ * How fast the robot is moving, from the wheels: x to the right and y forward, in inches / second.
+ * Turning in place averages out to zero.
+ */
+Vector::point_t SwerveDrive::get_velocity()
+{
+  SwerveModule *modules[4] = {&left_front, &left_rear, &right_front, &right_rear};
+  Vector::point_t out = {.x = 0, .y = 0};
+
+  for(int i = 0; i < 4; i++)
+  {
+    scalar_t direction_deg, speed_ips;
+    modules[i]->get_velocity(&direction_deg, &speed_ips);
+    out.x += speed_ips * std::sin(deg2rad(direction_deg)) / 4;
+    out.y += speed_ips * std::cos(deg2rad(direction_deg)) / 4;
+  }
+
+  return out;
+}
+
 /**
  * Set the PID configuration for the "auto_drive" function
  */
@@ -87,11 +108,29 @@ void SwerveDrive::set_turn_pid(PID::pid_config_t &config)
   this->turn_pid = new PID(config);
 }
 
+/**
+ * Stop auto_drive early (returning true) when (detector) says the robot has run into
+ * something. Pass NULL to always drive the full distance.
+ */
+void SwerveDrive::set_collision_detector(CollisionDetector *detector)
+{
+  this->collision_detector = detector;
+}
+
+/**
+ * Why the last auto_drive stopped early, or CollisionDetector::NONE if it reached its
+ * target. Check it after an auto_drive to recover, e.g. by backing off.
+ */
+CollisionDetector::cause_t SwerveDrive::get_collision()
+{
+  return collision;
+}
+
 /**
  * Autonomously drive the robot in (degrees) direction, at (-1.0 -> 1.0) speed, for (inches) distance.
  * Indicate a negative speed or distance, or (preferably) a direction of +-180 degrees for backwards.
  */
-bool SwerveDrive::auto_drive(double direction, double speed, double distance)
+bool SwerveDrive::auto_drive(scalar_t direction, scalar_t speed, scalar_t distance)
 {
   // Null check the PID config
   if(drive_pid == NULL)
@@ -103,6 +142,9 @@ bool SwerveDrive::auto_drive(double direction, double speed, double distance)
   // INITIALIZATION
   if(auto_drive_init)
   {
+    CommandProfiler::phase("align");
+    collision = CollisionDetector::NONE;
+
     // std::cout << "Init-ing" << std::endl;
     // Turn all the wheels in the correct direction before running
     bool all_wheels_done = true;
@@ -130,13 +172,17 @@ bool SwerveDrive::auto_drive(double direction, double speed, double distance)
     // set up the PID
     drive_pid->reset();
     drive_pid->set_target(distance);
-    drive_pid->set_limits(-fabs(speed), fabs(speed));
+    drive_pid->set_limits(-std::fabs(speed), std::fabs(speed));
+
+    if(collision_detector != NULL)
+      collision_detector->reset();
 
     auto_drive_init = false;
+    CommandProfiler::phase("drive");
   }
 
-  double average = (left_front.get_distance_driven() + right_front.get_distance_driven() 
-                  + left_rear.get_distance_driven() + right_rear.get_distance_driven()) / 4.0;
+  scalar_t average = (left_front.get_distance_driven() + right_front.get_distance_driven() 
+                  + left_rear.get_distance_driven() + right_rear.get_distance_driven()) / 4;
 
   // LOOP
   drive_pid->update(average);
@@ -148,11 +194,27 @@ bool SwerveDrive::auto_drive(double direction, double speed, double distance)
   left_rear.set_speed(drive_pid->get());
   right_rear.set_speed(drive_pid->get());
 
+  // Ran into something: give up now instead of pushing against it until a timeout
+  if(collision_detector != NULL)
+  {
+    Vector::point_t velocity = get_velocity();
+    scalar_t along = velocity.x * std::sin(deg2rad(direction)) + velocity.y * std::cos(deg2rad(direction));
+
+    if(collision_detector->update(direction, drive_pid->get(), along))
+    {
+      collision = collision_detector->get_cause();
+      fprintf(stderr, "auto_drive stopped early: %s\n", CollisionDetector::cause_name(collision));
+      stop_auto();
+      return true;
+    }
+  }
+
   // Check if the driving is complete
   if(drive_pid->is_on_target())
   {
     this->drive(Vector(0,0), 0); // stop the robot
     auto_drive_init = true;
+    CommandProfiler::phase(NULL);
     return true;
   }
 
@@ -163,7 +225,7 @@ bool SwerveDrive::auto_drive(double direction, double speed, double distance)
  * Autonomously turn the robot over it's center axis in degrees. Positive degrees is clockwise, Negative is counter-clockwise
  * Function is non-blocking, and returns true when it has finished turning.
  */
-bool SwerveDrive::auto_turn(double degrees, double speed)
+bool SwerveDrive::auto_turn(scalar_t degrees, scalar_t speed)
 {
   if(turn_pid == NULL)
   {
@@ -174,6 +236,8 @@ bool SwerveDrive::auto_turn(double degrees, double speed)
   // INIT
   if(auto_turn_init)
   {
+    CommandProfiler::phase("align");
+
     // Wait until all the modules are at their 45's before continuing
     bool all_wheels_done = true;
     all_wheels_done = all_wheels_done & left_front.set_direction(45);
@@ -187,10 +251,11 @@ bool SwerveDrive::auto_turn(double degrees, double speed)
     imu.resetRotation();
     
     turn_pid->reset();
-    turn_pid->set_limits(-fabs(speed), fabs(speed));
+    turn_pid->set_limits(-std::fabs(speed), std::fabs(speed));
     turn_pid->set_target(degrees);
 
     auto_turn_init = false;
+    CommandProfiler::phase("turn");
   }
 
   // LOOP
@@ -209,8 +274,21 @@ bool SwerveDrive::auto_turn(double degrees, double speed)
   {
     drive(Vector(0,0), 0);
     auto_turn_init = true;
+    CommandProfiler::phase(NULL);
     return true;
   }
 
   return false;
+}
+
+/**
+ * Stop the robot, and abandon any auto_drive / auto_turn in progress so the next call
+ * starts fresh.
+ */
+void SwerveDrive::stop_auto()
+{
+  drive(Vector(0,0), 0);
+  auto_drive_init = true;
+  auto_turn_init = true;
+  CommandProfiler::phase(NULL);
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "../core/include/subsystems/swerve_module.h"
 #include "hardware.h"
+#include "../core/include/utils/fast_math.h"
 
 /**
  * Create a single swerve module, made up of a Drive motor and a Direction motor.
@@ -22,19 +23,16 @@ SwerveModule::SwerveModule(vex::motor &drive, vex::gearSetting drive_gearing, ve
  * @param speed_pct Speed of the wheel for the module, in percent (-1.0 -> 1.0, positive fwd)
  * @param power=2 Square / Cube the input for a exponential curve for more lower speed control
  */
-void SwerveModule::set(double direction_deg, double speed_pct, int power)
+void SwerveModule::set(scalar_t direction_deg, scalar_t speed_pct, int power)
 {
   // Don't move the direction wheel unless we need to
-  if(speed_pct == 0.0)
+  if(speed_pct == 0)
     direction_deg = lastStoredHeading;
   else
     lastStoredHeading = direction_deg;
 
   set_direction(direction_deg);
-  if(power % 2 == 0)
-    set_speed((speed_pct > 0 ? 1.0 : -1.0) * pow(speed_pct, power));
-  else
-    set_speed(pow(speed_pct, power));
+  set_speed(signed_ipow(speed_pct, power));
 }
 
 /**
@@ -47,9 +45,9 @@ void SwerveModule::set(double direction_deg, double speed_pct, int power)
  * 
  * @param deg position to set the motor, counter clockwise from the top.
  */
-bool SwerveModule::set_direction(double deg)
+bool SwerveModule::set_direction(scalar_t deg)
 {
-  double pos = direction.position(vex::rotationUnits::deg) * DIR_GEAR_RATIO;
+  scalar_t pos = (scalar_t)direction.position(vex::rotationUnits::deg) * (scalar_t)DIR_GEAR_RATIO;
   
   // Find the degrees of the direction module between -180 and +180, with 0 being forward.
   int modpos = mod(pos, 360);
@@ -64,26 +62,104 @@ bool SwerveModule::set_direction(double deg)
   inverseDrive = abs(delta) > 90 ? true : false;
 
   // Slow down the drive if we aren't close to the set direction yet (use the cube of the error)
-  driveMulitplier = pow(1 - (abs(normalizedDelta) / 90.0), 3);
-  double setpnt = (normalizedDelta + pos) / DIR_GEAR_RATIO;
+  driveMulitplier = ipow(1 - (abs(normalizedDelta) / (scalar_t)90), 3);
+  scalar_t setpnt = (normalizedDelta + pos) / (scalar_t)DIR_GEAR_RATIO;
   
-  direction.spinTo(setpnt, vex::rotationUnits::deg, 100, vex::velocityUnits::pct, false);
+  // Steer slower when the power manager says the motors are drawing too much
+  scalar_t steer_scale = 1;
+  if(power_manager != NULL)
+    steer_scale = power_manager->steering_scale(power_index, normalizedDelta);
+
+  if(direction_controller != NULL)
+    direction_controller->set_position(setpnt, steer_scale * direction_controller->get_max_rpm());
+  else
+    direction.spinTo(setpnt, vex::rotationUnits::deg, 100 * steer_scale, vex::velocityUnits::pct, false);
 
-  return fabs(setpnt - direction.rotation(rotationUnits::deg)) < 2;
+  return std::fabs(setpnt - (scalar_t)direction.rotation(rotationUnits::deg)) < 2;
 }
 
 /**
  * Sets the speed of the drive motor, taking into account the speed of the direction motor,
  * in percent units (-1.0 -> 1.0)
  */
-void SwerveModule::set_speed(double percent)
+void SwerveModule::set_speed(scalar_t percent)
 {
   // take into account how the RPM of the direction motor affects the RPM of the drive wheel
   //double speed_diff_dps = 0;//direction.velocity(vex::velocityUnits::dps) * DIR_GEAR_RATIO * -.2;
   // Difference is negligable. Not worth the effort of getting it right.
-  drive.setReversed(inverseDrive);
+  if(drive_controller != NULL)
+    drive_controller->set_reversed(inverseDrive);
+  else
+    drive.setReversed(inverseDrive);
+
+  if(thermal_model != NULL)
+    thermal_model->update();
+
+  if(power_manager != NULL)
+    percent = power_manager->drive_output(power_index, percent, inverseDrive);
+
+  if(traction_control != NULL)
+    percent = traction_control->drive_output(traction_index, percent, inverseDrive);
+
+  // Let go at zero, as the voltage does, instead of the loop holding the wheel still
+  // against the other modules
+  if(drive_controller != NULL && percent == 0)
+    drive_controller->stop();
+  else if(drive_controller != NULL)
+    drive_controller->set_speed(percent);
+  else if(compensation != NULL)
+    compensation->spin(drive, percent);
+  else
+    drive.spin(vex::directionType::fwd, percent * 100, vex::velocityUnits::pct);
+}
+
+/**
+ * Drive the wheel by battery-compensated voltage (see battery_compensation.h) instead of
+ * the motor's velocity loop. Pass NULL to go back to velocity control.
+ */
+void SwerveModule::set_battery_compensation(BatteryCompensation *compensation)
+{
+  this->compensation = compensation;
+}
+
+/**
+ * Run the drive and / or direction motor with our own loops (see motor_controller.h)
+ * instead of the motors' internal ones. Pass NULL for either to go back to those.
+ */
+void SwerveModule::set_controllers(MotorController *drive_controller, MotorController *direction_controller)
+{
+  this->drive_controller = drive_controller;
+  this->direction_controller = direction_controller;
+}
+
+/**
+ * Share a current budget with the other modules (see power_manager.h): drive output is
+ * slew limited and scaled, and steering speed scaled, by (power_manager).
+ */
+void SwerveModule::set_power_manager(PowerManager &power_manager)
+{
+  this->power_manager = &power_manager;
+  power_index = power_manager.add_module(drive, direction);
+}
 
-  drive.spin(vex::directionType::fwd, percent * 100.0, vex::velocityUnits::pct);
+/**
+ * Lower the drive motor's current limit ahead of it overheating (see thermal_model.h)
+ */
+void SwerveModule::set_thermal_model(ThermalModel &thermal_model)
+{
+  this->thermal_model = &thermal_model;
+  thermal_model.add_motor(drive);
+}
+
+/**
+ * Hold the wheel to the floor's speed when it slips (see traction_control.h), and count
+ * distance driven by where the module really went. The module's center is (x), (y)
+ * inches from the robot's (right and forward).
+ */
+void SwerveModule::set_traction_control(TractionControl &traction_control, scalar_t x, scalar_t y)
+{
+  this->traction_control = &traction_control;
+  traction_index = traction_control.add_module(*this, x, y);
 }
 
 /**
@@ -92,16 +168,39 @@ void SwerveModule::set_speed(double percent)
 void SwerveModule::reset_distance_driven()
 {
   drive.resetPosition();
+
+  if(traction_control != NULL)
+    traction_control->reset_distance(traction_index);
 }
 
 /**
  * Get 'distance' from the drive motor.
  * Will ALWAYS be positive.
  */
-double SwerveModule::get_distance_driven()
+scalar_t SwerveModule::get_distance_driven()
 {
+  // The encoder over-counts while the wheel slips
+  if(traction_control != NULL)
+    return std::fabs(traction_control->get_distance(traction_index));
+
   // return drive.position(vex::rotationUnits::rev);
-  return fabs(WHEEL_DIAM * PI * drive.position(vex::rotationUnits::rev) * DRIVE_GEAR_RATIO);
+  return std::fabs((scalar_t)(WHEEL_DIAM * PI * DRIVE_GEAR_RATIO) * (scalar_t)drive.position(vex::rotationUnits::rev));
+}
+
+/**
+ * Which way the wheel is pointing (degrees, clockwise from forward) and how fast it's
+ * rolling that way (inches / second), from the motors' readings
+ */
+void SwerveModule::get_velocity(scalar_t *direction_deg, scalar_t *speed_ips)
+{
+  *direction_deg = (scalar_t)direction.position(vex::rotationUnits::deg) * (scalar_t)DIR_GEAR_RATIO;
+
+  // The drive motor reads reversed along with its output when the wheel runs backwards
+  scalar_t rpm = (scalar_t)drive.velocity(vex::velocityUnits::rpm);
+  if(inverseDrive)
+    rpm = -rpm;
+
+  *speed_ips = rpm / 60 * (scalar_t)(WHEEL_DIAM * PI * DRIVE_GEAR_RATIO);
 }
 
 /**
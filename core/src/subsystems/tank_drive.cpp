@@ -10,6 +10,13 @@ TankDrive::TankDrive(motor_group &left_motors, motor_group &right_motors, inerti
  */
 void TankDrive::stop()
 {
+  if (left_controller != NULL && right_controller != NULL)
+  {
+    left_controller->stop();
+    right_controller->stop();
+    return;
+  }
+
   left_motors.stop();
   right_motors.stop();
 }
@@ -20,8 +27,22 @@ void TankDrive::stop()
  * 
  * left_motors and right_motors are in "percent": -1.0 -> 1.0
  */
-void TankDrive::drive_tank(double left, double right)
+void TankDrive::drive_tank(scalar_t left, scalar_t right)
 {
+  if (left_controller != NULL && right_controller != NULL)
+  {
+    left_controller->set_speed(left);
+    right_controller->set_speed(right);
+    return;
+  }
+
+  if (compensation != NULL)
+  {
+    compensation->spin(left_motors, left);
+    compensation->spin(right_motors, right);
+    return;
+  }
+
   left_motors.setVelocity(left * 100, velocityUnits::pct);
   right_motors.setVelocity(right * 100, velocityUnits::pct);
 }
@@ -32,13 +53,12 @@ void TankDrive::drive_tank(double left, double right)
  * 
  * left_motors and right_motors are in "percent": -1.0 -> 1.0
  */
-void TankDrive::drive_arcade(double forward_back, double left_right)
+void TankDrive::drive_arcade(scalar_t forward_back, scalar_t left_right)
 {
-  double left = forward_back + left_right;
-  double right = forward_back - left_right;
+  scalar_t left = forward_back + left_right;
+  scalar_t right = forward_back - left_right;
 
-  left_motors.setVelocity(left * 100, velocityUnits::pct);
-  right_motors.setVelocity(right * 100, velocityUnits::pct);
+  drive_tank(left, right);
 }
 
 /**
@@ -47,7 +67,7 @@ void TankDrive::drive_arcade(double forward_back, double left_right)
  * 
  * Uses a PID loop for it's control.
  */
-bool TankDrive::drive_forward(double inches, double percent_speed)
+bool TankDrive::drive_forward(scalar_t inches, scalar_t percent_speed)
 {
   // On the first run of the funciton, reset the motor position and PID
   if (initialize_func)
@@ -55,16 +75,33 @@ bool TankDrive::drive_forward(double inches, double percent_speed)
     left_motors.resetPosition();
     drive_pid.reset();
 
-    drive_pid.set_limits(-fabs(percent_speed), fabs(percent_speed));
+    drive_pid.set_limits(-std::fabs(percent_speed), std::fabs(percent_speed));
     drive_pid.set_target(inches);
 
+    collision = CollisionDetector::NONE;
+    if (collision_detector != NULL)
+      collision_detector->reset();
+
     initialize_func = false;
   }
 
   // Update PID loop and drive the robot based on it's output
-  drive_pid.update(left_motors.position(rotationUnits::rev) * PI * config.wheel_diam);
+  drive_pid.update((scalar_t)left_motors.position(rotationUnits::rev) * (scalar_t)PI * config.wheel_diam);
   drive_tank(drive_pid.get(), drive_pid.get());
 
+  // Ran into something: give up now instead of pushing against it until a timeout
+  if (collision_detector != NULL)
+  {
+    scalar_t rpm = ((scalar_t)left_motors.velocity(velocityUnits::rpm) + (scalar_t)right_motors.velocity(velocityUnits::rpm)) / 2;
+    if (collision_detector->update(0, drive_pid.get(), rpm / 60 * (scalar_t)PI * config.wheel_diam))
+    {
+      collision = collision_detector->get_cause();
+      drive_tank(0, 0);
+      initialize_func = true;
+      return true;
+    }
+  }
+
   // If the robot is at it's target, return true
   if (drive_pid.is_on_target())
   {
@@ -82,7 +119,7 @@ bool TankDrive::drive_forward(double inches, double percent_speed)
  * 
  * Uses a PID loop for it's control.
  */
-bool TankDrive::turn_degrees(double degrees, double percent_speed)
+bool TankDrive::turn_degrees(scalar_t degrees, scalar_t percent_speed)
 {
   // On the first run of the funciton, reset the gyro position and PID
   if (initialize_func)
@@ -90,7 +127,7 @@ bool TankDrive::turn_degrees(double degrees, double percent_speed)
     gyro_sensor.resetRotation();
     turn_pid.reset();
 
-    turn_pid.set_limits(-fabs(percent_speed), fabs(percent_speed));
+    turn_pid.set_limits(-std::fabs(percent_speed), std::fabs(percent_speed));
     turn_pid.set_target(degrees);
 
     initialize_func = false;
@@ -109,4 +146,41 @@ bool TankDrive::turn_degrees(double degrees, double percent_speed)
   }
 
   return false;
+}
+
+/**
+ * Drive the wheels by battery-compensated voltage (see battery_compensation.h) instead of
+ * the motors' velocity loops. Pass NULL to go back to velocity control.
+ */
+void TankDrive::set_battery_compensation(BatteryCompensation *compensation)
+{
+  this->compensation = compensation;
+}
+
+/**
+ * Run each side with our own velocity loop (see motor_controller.h) instead of the
+ * motors' internal ones. Pass NULL for both to go back to those.
+ */
+void TankDrive::set_controllers(MotorController *left_controller, MotorController *right_controller)
+{
+  this->left_controller = left_controller;
+  this->right_controller = right_controller;
+}
+
+/**
+ * Stop drive_forward early (returning true) when (detector) says the robot has run into
+ * something. Pass NULL to always drive the full distance.
+ */
+void TankDrive::set_collision_detector(CollisionDetector *detector)
+{
+  this->collision_detector = detector;
+}
+
+/**
+ * Why the last drive_forward stopped early, or CollisionDetector::NONE if it reached
+ * its target
+ */
+CollisionDetector::cause_t TankDrive::get_collision()
+{
+  return collision;
 }
\ No newline at end of file
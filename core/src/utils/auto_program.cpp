@@ -0,0 +1,367 @@
+#include "../core/include/utils/auto_program.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+uint16_t get16(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+uint32_t get32(const uint8_t *p)
+{
+  return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+float get_float(const uint8_t *p)
+{
+  uint32_t bits = get32(p);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+} // namespace
+
+/**
+ * Parse a program from memory. Returns false, leaving the program empty, if it's invalid.
+ */
+bool AutoProgram::load(const uint8_t *data, int32_t len)
+{
+  routine_count = 0;
+  action_count = 0;
+
+  if (len < AUTO_PROGRAM_HEADER_BYTES || get32(data) != AUTO_PROGRAM_MAGIC || get16(data + 4) != AUTO_PROGRAM_VERSION)
+  {
+    fprintf(stderr, "AutoProgram: not a program file\n");
+    return false;
+  }
+
+  int num_routines = get16(data + 6);
+  int num_actions = get16(data + 8);
+  if (num_routines > AUTO_PROGRAM_MAX_ROUTINES || num_actions > AUTO_PROGRAM_MAX_ACTIONS
+      || len != AUTO_PROGRAM_HEADER_BYTES + num_routines * AUTO_PROGRAM_ROUTINE_BYTES
+                    + num_actions * AUTO_PROGRAM_ACTION_BYTES)
+  {
+    fprintf(stderr, "AutoProgram: program is truncated or too big\n");
+    return false;
+  }
+
+  const uint8_t *p = data + AUTO_PROGRAM_HEADER_BYTES;
+  for (int i = 0; i < num_routines; i++, p += AUTO_PROGRAM_ROUTINE_BYTES)
+  {
+    memcpy(routines[i].name, p, AUTO_PROGRAM_NAME_LEN);
+    routines[i].name[AUTO_PROGRAM_NAME_LEN] = '\0';
+    routines[i].first = get16(p + 16);
+    routines[i].count = get16(p + 18);
+
+    if (routines[i].first + routines[i].count > num_actions)
+    {
+      fprintf(stderr, "AutoProgram: routine %s runs past the end of the program\n", routines[i].name);
+      return false;
+    }
+  }
+
+  for (int i = 0; i < num_actions; i++, p += AUTO_PROGRAM_ACTION_BYTES)
+  {
+    actions[i].op = p[0];
+    actions[i].block_size = p[1];
+    actions[i].timeout_ms = get16(p + 2);
+    for (int a = 0; a < 3; a++)
+      actions[i].args[a] = get_float(p + 4 + 4 * a);
+
+    if (actions[i].op < OP_DRIVE || actions[i].op > OP_PARALLEL)
+    {
+      fprintf(stderr, "AutoProgram: unknown action %d\n", actions[i].op);
+      return false;
+    }
+  }
+
+  // Parallel blocks must hold plain actions, and end inside their routine
+  for (int r = 0; r < num_routines; r++)
+  {
+    int end = routines[r].first + routines[r].count;
+    for (int i = routines[r].first; i < end; i++)
+    {
+      if (actions[i].op != OP_PARALLEL)
+        continue;
+
+      int size = actions[i].block_size;
+      bool valid = size <= AUTO_PROGRAM_MAX_BLOCK && i + size < end;
+      for (int m = i + 1; valid && m <= i + size; m++)
+        valid = actions[m].op != OP_PARALLEL;
+
+      if (!valid)
+      {
+        fprintf(stderr, "AutoProgram: bad parallel block in routine %s\n", routines[r].name);
+        return false;
+      }
+      i += size;
+    }
+  }
+
+  routine_count = num_routines;
+  action_count = num_actions;
+  return true;
+}
+
+/**
+ * Load a program file from the SD card, with a buffer allocated just for the load.
+ */
+bool AutoProgram::load(vex::brain::sdcard &sd, const char *filename)
+{
+  if (!sd.isInserted() || !sd.exists(filename))
+    return false;
+
+  int32_t max_len = AUTO_PROGRAM_HEADER_BYTES + AUTO_PROGRAM_MAX_ROUTINES * AUTO_PROGRAM_ROUTINE_BYTES
+                  + AUTO_PROGRAM_MAX_ACTIONS * AUTO_PROGRAM_ACTION_BYTES;
+  uint8_t *buffer = (uint8_t *)malloc(max_len);
+  if (buffer == NULL)
+    return false;
+
+  int32_t len = sd.loadfile(filename, buffer, max_len);
+  bool loaded = len > 0 && load(buffer, len);
+
+  free(buffer);
+  return loaded;
+}
+
+int AutoProgram::num_routines() const
+{
+  return routine_count;
+}
+
+/**
+ * Index of the routine called (name), or -1
+ */
+int AutoProgram::find(const char *name) const
+{
+  for (int i = 0; i < routine_count; i++)
+    if (strncmp(routines[i].name, name, AUTO_PROGRAM_NAME_LEN) == 0)
+      return i;
+  return -1;
+}
+
+const AutoProgram::routine_t &AutoProgram::get_routine(int index) const
+{
+  return routines[index];
+}
+
+const AutoProgram::action_t &AutoProgram::get_action(int index) const
+{
+  return actions[index];
+}
+
+/**
+ * Make "command (id)" actions run (command)
+ */
+void AutoProgram::bind(int id, Command &command)
+{
+  if (id >= 0 && id < AUTO_PROGRAM_MAX_COMMANDS)
+    commands[id] = &command;
+}
+
+Command *AutoProgram::get_command(int id) const
+{
+  return (id >= 0 && id < AUTO_PROGRAM_MAX_COMMANDS) ? commands[id] : NULL;
+}
+
+/**
+ * Whether (drivetrain) has every path the program follows. If not, says which are
+ * missing and empties the program, so no routine runs without its paths.
+ */
+bool AutoProgram::check_paths(const Drivetrain &drivetrain)
+{
+  bool ok = true;
+  for (int r = 0; r < routine_count; r++)
+  {
+    for (int i = routines[r].first; i < routines[r].first + routines[r].count; i++)
+    {
+      if (actions[i].op == OP_PATH && !drivetrain.has_path((int)actions[i].args[0]))
+      {
+        fprintf(stderr, "AutoProgram: routine %s follows path %d, which this robot doesn't have\n",
+                routines[r].name, (int)actions[i].args[0]);
+        ok = false;
+      }
+    }
+  }
+
+  if (!ok)
+  {
+    routine_count = 0;
+    action_count = 0;
+  }
+  return ok;
+}
+
+ProgramCommand::ProgramCommand(AutoProgram &program, AutoProgram::Drivetrain &drivetrain)
+    : program(program), drivetrain(drivetrain)
+{
+  name = "program";
+}
+
+/**
+ * Choose the routine to run next time the command starts. Returns false if there is
+ * no such routine.
+ */
+bool ProgramCommand::select(int routine)
+{
+  if (routine < 0 || routine >= program.num_routines())
+    return false;
+
+  this->routine = routine;
+  return true;
+}
+
+bool ProgramCommand::select(const char *name)
+{
+  return select(program.find(name));
+}
+
+void ProgramCommand::initialize()
+{
+  num_running = 0;
+  next = end_index = 0;
+
+  if (routine < 0 || routine >= program.num_routines())
+    return;
+
+  next = program.get_routine(routine).first;
+  end_index = next + program.get_routine(routine).count;
+  start_step();
+}
+
+/**
+ * Start the next action, or the next parallel block
+ */
+void ProgramCommand::start_step()
+{
+  num_running = 0;
+  block = -1;
+  step_start_ms = vexSystemTimeGet();
+
+  // Loops so that empty parallel blocks are skipped over
+  while (num_running == 0 && next < end_index)
+  {
+    const AutoProgram::action_t &action = program.get_action(next);
+    if (action.op == AutoProgram::OP_PARALLEL)
+    {
+      block = next;
+      for (int i = 0; i < action.block_size; i++)
+        running[num_running++] = next + 1 + i;
+      next += 1 + action.block_size;
+    }
+    else
+      running[num_running++] = next++;
+  }
+
+  for (int i = 0; i < num_running; i++)
+  {
+    running_done[i] = false;
+    start_action(running[i]);
+  }
+}
+
+void ProgramCommand::execute()
+{
+  if (num_running == 0)
+    return;
+
+  // A parallel block's own timeout applies to the whole block
+  uint32_t elapsed = vexSystemTimeGet() - step_start_ms;
+  bool block_timed_out = block >= 0 && program.get_action(block).timeout_ms != 0
+                         && elapsed >= program.get_action(block).timeout_ms;
+
+  bool all_done = true;
+  for (int i = 0; i < num_running; i++)
+  {
+    if (running_done[i])
+      continue;
+
+    const AutoProgram::action_t &action = program.get_action(running[i]);
+    if (block_timed_out || (action.timeout_ms != 0 && elapsed >= action.timeout_ms))
+    {
+      stop_action(running[i]);
+      running_done[i] = true;
+    }
+    else if (run_action(running[i]))
+      running_done[i] = true;
+    else
+      all_done = false;
+  }
+
+  if (all_done)
+    start_step();
+}
+
+void ProgramCommand::end(bool interrupted)
+{
+  for (int i = 0; i < num_running; i++)
+    if (!running_done[i])
+      stop_action(running[i]);
+  num_running = 0;
+}
+
+bool ProgramCommand::is_finished()
+{
+  return num_running == 0 && next >= end_index;
+}
+
+void ProgramCommand::start_action(int index)
+{
+  const AutoProgram::action_t &action = program.get_action(index);
+  if (action.op != AutoProgram::OP_COMMAND)
+    return;
+
+  Command *command = program.get_command((int)action.args[0]);
+  if (command != NULL)
+    command->start();
+}
+
+/**
+ * Run one tick of an action. Returns true when it has finished.
+ */
+bool ProgramCommand::run_action(int index)
+{
+  const AutoProgram::action_t &action = program.get_action(index);
+  switch (action.op)
+  {
+  case AutoProgram::OP_DRIVE:
+    return drivetrain.drive(action.args[0], action.args[1], action.args[2]);
+  case AutoProgram::OP_TURN:
+    return drivetrain.turn(action.args[0], action.args[1]);
+  case AutoProgram::OP_PATH:
+    return drivetrain.follow_path((int)action.args[0]);
+  case AutoProgram::OP_WAIT:
+    return vexSystemTimeGet() - step_start_ms >= (uint32_t)(action.args[0] * 1000);
+  case AutoProgram::OP_COMMAND:
+  {
+    Command *command = program.get_command((int)action.args[0]);
+    return command == NULL || command->step();
+  }
+  default:
+    return true;
+  }
+}
+
+void ProgramCommand::stop_action(int index)
+{
+  const AutoProgram::action_t &action = program.get_action(index);
+  switch (action.op)
+  {
+  case AutoProgram::OP_DRIVE:
+  case AutoProgram::OP_TURN:
+  case AutoProgram::OP_PATH:
+    drivetrain.stop();
+    break;
+  case AutoProgram::OP_COMMAND:
+  {
+    Command *command = program.get_command((int)action.args[0]);
+    if (command != NULL)
+      command->cancel();
+    break;
+  }
+  default:
+    break;
+  }
+}
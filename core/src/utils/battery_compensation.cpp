@@ -0,0 +1,77 @@
+#include "../core/include/utils/battery_compensation.h"
+
+// Weight of each new battery sample (~50ms time constant at BATTERY_SAMPLE_MS)
+#define BATTERY_FILTER_ALPHA 0.2
+
+/**
+ * Compensate against (battery), so a command of 1.0 gives (nominal_v) at the motor
+ */
+BatteryCompensation::BatteryCompensation(vex::brain::battery &battery, scalar_t nominal_v)
+    : battery(battery), nominal_v(nominal_v)
+{
+}
+
+/**
+ * Battery voltage, low-pass filtered so one motor's current spike doesn't jolt the
+ * others. Re-read at most every BATTERY_SAMPLE_MS, however many motors ask.
+ */
+scalar_t BatteryCompensation::battery_voltage()
+{
+  uint32_t now = vexSystemTimeGet();
+  if (filtered_v > 0 && now - last_sample_ms < BATTERY_SAMPLE_MS)
+    return filtered_v;
+
+  scalar_t measured = (scalar_t)battery.voltage(vex::voltageUnits::volt);
+  last_sample_ms = now;
+
+  // No reading (battery not reported yet): assume nominal rather than divide by zero
+  if (measured <= 1)
+    return filtered_v > 0 ? filtered_v : nominal_v;
+
+  if (filtered_v <= 0)
+    filtered_v = measured;
+  else
+    filtered_v += (scalar_t)BATTERY_FILTER_ALPHA * (measured - filtered_v);
+
+  return filtered_v;
+}
+
+/**
+ * Voltage command (-12 -> 12) that puts (percent) (-1.0 -> 1.0) of the nominal voltage
+ * on a motor. Saturates once the battery can't deliver any more.
+ */
+scalar_t BatteryCompensation::volts(scalar_t percent)
+{
+  return command_for(percent * nominal_v);
+}
+
+/**
+ * Voltage command (-12 -> 12) that puts (volts) on a motor with the battery as it is now
+ */
+scalar_t BatteryCompensation::command_for(scalar_t volts)
+{
+  scalar_t command = volts * (scalar_t)MOTOR_FULL_SCALE_V / battery_voltage();
+  if (command > (scalar_t)MOTOR_FULL_SCALE_V)
+    return (scalar_t)MOTOR_FULL_SCALE_V;
+  if (command < -(scalar_t)MOTOR_FULL_SCALE_V)
+    return -(scalar_t)MOTOR_FULL_SCALE_V;
+  return command;
+}
+
+/**
+ * Spin (motor) / (motors) at (percent) (-1.0 -> 1.0) of the nominal voltage
+ */
+void BatteryCompensation::spin(vex::motor &motor, scalar_t percent)
+{
+  motor.spin(vex::directionType::fwd, volts(percent), vex::voltageUnits::volt);
+}
+
+void BatteryCompensation::spin(vex::motor_group &motors, scalar_t percent)
+{
+  motors.spin(vex::directionType::fwd, volts(percent), vex::voltageUnits::volt);
+}
+
+scalar_t BatteryCompensation::get_nominal_voltage() const
+{
+  return nominal_v;
+}
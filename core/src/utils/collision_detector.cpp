@@ -0,0 +1,114 @@
+#include "../core/include/utils/collision_detector.h"
+#include <cmath>
+
+#define DEG_TO_RAD (3.141592654 / 180.0)
+
+// Left alone longer than this, nothing from the last update carries over
+#define STALE_MS 100
+
+CollisionDetector::CollisionDetector(vex::inertial &imu, collision_config_t &config) : imu(imu), config(config)
+{
+}
+
+/**
+ * Watch (motor) for stalls. Returns false if there are too many.
+ */
+bool CollisionDetector::add_motor(vex::motor &motor)
+{
+  if (num_motors >= COLLISION_DETECTOR_MAX_MOTORS)
+    return false;
+
+  motors[num_motors++] = &motor;
+  return true;
+}
+
+/**
+ * Start watching a new drive: forget anything detected, with the robot at rest
+ */
+void CollisionDetector::reset()
+{
+  cause = NONE;
+  expected = 0;
+  stall_ms = blocked_ms = 0;
+  updated = false;
+}
+
+/**
+ * Check the robot, driving towards (direction_deg) (clockwise from the robot's front)
+ * with the drive commanded at (command) (-1.0 -> 1.0), and moving at (speed) in/s that
+ * way. Call it every loop. Returns true once it has hit something.
+ */
+bool CollisionDetector::update(scalar_t direction_deg, scalar_t command, scalar_t speed)
+{
+  if (cause != NONE)
+    return true;
+
+  uint32_t now = vexSystemTimeGet();
+  bool stale = !updated || now - last_update_ms > STALE_MS;
+  uint32_t elapsed_ms = stale ? 0 : now - last_update_ms;
+  last_update_ms = now;
+  updated = true;
+
+  // Blocked: well short of where the command should have got the robot by now
+  scalar_t target = command * config.max_speed;
+  if (stale)
+    expected = speed;
+  else if (config.response_s > 0)
+    expected += (target - expected) * (1 - std::exp(-(elapsed_ms / (scalar_t)1000) / config.response_s));
+  else
+    expected = target;
+
+  scalar_t shortfall = expected > 0 ? expected - speed : speed - expected;
+  bool blocked = std::fabs(expected) > config.tracking_error && shortfall > config.tracking_error;
+  blocked_ms = blocked ? blocked_ms + elapsed_ms : 0;
+
+  // Impact: slowing down harder than the wheels can brake, so something else stopped it
+  scalar_t along = (scalar_t)imu.acceleration(vex::axisType::xaxis) * std::sin(direction_deg * (scalar_t)DEG_TO_RAD) +
+                   (scalar_t)imu.acceleration(vex::axisType::yaxis) * std::cos(direction_deg * (scalar_t)DEG_TO_RAD);
+  scalar_t braking = command > 0 ? -along : (command < 0 ? along : 0);
+  if (config.impact_g > 0 && braking > config.impact_g)
+  {
+    cause = IMPACT;
+    return true;
+  }
+
+  // Stall: a motor straining without turning
+  bool stalled = false;
+  for (int i = 0; i < num_motors; i++)
+  {
+    if ((scalar_t)motors[i]->current(vex::currentUnits::amp) >= config.stall_current_a &&
+        std::fabs((scalar_t)motors[i]->velocity(vex::velocityUnits::rpm)) < config.stall_rpm)
+      stalled = true;
+  }
+  stall_ms = stalled ? stall_ms + elapsed_ms : 0;
+
+  if (stall_ms > 0 && stall_ms >= config.confirm_ms)
+    cause = STALL;
+  else if (blocked_ms > 0 && blocked_ms >= config.confirm_ms)
+    cause = BLOCKED;
+
+  return cause != NONE;
+}
+
+/**
+ * What was detected since the last reset(), or NONE
+ */
+CollisionDetector::cause_t CollisionDetector::get_cause() const
+{
+  return cause;
+}
+
+const char *CollisionDetector::cause_name(cause_t cause)
+{
+  switch (cause)
+  {
+  case IMPACT:
+    return "impact";
+  case STALL:
+    return "stall";
+  case BLOCKED:
+    return "blocked";
+  default:
+    return "none";
+  }
+}
@@ -0,0 +1,484 @@
+#include "../core/include/utils/command.h"
+
+namespace
+{
+// Subsystems that commands have required so far. Each one's index is its requirement bit.
+const void *subsystems[COMMAND_SUBSYSTEM_MAX];
+int num_subsystems = 0;
+
+uint32_t subsystem_bit(const void *subsystem)
+{
+  for (int i = 0; i < num_subsystems; i++)
+    if (subsystems[i] == subsystem)
+      return 1u << i;
+
+  if (num_subsystems >= COMMAND_SUBSYSTEM_MAX)
+  {
+    fprintf(stderr, "Command: too many subsystems, requirement ignored\n");
+    return 0;
+  }
+
+  subsystems[num_subsystems] = subsystem;
+  return 1u << num_subsystems++;
+}
+} // namespace
+
+/**
+ * Stop the command (interrupted) if it runs longer than (seconds). 0 for no timeout.
+ */
+Command &Command::with_timeout(scalar_t seconds)
+{
+  timeout = seconds;
+  return *this;
+}
+
+/**
+ * Name the command, for the CommandProfiler report. Must be a string literal or
+ * otherwise outlive the command.
+ */
+Command &Command::set_name(const char *name)
+{
+  this->name = name;
+  return *this;
+}
+
+const char *Command::get_name() const
+{
+  return name;
+}
+
+/**
+ * Mark this command as using a subsystem (any object, e.g. the drivetrain). A
+ * scheduler never runs two commands that require the same subsystem.
+ */
+Command &Command::add_requirement(const void *subsystem)
+{
+  requirements |= subsystem_bit(subsystem);
+  return *this;
+}
+
+/**
+ * Bitmask of the subsystems this command requires
+ */
+uint32_t Command::get_requirements() const
+{
+  return requirements;
+}
+
+/**
+ * Start the command: calls initialize() and starts the timeout.
+ * Used by CommandScheduler and the command groups.
+ */
+void Command::start()
+{
+  start_time_ms = vexSystemTimeGet();
+  running = true;
+  did_time_out = false;
+
+  CommandProfiler *profiler = CommandProfiler::active;
+  profile_generation = CommandProfiler::generation;
+  if (profiler == NULL)
+  {
+    profile_id = -1;
+    initialize();
+    return;
+  }
+
+  // Anything initialize() starts (e.g. a group's children) is recorded under this command
+  profile_id = profiler->command_started(name);
+  uint64_t enter_us = profiler->enter(profile_id);
+  initialize();
+  profiler->leave(profile_id, enter_us, false);
+}
+
+/**
+ * Run one tick of the command. Returns true, after calling end(), if the command
+ * finished or timed out on this tick.
+ */
+bool Command::step()
+{
+  if (!running)
+    return true;
+
+  CommandProfiler *profiler = CommandProfiler::active;
+  if (profiler != NULL)
+  {
+    int id = profile_generation == CommandProfiler::generation ? profile_id : -1;
+    uint64_t enter_us = profiler->enter(id);
+    execute();
+    profiler->leave(id, enter_us, true);
+  }
+  else
+    execute();
+
+  if (is_finished())
+  {
+    running = false;
+    profile_end(CommandProfiler::FINISHED);
+    end(false);
+    return true;
+  }
+
+  if (timeout > 0 && vexSystemTimeGet() - start_time_ms >= (uint32_t)(timeout * 1000))
+  {
+    running = false;
+    did_time_out = true;
+    profile_end(CommandProfiler::TIMED_OUT);
+    end(true);
+    return true;
+  }
+
+  return false;
+}
+
+/**
+ * Stop the command early, calling end(true), if it is running.
+ */
+void Command::cancel()
+{
+  if (!running)
+    return;
+
+  running = false;
+  profile_end(CommandProfiler::CANCELLED);
+  end(true);
+}
+
+/**
+ * Whether the command has been started and has not yet ended
+ */
+bool Command::is_running() const
+{
+  return running;
+}
+
+/**
+ * Whether the command's last run ended because of its timeout
+ */
+bool Command::timed_out() const
+{
+  return did_time_out;
+}
+
+void Command::profile_end(CommandProfiler::end_reason_t reason)
+{
+  CommandProfiler *profiler = CommandProfiler::active;
+  if (profiler != NULL && profile_generation == CommandProfiler::generation)
+    profiler->command_ended(profile_id, reason);
+  profile_id = -1;
+}
+
+FunctionCommand::FunctionCommand(bool (*func)())
+    : func(func), func_arg(NULL), arg(NULL)
+{
+  name = "function";
+}
+
+FunctionCommand::FunctionCommand(bool (*func)(void *), void *arg)
+    : func(NULL), func_arg(func), arg(arg)
+{
+  name = "function";
+}
+
+void FunctionCommand::execute()
+{
+  done = func != NULL ? func() : func_arg(arg);
+}
+
+bool FunctionCommand::is_finished()
+{
+  return done;
+}
+
+WaitCommand::WaitCommand(scalar_t seconds)
+    : duration_ms((uint32_t)(seconds * 1000))
+{
+  name = "wait";
+}
+
+void WaitCommand::initialize()
+{
+  start_ms = vexSystemTimeGet();
+}
+
+bool WaitCommand::is_finished()
+{
+  return vexSystemTimeGet() - start_ms >= duration_ms;
+}
+
+CommandGroup::CommandGroup(std::initializer_list<Command *> commands, bool parallel)
+    : parallel(parallel)
+{
+  for (Command *command : commands)
+    add(*command);
+}
+
+/**
+ * Add a command to the end of the group. Returns false, and leaves the command out, if
+ * the group is full, or if it's one of the groups that run their commands at once
+ * (ParallelGroup, RaceGroup, DeadlineGroup) and the command requires a subsystem
+ * another of them already requires.
+ */
+bool CommandGroup::add(Command &command)
+{
+  if (num_children >= COMMAND_GROUP_MAX)
+  {
+    fprintf(stderr, "CommandGroup: more than %d commands, command left out\n", COMMAND_GROUP_MAX);
+    complete = false;
+    return false;
+  }
+
+  // The scheduler only keeps apart the commands it runs itself, not those inside a group
+  if (parallel)
+  {
+    uint32_t required = command.get_requirements();
+    for (int i = 0; i < num_children; i++)
+      if ((children[i]->get_requirements() & required) != 0)
+      {
+        fprintf(stderr, "CommandGroup: \"%s\" requires the same subsystem as \"%s\", command left out\n",
+                command.get_name(), children[i]->get_name());
+        complete = false;
+        return false;
+      }
+  }
+
+  children[num_children++] = &command;
+  return true;
+}
+
+/**
+ * Whether every command given to the group, in its constructor or add(), was added.
+ * Check it where the group is made: a group missing a command still runs the rest.
+ */
+bool CommandGroup::is_complete() const
+{
+  return complete;
+}
+
+/**
+ * The group's own requirements, plus everything its commands require
+ */
+uint32_t CommandGroup::get_requirements() const
+{
+  uint32_t all = requirements;
+  for (int i = 0; i < num_children; i++)
+    all |= children[i]->get_requirements();
+  return all;
+}
+
+SequentialGroup::SequentialGroup(std::initializer_list<Command *> commands)
+    : CommandGroup(commands, false)
+{
+  name = "sequence";
+}
+
+void SequentialGroup::initialize()
+{
+  current = 0;
+  if (num_children > 0)
+    children[0]->start();
+}
+
+void SequentialGroup::execute()
+{
+  if (current >= num_children)
+    return;
+
+  // Move straight on to the next command, so its first tick is the next one
+  if (children[current]->step() && ++current < num_children)
+    children[current]->start();
+}
+
+void SequentialGroup::end(bool interrupted)
+{
+  if (current < num_children)
+    children[current]->cancel();
+}
+
+bool SequentialGroup::is_finished()
+{
+  return current >= num_children;
+}
+
+ParallelGroup::ParallelGroup(std::initializer_list<Command *> commands)
+    : CommandGroup(commands, true)
+{
+  name = "parallel";
+}
+
+void ParallelGroup::initialize()
+{
+  for (int i = 0; i < num_children; i++)
+    children[i]->start();
+}
+
+void ParallelGroup::execute()
+{
+  for (int i = 0; i < num_children; i++)
+    if (children[i]->is_running())
+      children[i]->step();
+}
+
+void ParallelGroup::end(bool interrupted)
+{
+  for (int i = 0; i < num_children; i++)
+    children[i]->cancel();
+}
+
+bool ParallelGroup::is_finished()
+{
+  for (int i = 0; i < num_children; i++)
+    if (children[i]->is_running())
+      return false;
+  return true;
+}
+
+RaceGroup::RaceGroup(std::initializer_list<Command *> commands)
+    : ParallelGroup(commands)
+{
+  name = "race";
+}
+
+bool RaceGroup::is_finished()
+{
+  for (int i = 0; i < num_children; i++)
+    if (!children[i]->is_running())
+      return true;
+  return num_children == 0;
+}
+
+DeadlineGroup::DeadlineGroup(std::initializer_list<Command *> commands)
+    : ParallelGroup(commands)
+{
+  name = "deadline";
+}
+
+bool DeadlineGroup::is_finished()
+{
+  return num_children == 0 || !children[0]->is_running();
+}
+
+/**
+ * Start running a command. Any running command that requires one of the same
+ * subsystems is cancelled first. Returns false if the command could not be scheduled
+ * because too many are already running.
+ */
+bool CommandScheduler::schedule(Command &command)
+{
+  if (is_scheduled(command))
+    return true;
+
+  uint32_t required = command.get_requirements();
+  for (int i = 0; i < num_scheduled; i++)
+    if (scheduled[i] != NULL && (scheduled[i]->get_requirements() & required) != 0)
+      cancel(*scheduled[i]);
+
+  if (num_scheduled >= COMMAND_SCHEDULER_MAX && !in_run)
+    compact();
+
+  if (num_scheduled >= COMMAND_SCHEDULER_MAX)
+  {
+    fprintf(stderr, "CommandScheduler: more than %d commands running\n", COMMAND_SCHEDULER_MAX);
+    return false;
+  }
+
+  scheduled[num_scheduled++] = &command;
+  command.start();
+  return true;
+}
+
+/**
+ * Stop a running command, calling its end(true)
+ */
+void CommandScheduler::cancel(Command &command)
+{
+  for (int i = 0; i < num_scheduled; i++)
+    if (scheduled[i] == &command)
+    {
+      scheduled[i] = NULL;
+      command.cancel();
+    }
+}
+
+/**
+ * Stop every running command
+ */
+void CommandScheduler::cancel_all()
+{
+  for (int i = 0; i < num_scheduled; i++)
+    if (scheduled[i] != NULL)
+      cancel(*scheduled[i]);
+
+  if (!in_run)
+    compact();
+}
+
+/**
+ * Run one tick of every scheduled command, removing those that finish.
+ * Call this once per loop.
+ */
+void CommandScheduler::run()
+{
+  // Commands may schedule or cancel others while they run; slots are only cleared
+  // here, and closed up once every command has had its tick.
+  CommandProfiler *profiler = CommandProfiler::active;
+  if (profiler != NULL)
+    profiler->tick_started();
+
+  in_run = true;
+  for (int i = 0; i < num_scheduled; i++)
+    if (scheduled[i] != NULL && scheduled[i]->step())
+      scheduled[i] = NULL;
+  in_run = false;
+
+  if (profiler != NULL)
+    profiler->tick_ended();
+
+  compact();
+}
+
+/**
+ * Whether the command is currently scheduled
+ */
+bool CommandScheduler::is_scheduled(Command &command) const
+{
+  for (int i = 0; i < num_scheduled; i++)
+    if (scheduled[i] == &command)
+      return true;
+  return false;
+}
+
+/**
+ * Whether no commands are scheduled
+ */
+bool CommandScheduler::is_idle() const
+{
+  for (int i = 0; i < num_scheduled; i++)
+    if (scheduled[i] != NULL)
+      return false;
+  return true;
+}
+
+/**
+ * Call run() every (period_ms) until every scheduled command has finished.
+ */
+void CommandScheduler::run_until_idle(uint32_t period_ms)
+{
+  while (!is_idle())
+  {
+    run();
+    vexDelay(period_ms);
+  }
+}
+
+/**
+ * Close up the gaps left by finished and cancelled commands, keeping them in order
+ */
+void CommandScheduler::compact()
+{
+  int count = 0;
+  for (int i = 0; i < num_scheduled; i++)
+    if (scheduled[i] != NULL)
+      scheduled[count++] = scheduled[i];
+  num_scheduled = count;
+}
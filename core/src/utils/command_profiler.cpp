@@ -0,0 +1,278 @@
+#include "../core/include/utils/command_profiler.h"
+
+CommandProfiler *CommandProfiler::active = NULL;
+uint32_t CommandProfiler::generation = 0;
+
+namespace
+{
+const char *reason_names[] = {"running", "finished", "cancelled", "timed out"};
+
+double ms(uint64_t us)
+{
+  return us / 1000.0;
+}
+} // namespace
+
+/**
+ * Start recording (clearing anything recorded before). Only one profiler records
+ * at a time.
+ */
+void CommandProfiler::start()
+{
+  generation++;
+  num_records = 0;
+  stack_depth = 0;
+  tick_us = 0;
+  ticks = 0;
+  start_us = vexSystemHighResTimeGet();
+  stop_us = 0;
+  active = this;
+}
+
+/**
+ * Stop recording. Commands still running are reported as such.
+ */
+void CommandProfiler::stop()
+{
+  stop_us = vexSystemHighResTimeGet();
+  if (active == this)
+    active = NULL;
+}
+
+/**
+ * Records made so far, in the order the commands started
+ */
+const CommandProfiler::record_t *CommandProfiler::get_records(int *count) const
+{
+  *count = num_records;
+  return records;
+}
+
+/**
+ * Name the part of the running command that the code after this call belongs to,
+ * until the next call or the command ends. NULL ends the current phase.
+ * Does nothing if no profiler is recording.
+ */
+void CommandProfiler::phase(const char *name)
+{
+  CommandProfiler *self = active;
+  if (self == NULL)
+    return;
+
+  int owner = self->innermost();
+  if (owner < 0)
+    return;
+
+  // Calling with the same name every tick continues the phase
+  int current = self->open_phase[owner];
+  if (current >= 0 && name != NULL && self->records[current].name == name)
+    return;
+
+  uint64_t now = vexSystemHighResTimeGet();
+  self->end_phase(owner, now);
+
+  if (name == NULL || self->num_records >= PROFILER_MAX_RECORDS)
+    return;
+
+  int id = self->num_records++;
+  self->records[id] = {name, true, owner, self->records[owner].depth + 1, now, 0, 0, 0, RUNNING};
+  self->open_phase[id] = -1;
+  self->open_phase[owner] = id;
+}
+
+/**
+ * Called when a command starts. Returns the id of its record, or -1 if it isn't recorded.
+ */
+int CommandProfiler::command_started(const char *name)
+{
+  if (num_records >= PROFILER_MAX_RECORDS)
+    return -1;
+
+  // Commands started while another is executing belong to it (e.g. children of a group)
+  int parent = innermost();
+  int depth = parent >= 0 ? records[parent].depth + 1 : 0;
+
+  int id = num_records++;
+  records[id] = {name, false, parent, depth, vexSystemHighResTimeGet(), 0, 0, 0, RUNNING};
+  open_phase[id] = -1;
+  return id;
+}
+
+/**
+ * Called before a command initializes or executes. Returns the time, to be passed to leave().
+ */
+uint64_t CommandProfiler::enter(int id)
+{
+  if (stack_depth < PROFILER_MAX_DEPTH)
+    stack[stack_depth] = id;
+  stack_depth++;
+
+  return vexSystemHighResTimeGet();
+}
+
+/**
+ * Called after a command initializes (is_tick false) or executes (is_tick true)
+ */
+void CommandProfiler::leave(int id, uint64_t enter_us, bool is_tick)
+{
+  stack_depth--;
+  if (id < 0)
+    return;
+
+  uint64_t busy = vexSystemHighResTimeGet() - enter_us;
+  records[id].busy_us += busy;
+  records[id].ticks += is_tick;
+
+  int current = open_phase[id];
+  if (current >= 0)
+  {
+    records[current].busy_us += busy;
+    records[current].ticks += is_tick;
+  }
+}
+
+/**
+ * Called when a command ends, for whatever reason
+ */
+void CommandProfiler::command_ended(int id, end_reason_t reason)
+{
+  if (id < 0)
+    return;
+
+  uint64_t now = vexSystemHighResTimeGet();
+  end_phase(id, now);
+  records[id].end_us = now;
+  records[id].reason = reason;
+}
+
+/**
+ * Called by CommandScheduler::run(), before and after every tick. The time between
+ * ticks is time the scheduler was idle (in vexDelay, or other tasks were running).
+ */
+void CommandProfiler::tick_started()
+{
+  tick_start_us = vexSystemHighResTimeGet();
+}
+
+void CommandProfiler::tick_ended()
+{
+  tick_us += vexSystemHighResTimeGet() - tick_start_us;
+  ticks++;
+}
+
+/**
+ * Record of the innermost command executing right now, or -1
+ */
+int CommandProfiler::innermost() const
+{
+  if (stack_depth <= 0 || stack_depth > PROFILER_MAX_DEPTH)
+    return -1;
+  return stack[stack_depth - 1];
+}
+
+void CommandProfiler::end_phase(int id, uint64_t now)
+{
+  int current = open_phase[id];
+  if (current < 0)
+    return;
+
+  records[current].end_us = now;
+  records[current].reason = FINISHED;
+  open_phase[id] = -1;
+}
+
+/**
+ * A record is on the critical path if its parent is, and nothing that ran alongside it
+ * under the same parent ended later (so it is what the parent was waiting on).
+ */
+bool CommandProfiler::is_critical(int id) const
+{
+  uint64_t end = records[id].end_us;
+  uint64_t start = records[id].start_us;
+
+  for (int i = 0; i < num_records; i++)
+  {
+    if (i == id || records[i].parent != records[id].parent || records[i].is_phase != records[id].is_phase)
+      continue;
+
+    bool overlaps = records[i].start_us < end && records[i].end_us > start;
+    if (overlaps && records[i].end_us > end)
+      return false;
+  }
+
+  return records[id].parent < 0 || is_critical(records[id].parent);
+}
+
+/**
+ * Append the records under (parent), each followed by its own children, to (order)
+ */
+void CommandProfiler::add_children(int parent, int *order, int *count) const
+{
+  for (int i = 0; i < num_records; i++)
+    if (records[i].parent == parent)
+    {
+      order[(*count)++] = i;
+      add_children(i, order, count);
+    }
+}
+
+/**
+ * Print the report to stdout, and a summary of the critical path to (screen) if given
+ */
+void CommandProfiler::report(vex::brain::lcd *screen)
+{
+  uint64_t end_us = stop_us != 0 ? stop_us : vexSystemHighResTimeGet();
+
+  // Anything still running is measured up to now
+  for (int i = 0; i < num_records; i++)
+    if (records[i].reason == RUNNING)
+      records[i].end_us = end_us;
+
+  printf("==== Autonomous Profile ====\n");
+  printf("  %-28s %9s %9s %9s %9s %6s  %s\n", "command", "start ms", "total ms", "busy ms", "wait ms", "ticks",
+         "end");
+
+  // List each command's children (in the order they started) right under it
+  int order[PROFILER_MAX_RECORDS];
+  int count = 0;
+  add_children(-1, order, &count);
+
+  for (int n = 0; n < count; n++)
+  {
+    int i = order[n];
+    const record_t &r = records[i];
+    uint64_t total = r.end_us - r.start_us;
+
+    char name[64];
+    snprintf(name, sizeof(name), r.is_phase ? "%*s[%s]" : "%*s%s", 2 * r.depth, "", r.name);
+
+    printf("%c %-28s %9.1f %9.1f %9.2f %9.1f %6lu  %s\n", is_critical(i) ? '*' : ' ', name, ms(r.start_us - start_us),
+           ms(total), ms(r.busy_us), ms(total - r.busy_us), (unsigned long)r.ticks, reason_names[r.reason]);
+  }
+
+  uint64_t total = end_us - start_us;
+  printf("total %.1f ms: %lu scheduler ticks took %.2f ms, %.1f ms idle between ticks\n", ms(total),
+         (unsigned long)ticks, ms(tick_us), ms(total - tick_us));
+  if (num_records >= PROFILER_MAX_RECORDS)
+    printf("(record table full; later commands were not recorded)\n");
+
+  if (screen == NULL)
+    return;
+
+  // The brain screen only fits about 11 lines, so just the critical path
+  screen->clearScreen();
+  screen->setCursor(1, 1);
+  screen->print("Auto %.2fs, critical path:", total / 1e6);
+  int lines = 1;
+  for (int n = 0; n < count && lines < 11; n++)
+  {
+    int i = order[n];
+    if (!is_critical(i))
+      continue;
+
+    screen->newLine();
+    screen->print(records[i].is_phase ? "%*s[%s] %.2fs" : "%*s%s %.2fs", 2 * records[i].depth, "", records[i].name,
+                  (records[i].end_us - records[i].start_us) / 1e6);
+    lines++;
+  }
+}
@@ -0,0 +1,433 @@
+#include "../core/include/utils/field_planner.h"
+#include <cmath>
+
+#define NUM_CELLS (FIELD_PLANNER_CELLS * FIELD_PLANNER_CELLS)
+#define DIAGONAL 1.41421356f
+
+FieldPlanner::FieldPlanner(planner_config_t &config) : config(config)
+{
+}
+
+/**
+ * Add a rectangular field element, from (x_min, y_min) to (x_max, y_max).
+ * Returns false if there are too many.
+ */
+bool FieldPlanner::add_rectangle(scalar_t x_min, scalar_t y_min, scalar_t x_max, scalar_t y_max)
+{
+  if (num_obstacles >= FIELD_PLANNER_MAX_OBSTACLES)
+    return false;
+
+  obstacle_t &o = obstacles[num_obstacles++];
+  o.round = false;
+  o.x_min = x_min < x_max ? x_min : x_max;
+  o.x_max = x_min < x_max ? x_max : x_min;
+  o.y_min = y_min < y_max ? y_min : y_max;
+  o.y_max = y_min < y_max ? y_max : y_min;
+  grid_ready = false;
+  return true;
+}
+
+/**
+ * Add a round field element at (x, y). Returns false if there are too many.
+ */
+bool FieldPlanner::add_circle(scalar_t x, scalar_t y, scalar_t radius)
+{
+  if (num_obstacles >= FIELD_PLANNER_MAX_OBSTACLES)
+    return false;
+
+  obstacle_t &o = obstacles[num_obstacles++];
+  o.round = true;
+  o.x_min = x;
+  o.y_min = y;
+  o.x_max = radius;
+  grid_ready = false;
+  return true;
+}
+
+/**
+ * Remove every field element
+ */
+void FieldPlanner::clear()
+{
+  num_obstacles = 0;
+  grid_ready = false;
+}
+
+/**
+ * Mark every cell the center of the robot can't be on: within (robot_radius) of a wall
+ * or field element
+ */
+void FieldPlanner::build_grid()
+{
+  scalar_t size = config.field_size / FIELD_PLANNER_CELLS, r = config.robot_radius;
+
+  for (int cy = 0; cy < FIELD_PLANNER_CELLS; cy++)
+  {
+    scalar_t y = (cy + (scalar_t).5) * size;
+    for (int cx = 0; cx < FIELD_PLANNER_CELLS; cx++)
+    {
+      scalar_t x = (cx + (scalar_t).5) * size;
+      bool hit = x < r || y < r || x > config.field_size - r || y > config.field_size - r;
+
+      for (int i = 0; i < num_obstacles && !hit; i++)
+      {
+        const obstacle_t &o = obstacles[i];
+        scalar_t dx, dy, reach;
+        if (o.round)
+        {
+          dx = x - o.x_min;
+          dy = y - o.y_min;
+          reach = o.x_max + r;
+        }
+        else
+        {
+          // From the nearest point of the rectangle
+          dx = x < o.x_min ? o.x_min - x : (x > o.x_max ? x - o.x_max : 0);
+          dy = y < o.y_min ? o.y_min - y : (y > o.y_max ? y - o.y_max : 0);
+          reach = r;
+        }
+        hit = dx * dx + dy * dy <= reach * reach;
+      }
+
+      blocked[cy * FIELD_PLANNER_CELLS + cx] = hit;
+    }
+  }
+
+  grid_ready = true;
+}
+
+/**
+ * The cell (x, y) is on, or the nearest one on the field
+ */
+int FieldPlanner::cell_at(scalar_t x, scalar_t y) const
+{
+  int cx = (int)std::floor(x / config.field_size * FIELD_PLANNER_CELLS);
+  int cy = (int)std::floor(y / config.field_size * FIELD_PLANNER_CELLS);
+  cx = cx < 0 ? 0 : (cx >= FIELD_PLANNER_CELLS ? FIELD_PLANNER_CELLS - 1 : cx);
+  cy = cy < 0 ? 0 : (cy >= FIELD_PLANNER_CELLS ? FIELD_PLANNER_CELLS - 1 : cy);
+  return cy * FIELD_PLANNER_CELLS + cx;
+}
+
+/**
+ * The nearest cell to (cell) that isn't blocked, searching outwards a ring at a time, or
+ * -1 if they all are
+ */
+int FieldPlanner::nearest_clear(int cell) const
+{
+  int cx = cell % FIELD_PLANNER_CELLS, cy = cell / FIELD_PLANNER_CELLS;
+  if (!blocked[cell])
+    return cell;
+
+  for (int ring = 1; ring < FIELD_PLANNER_CELLS; ring++)
+  {
+    int best = -1, best_sq = 0;
+    for (int y = cy - ring; y <= cy + ring; y++)
+    {
+      // Only the edge of the ring: every cell of the top and bottom rows, the ends of the rest
+      int step = (y == cy - ring || y == cy + ring) ? 1 : 2 * ring;
+      for (int x = cx - ring; x <= cx + ring; x += step)
+      {
+        if (x < 0 || y < 0 || x >= FIELD_PLANNER_CELLS || y >= FIELD_PLANNER_CELLS)
+          continue;
+        int c = y * FIELD_PLANNER_CELLS + x, sq = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+        if (!blocked[c] && (best < 0 || sq < best_sq))
+        {
+          best = c;
+          best_sq = sq;
+        }
+      }
+    }
+    if (best >= 0)
+      return best;
+  }
+
+  return -1;
+}
+
+/**
+ * Whether the robot can drive straight from the center of cell (from) to the center of
+ * (to) without crossing a blocked cell
+ */
+bool FieldPlanner::line_clear(int from, int to) const
+{
+  int x0 = from % FIELD_PLANNER_CELLS, y0 = from / FIELD_PLANNER_CELLS;
+  int x1 = to % FIELD_PLANNER_CELLS, y1 = to / FIELD_PLANNER_CELLS;
+  int dx = x1 - x0, dy = y1 - y0;
+
+  // Every half a cell along the line, so it can't step over the corner of one
+  int steps = 2 * ((dx < 0 ? -dx : dx) > (dy < 0 ? -dy : dy) ? (dx < 0 ? -dx : dx) : (dy < 0 ? -dy : dy));
+  for (int i = 1; i < steps; i++)
+  {
+    float t = i / (float)steps;
+    int x = (int)std::floor(x0 + .5f + dx * t), y = (int)std::floor(y0 + .5f + dy * t);
+    if (blocked[y * FIELD_PLANNER_CELLS + x])
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * Whether the robot can follow the curve a path takes from (from) to (to) without
+ * crossing a blocked cell or leaving the field
+ */
+bool FieldPlanner::curve_clear(const Waypoint &from, const Waypoint &to) const
+{
+  scalar_t size = config.field_size / FIELD_PLANNER_CELLS;
+  double chord = std::sqrt((to.x - from.x) * (to.x - from.x) + (to.y - from.y) * (to.y - from.y));
+  double dx0 = chord * std::cos(from.angle), dy0 = chord * std::sin(from.angle);
+  double dx1 = chord * std::cos(to.angle), dy1 = chord * std::sin(to.angle);
+
+  // The curve can be longer than the chord: about every third of a cell of it
+  int steps = (int)(3 * chord / size) + 2;
+  for (int i = 1; i < steps; i++)
+  {
+    double t = i / (double)steps, t2 = t * t, t3 = t2 * t;
+    double h00 = 2 * t3 - 3 * t2 + 1, h10 = t3 - 2 * t2 + t, h01 = -2 * t3 + 3 * t2, h11 = t3 - t2;
+    double x = h00 * from.x + h10 * dx0 + h01 * to.x + h11 * dx1;
+    double y = h00 * from.y + h10 * dy0 + h01 * to.y + h11 * dy1;
+    if (x < 0 || y < 0 || x > config.field_size || y > config.field_size || blocked[cell_at(x, y)])
+      return false;
+  }
+
+  return true;
+}
+
+void FieldPlanner::heap_up(int place)
+{
+  int cell = heap[place];
+  while (place > 0)
+  {
+    int up = (place - 1) / 2;
+    if (estimate[heap[up]] <= estimate[cell])
+      break;
+    heap[place] = heap[up];
+    heap_index[heap[place]] = place;
+    place = up;
+  }
+  heap[place] = cell;
+  heap_index[cell] = place;
+}
+
+void FieldPlanner::heap_down(int place)
+{
+  int cell = heap[place];
+  for (;;)
+  {
+    int down = 2 * place + 1;
+    if (down >= heap_size)
+      break;
+    if (down + 1 < heap_size && estimate[heap[down + 1]] < estimate[heap[down]])
+      down++;
+    if (estimate[heap[down]] >= estimate[cell])
+      break;
+    heap[place] = heap[down];
+    heap_index[heap[place]] = place;
+    place = down;
+  }
+  heap[place] = cell;
+  heap_index[cell] = place;
+}
+
+/**
+ * Add (cell) to the open cells, or move it up if its estimate has got better
+ */
+void FieldPlanner::heap_push(int cell)
+{
+  if (heap_index[cell] < 0)
+  {
+    heap[heap_size] = cell;
+    heap_index[cell] = heap_size++;
+  }
+  heap_up(heap_index[cell]);
+}
+
+/**
+ * Take the open cell with the lowest estimate
+ */
+int FieldPlanner::heap_pop()
+{
+  int cell = heap[0];
+  heap_index[cell] = -1;
+  if (--heap_size > 0)
+  {
+    heap[0] = heap[heap_size];
+    heap_down(0);
+  }
+  return cell;
+}
+
+/**
+ * Fill (waypoints), with room for (max_waypoints), with a way from (start) to (goal)
+ * around the field elements. The first and last waypoints are (start) and (goal)
+ * themselves. If either is too close to an element or wall, the way goes straight to or
+ * from the nearest clear spot. Returns the number of waypoints, or -1 if there's no
+ * way there or it needs more waypoints than there's room for.
+ */
+int FieldPlanner::plan(const Waypoint &start, const Waypoint &goal, Waypoint *waypoints, int max_waypoints)
+{
+  expanded = 0;
+  if (max_waypoints < 2 || config.field_size <= 0)
+    return -1;
+  if (!grid_ready)
+    build_grid();
+
+  int start_cell = nearest_clear(cell_at(start.x, start.y));
+  int goal_cell = nearest_clear(cell_at(goal.x, goal.y));
+  if (start_cell < 0 || goal_cell < 0)
+    return -1;
+
+  // A*, with the distance ignoring field elements (8 directions) as the estimate of the rest
+  int gx = goal_cell % FIELD_PLANNER_CELLS, gy = goal_cell / FIELD_PLANNER_CELLS;
+  for (int i = 0; i < NUM_CELLS; i++)
+  {
+    cost[i] = INFINITY;
+    heap_index[i] = -1;
+    closed[i] = 0;
+  }
+  heap_size = 0;
+  cost[start_cell] = 0;
+  estimate[start_cell] = 0;
+  parent[start_cell] = -1;
+  heap_push(start_cell);
+
+  bool found = false;
+  while (heap_size > 0)
+  {
+    int cell = heap_pop();
+    if (cell == goal_cell)
+    {
+      found = true;
+      break;
+    }
+    closed[cell] = 1;
+    expanded++;
+
+    int cx = cell % FIELD_PLANNER_CELLS, cy = cell / FIELD_PLANNER_CELLS;
+    for (int dy = -1; dy <= 1; dy++)
+    {
+      for (int dx = -1; dx <= 1; dx++)
+      {
+        int x = cx + dx, y = cy + dy;
+        if ((dx == 0 && dy == 0) || x < 0 || y < 0 || x >= FIELD_PLANNER_CELLS || y >= FIELD_PLANNER_CELLS)
+          continue;
+        int next = y * FIELD_PLANNER_CELLS + x;
+        if (blocked[next] || closed[next])
+          continue;
+
+        // No cutting corners on a diagonal
+        if (dx != 0 && dy != 0 && (blocked[cy * FIELD_PLANNER_CELLS + x] || blocked[y * FIELD_PLANNER_CELLS + cx]))
+          continue;
+
+        float next_cost = cost[cell] + (dx != 0 && dy != 0 ? DIAGONAL : 1);
+        if (next_cost >= cost[next])
+          continue;
+
+        int ax = x > gx ? x - gx : gx - x, ay = y > gy ? y - gy : gy - y;
+        cost[next] = next_cost;
+        estimate[next] = next_cost + (ax > ay ? ax - ay : ay - ax) + DIAGONAL * (ax < ay ? ax : ay);
+        parent[next] = cell;
+        heap_push(next);
+      }
+    }
+  }
+  if (!found)
+    return -1;
+
+  // Pull the way tight, from the goal back: each corner is the furthest cell back along
+  // it that can still see the last one
+  int length = 0;
+  for (int cell = goal_cell; cell >= 0; cell = parent[cell])
+    corners[length++] = cell;
+
+  int num_corners = 1, at = 0;
+  while (at < length - 1)
+  {
+    int next = at + 1;
+    while (next + 1 < length && line_clear(corners[at], corners[next + 1]))
+      next++;
+    corners[num_corners++] = corners[next];
+    at = next;
+  }
+
+  // Waypoints, start first: the start, any corners, and the goal, skipping any corner
+  // too close to the last waypoint to be worth a curve
+  scalar_t size = config.field_size / FIELD_PLANNER_CELLS;
+  int count = 0;
+  waypoints[count++] = start;
+  for (int i = num_corners - 1; i >= 0; i--)
+  {
+    bool is_start = i == num_corners - 1, is_goal = i == 0;
+    int cell = corners[i];
+
+    // The start and goal cells only count as corners if the robot isn't really on them
+    if ((is_start && cell == cell_at(start.x, start.y)) || (is_goal && cell == cell_at(goal.x, goal.y)))
+      continue;
+
+    scalar_t x = (cell % FIELD_PLANNER_CELLS + (scalar_t).5) * size;
+    scalar_t y = (cell / FIELD_PLANNER_CELLS + (scalar_t).5) * size;
+    const Waypoint &last = waypoints[count - 1];
+    if ((x - last.x) * (x - last.x) + (y - last.y) * (y - last.y) < size * size)
+      continue;
+
+    if (count >= max_waypoints - 1)
+      return -1;
+    waypoints[count].x = x;
+    waypoints[count].y = y;
+    count++;
+  }
+
+  // A corner too close to the goal gives way to it
+  const Waypoint &last = waypoints[count - 1];
+  if (count > 1 && (goal.x - last.x) * (goal.x - last.x) + (goal.y - last.y) * (goal.y - last.y) < size * size)
+    count--;
+  waypoints[count++] = goal;
+
+  // Each corner faces along the way through it
+  for (int i = 1; i < count - 1; i++)
+    waypoints[i].angle = std::atan2(waypoints[i + 1].y - waypoints[i - 1].y, waypoints[i + 1].x - waypoints[i - 1].x);
+
+  // Where a curve swings out over something, split the straight line under it (which is
+  // clear) with a waypoint facing along it, until the curves stay on it or get shorter than
+  // a cell. A start or goal off the clear cells can't have a clear curve, so isn't checked.
+  for (int i = 0; i < count - 1;)
+  {
+    Waypoint &a = waypoints[i], &b = waypoints[i + 1];
+    scalar_t dx = b.x - a.x, dy = b.y - a.y;
+    if (!is_clear(a.x, a.y) || !is_clear(b.x, b.y) || dx * dx + dy * dy < size * size || curve_clear(a, b))
+    {
+      i++;
+      continue;
+    }
+
+    if (count >= max_waypoints)
+      return -1;
+    for (int j = count; j > i + 1; j--)
+      waypoints[j] = waypoints[j - 1];
+    waypoints[i + 1].x = a.x + dx / 2;
+    waypoints[i + 1].y = a.y + dy / 2;
+    waypoints[i + 1].angle = std::atan2(dy, dx);
+    count++;
+  }
+
+  return count;
+}
+
+/**
+ * Whether the center of the robot can be at (x, y) without touching anything
+ */
+bool FieldPlanner::is_clear(scalar_t x, scalar_t y)
+{
+  if (!grid_ready)
+    build_grid();
+
+  return x >= 0 && y >= 0 && x <= config.field_size && y <= config.field_size && !blocked[cell_at(x, y)];
+}
+
+/**
+ * Cells the last plan() looked at, for judging how hard it was
+ */
+int FieldPlanner::get_expanded() const
+{
+  return expanded;
+}
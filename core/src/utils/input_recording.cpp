@@ -0,0 +1,318 @@
+#include "../core/include/utils/input_recording.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+void put16(uint8_t *p, uint16_t value)
+{
+  p[0] = value & 0xff;
+  p[1] = value >> 8;
+}
+
+void put32(uint8_t *p, uint32_t value)
+{
+  put16(p, value & 0xffff);
+  put16(p + 2, value >> 16);
+}
+
+uint16_t get16(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+uint32_t get32(const uint8_t *p)
+{
+  return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+scalar_t wrap_degrees(scalar_t deg)
+{
+  deg = std::fmod(deg, (scalar_t)360);
+  if (deg > 180)
+    deg -= 360;
+  else if (deg < -180)
+    deg += 360;
+  return deg;
+}
+
+scalar_t clamp(scalar_t value, scalar_t lower, scalar_t upper)
+{
+  return value < lower ? lower : (value > upper ? upper : value);
+}
+} // namespace
+
+/**
+ * Create a recording with room for (max_frames) frames, sampled every (period_ms).
+ * The buffer is allocated once, here.
+ */
+InputRecording::InputRecording(uint32_t max_frames, uint32_t period_ms)
+    : max_frames(max_frames), period_ms(period_ms)
+{
+  buffer = (uint8_t *)malloc(INPUT_RECORDING_HEADER_BYTES + max_frames * INPUT_RECORDING_FRAME_BYTES);
+  if (buffer == NULL)
+    this->max_frames = 0;
+}
+
+InputRecording::~InputRecording()
+{
+  stop_recording();
+  free(buffer);
+}
+
+/**
+ * Read the controller's axes and buttons into a frame
+ */
+InputRecording::frame_t InputRecording::sample(vex::controller &controller)
+{
+  frame_t frame;
+  frame.axis[0] = (int8_t)controller.Axis1.position();
+  frame.axis[1] = (int8_t)controller.Axis2.position();
+  frame.axis[2] = (int8_t)controller.Axis3.position();
+  frame.axis[3] = (int8_t)controller.Axis4.position();
+
+  frame.buttons = (controller.ButtonA.pressing() ? BUTTON_A : 0) | (controller.ButtonB.pressing() ? BUTTON_B : 0)
+                | (controller.ButtonX.pressing() ? BUTTON_X : 0) | (controller.ButtonY.pressing() ? BUTTON_Y : 0)
+                | (controller.ButtonUp.pressing() ? BUTTON_UP : 0) | (controller.ButtonDown.pressing() ? BUTTON_DOWN : 0)
+                | (controller.ButtonLeft.pressing() ? BUTTON_LEFT : 0) | (controller.ButtonRight.pressing() ? BUTTON_RIGHT : 0)
+                | (controller.ButtonL1.pressing() ? BUTTON_L1 : 0) | (controller.ButtonL2.pressing() ? BUTTON_L2 : 0)
+                | (controller.ButtonR1.pressing() ? BUTTON_R1 : 0) | (controller.ButtonR2.pressing() ? BUTTON_R2 : 0);
+
+  frame.heading_deg = 0;
+  frame.distance_in = 0;
+  return frame;
+}
+
+/**
+ * Clear the recording and start sampling (controller), and (sensors) if given, in a
+ * background task until stop_recording() is called or the buffer is full.
+ */
+void InputRecording::start_recording(vex::controller &controller, Sensors *sensors)
+{
+  if (recording)
+    return;
+
+  // A recording that filled the buffer may still have its task on the way out
+  while (task_running)
+    vexDelay(1);
+
+  this->controller = &controller;
+  this->sensors = sensors;
+  num_frames = 0;
+  sensors_recorded = sensors != NULL;
+
+  if (sensors != NULL)
+    sensors->reset();
+
+  recording = true;
+  task_running = true;
+  vex::task recorder(record_task, this);
+}
+
+/**
+ * Stop a recording started with start_recording(), waiting (up to a frame) for the
+ * background task to finish
+ */
+void InputRecording::stop_recording()
+{
+  recording = false;
+  while (task_running)
+    vexDelay(1);
+}
+
+bool InputRecording::is_recording() const
+{
+  return recording;
+}
+
+/**
+ * Samples at a fixed rate: each frame is due (period_ms) after the previous one was due,
+ * rather than after it was taken, so time spent sampling doesn't add up.
+ */
+int InputRecording::record_task(void *arg)
+{
+  InputRecording *self = (InputRecording *)arg;
+  uint32_t next_ms = vexSystemTimeGet();
+
+  while (self->recording && self->num_frames < self->max_frames)
+  {
+    frame_t frame = sample(*self->controller);
+    if (self->sensors != NULL)
+      self->sensors->read(&frame.heading_deg, &frame.distance_in);
+    self->append(frame);
+
+    next_ms += self->period_ms;
+    int32_t wait_ms = (int32_t)(next_ms - vexSystemTimeGet());
+    vexDelay(wait_ms > 0 ? wait_ms : 0);
+  }
+
+  self->recording = false;
+  self->task_running = false;
+  return 0;
+}
+
+void InputRecording::append(const frame_t &frame)
+{
+  uint8_t *p = buffer + INPUT_RECORDING_HEADER_BYTES + num_frames * INPUT_RECORDING_FRAME_BYTES;
+  memcpy(p, frame.axis, 4);
+  put16(p + 4, frame.buttons);
+  put16(p + 6, (uint16_t)(int16_t)(wrap_degrees(frame.heading_deg) * 100));
+  put16(p + 8, (uint16_t)clamp(frame.distance_in * 10, 0, 65535));
+  num_frames++;
+}
+
+/**
+ * Number of frames recorded / loaded
+ */
+uint32_t InputRecording::size() const
+{
+  return num_frames;
+}
+
+uint32_t InputRecording::get_period_ms() const
+{
+  return period_ms;
+}
+
+/**
+ * Whether the frames include heading / distance
+ */
+bool InputRecording::has_sensors() const
+{
+  return sensors_recorded;
+}
+
+/**
+ * Get frame (index), 0 -> size() - 1
+ */
+InputRecording::frame_t InputRecording::get(uint32_t index) const
+{
+  const uint8_t *p = buffer + INPUT_RECORDING_HEADER_BYTES + index * INPUT_RECORDING_FRAME_BYTES;
+
+  frame_t frame;
+  memcpy(frame.axis, p, 4);
+  frame.buttons = get16(p + 4);
+  frame.heading_deg = (int16_t)get16(p + 6) / (scalar_t)100;
+  frame.distance_in = get16(p + 8) / (scalar_t)10;
+  return frame;
+}
+
+/**
+ * Write the recording to (filename) on the SD card. Returns false if it couldn't.
+ */
+bool InputRecording::save(vex::brain::sdcard &sd, const char *filename)
+{
+  if (!sd.isInserted() || buffer == NULL)
+    return false;
+
+  put32(buffer, INPUT_RECORDING_MAGIC);
+  put16(buffer + 4, INPUT_RECORDING_VERSION);
+  put16(buffer + 6, sensors_recorded ? 1 : 0);
+  put32(buffer + 8, period_ms);
+  put32(buffer + 12, num_frames);
+
+  int32_t len = INPUT_RECORDING_HEADER_BYTES + num_frames * INPUT_RECORDING_FRAME_BYTES;
+  return sd.savefile(filename, buffer, len) == len;
+}
+
+/**
+ * Replace the recording with the one in (filename) on the SD card. Returns false,
+ * leaving the recording empty, if the file is missing, damaged or too big.
+ */
+bool InputRecording::load(vex::brain::sdcard &sd, const char *filename)
+{
+  num_frames = 0;
+  if (!sd.isInserted() || !sd.exists(filename) || buffer == NULL)
+    return false;
+
+  int32_t capacity = INPUT_RECORDING_HEADER_BYTES + max_frames * INPUT_RECORDING_FRAME_BYTES;
+  int32_t len = sd.loadfile(filename, buffer, capacity);
+  if (len < INPUT_RECORDING_HEADER_BYTES || get32(buffer) != INPUT_RECORDING_MAGIC
+      || get16(buffer + 4) != INPUT_RECORDING_VERSION)
+  {
+    fprintf(stderr, "InputRecording: %s is not a recording\n", filename);
+    return false;
+  }
+
+  uint32_t frames = get32(buffer + 12);
+  if (frames > max_frames || len != (int32_t)(INPUT_RECORDING_HEADER_BYTES + frames * INPUT_RECORDING_FRAME_BYTES))
+  {
+    fprintf(stderr, "InputRecording: %s is truncated or too long\n", filename);
+    return false;
+  }
+
+  sensors_recorded = (get16(buffer + 6) & 1) != 0;
+  period_ms = get32(buffer + 8);
+  num_frames = frames;
+  return true;
+}
+
+ReplayCommand::ReplayCommand(InputRecording &recording, void (*drive)(const InputRecording::frame_t &))
+    : recording(recording), drive(drive)
+{
+  name = "replay";
+}
+
+/**
+ * Correct the replay against the recorded traces: (heading_gain) percent of rotation
+ * (Axis1) per degree of heading error, and (distance_gain) extra fraction of lateral
+ * speed (Axis3, Axis4) per inch the robot is behind or ahead of the recording.
+ * Only used if the recording was made with sensors.
+ */
+ReplayCommand &ReplayCommand::with_correction(InputRecording::Sensors &sensors, scalar_t heading_gain,
+                                              scalar_t distance_gain)
+{
+  this->sensors = &sensors;
+  this->heading_gain = heading_gain;
+  this->distance_gain = distance_gain;
+  return *this;
+}
+
+void ReplayCommand::initialize()
+{
+  start_ms = vexSystemTimeGet();
+  done = false;
+
+  if (sensors != NULL)
+    sensors->reset();
+}
+
+void ReplayCommand::execute()
+{
+  uint32_t index = (vexSystemTimeGet() - start_ms) / recording.get_period_ms();
+  if (index >= recording.size())
+  {
+    done = true;
+    return;
+  }
+
+  InputRecording::frame_t frame = recording.get(index);
+
+  if (sensors != NULL && recording.has_sensors())
+  {
+    scalar_t heading, distance;
+    sensors->read(&heading, &distance);
+
+    // Turn towards the recorded heading, and speed up / slow down to match the recorded distance
+    scalar_t rotation = frame.axis[0] + heading_gain * wrap_degrees(frame.heading_deg - heading);
+    scalar_t lateral_scale = clamp(1 + distance_gain * (frame.distance_in - distance), 0, 2);
+
+    frame.axis[0] = (int8_t)clamp(rotation, -100, 100);
+    frame.axis[2] = (int8_t)clamp(frame.axis[2] * lateral_scale, -100, 100);
+    frame.axis[3] = (int8_t)clamp(frame.axis[3] * lateral_scale, -100, 100);
+  }
+
+  drive(frame);
+}
+
+void ReplayCommand::end(bool interrupted)
+{
+  // Let go of the sticks
+  InputRecording::frame_t stop = {{0, 0, 0, 0}, 0, 0, 0};
+  drive(stop);
+}
+
+bool ReplayCommand::is_finished()
+{
+  return done;
+}
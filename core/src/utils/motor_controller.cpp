@@ -0,0 +1,303 @@
+#include "../core/include/utils/motor_controller.h"
+
+MotorController *MotorController::controllers[MOTOR_CONTROLLER_MAX];
+int MotorController::num_controllers = 0;
+bool MotorController::task_started = false;
+
+namespace
+{
+scalar_t clamp(scalar_t value, scalar_t limit)
+{
+  return value > limit ? limit : (value < -limit ? -limit : value);
+}
+
+scalar_t sign(scalar_t value)
+{
+  return value > 0 ? 1 : (value < 0 ? -1 : 0);
+}
+} // namespace
+
+/**
+ * Control (motor) / (motors), outputting through (compensation)
+ */
+MotorController::MotorController(vex::motor &motor, config_t &config, BatteryCompensation &compensation)
+    : motor(&motor), motors(NULL), config(config), compensation(compensation)
+{
+  add_to_task();
+}
+
+MotorController::MotorController(vex::motor_group &motors, config_t &config, BatteryCompensation &compensation)
+    : motor(NULL), motors(&motors), config(config), compensation(compensation)
+{
+  add_to_task();
+}
+
+/**
+ * Stop the background task updating it, and free its observer. The motor is left as it was.
+ */
+MotorController::~MotorController()
+{
+  controllers_lock().lock();
+  for (int i = 0; i < num_controllers; i++)
+  {
+    if (controllers[i] != this)
+      continue;
+
+    for (int j = i + 1; j < num_controllers; j++)
+      controllers[j - 1] = controllers[j];
+    num_controllers--;
+    break;
+  }
+  controllers_lock().unlock();
+
+  delete observer;
+}
+
+/**
+ * Held while the controllers are changed or updated. Made on first use, since global
+ * controllers in other files can be made before this file's globals are.
+ */
+vex::mutex &MotorController::controllers_lock()
+{
+  static vex::mutex lock;
+  return lock;
+}
+
+void MotorController::add_to_task()
+{
+  controllers_lock().lock();
+  if (num_controllers < MOTOR_CONTROLLER_MAX)
+    controllers[num_controllers++] = this;
+  else
+    fprintf(stderr, "MotorController: more than %d controllers, this one won't run\n", MOTOR_CONTROLLER_MAX);
+  controllers_lock().unlock();
+}
+
+/**
+ * Run at (rpm), and (accel_rpm_s) if the setpoint is changing, e.g. from a motion
+ * profile. The setpoint keeps following (accel_rpm_s) until the next call.
+ */
+void MotorController::set_velocity(scalar_t rpm, scalar_t accel_rpm_s)
+{
+  if (mode != VELOCITY)
+    integral = 0;
+
+  target_rpm = rpm;
+  target_accel = accel_rpm_s;
+  mode = VELOCITY;
+  start_task();
+}
+
+/**
+ * Run at (percent) (-1.0 -> 1.0) of the configured max_rpm
+ */
+void MotorController::set_speed(scalar_t percent)
+{
+  set_velocity(percent * config.max_rpm);
+}
+
+/**
+ * Move to (degrees) of motor rotation, no faster than (max_rpm), or the configured
+ * max_rpm if not given
+ */
+void MotorController::set_position(scalar_t degrees, scalar_t max_rpm)
+{
+  if (mode != POSITION)
+    integral = 0;
+
+  target_deg = degrees;
+  max_position_rpm = std::fabs(max_rpm);
+  mode = POSITION;
+  start_task();
+}
+
+void MotorController::set_position(scalar_t degrees)
+{
+  set_position(degrees, config.max_rpm);
+}
+
+/**
+ * Stop controlling, and stop the motor with its brake mode
+ */
+void MotorController::stop()
+{
+  mode = STOPPED;
+  integral = 0;
+  output_volts = 0;
+
+  if (motor != NULL)
+    motor->stop();
+  else
+    motors->stop();
+}
+
+/**
+ * Reverse the motor (setReversed), which the controller assumes is off when it's made.
+ * The motor's readings change sign with it, so the loop's state is flipped to match
+ * instead of seeing a jump.
+ */
+void MotorController::set_reversed(bool reversed)
+{
+  if (reversed == this->reversed)
+    return;
+
+  controllers_lock().lock();
+  this->reversed = reversed;
+  if (motor != NULL)
+    motor->setReversed(reversed);
+  else
+    motors->setReversed(reversed);
+
+  target_rpm = -target_rpm;
+  target_accel = -target_accel;
+  target_deg = -target_deg;
+  integral = -integral;
+  if (observer != NULL)
+    observer->negate();
+  controllers_lock().unlock();
+}
+
+/**
+ * Take velocity and position from an observer fed the encoder every loop (see
+ * state_observer.h), in degrees, instead of the motor's own velocity, which is filtered
+ * with a lag and stepped. Set it before the controller is first commanded.
+ */
+void MotorController::set_observer(StateObserver::observer_config_t &config)
+{
+  controllers_lock().lock();
+  if (observer != NULL)
+    delete observer;
+
+  observer = new StateObserver(config);
+  controllers_lock().unlock();
+}
+
+/**
+ * Velocity (rpm) and position (degrees), from the observer if there is one
+ */
+scalar_t MotorController::get_velocity()
+{
+  if (observer != NULL)
+    return observer->get_velocity() / 6; // deg/s to rpm
+
+  return read_velocity();
+}
+
+scalar_t MotorController::get_position()
+{
+  if (observer != NULL)
+    return observer->get_position();
+
+  return read_position();
+}
+
+scalar_t MotorController::read_velocity()
+{
+  return motor != NULL ? (scalar_t)motor->velocity(vex::velocityUnits::rpm)
+                       : (scalar_t)motors->velocity(vex::velocityUnits::rpm);
+}
+
+scalar_t MotorController::read_position()
+{
+  return motor != NULL ? (scalar_t)motor->position(vex::rotationUnits::deg)
+                       : (scalar_t)motors->position(vex::rotationUnits::deg);
+}
+
+scalar_t MotorController::get_max_rpm() const
+{
+  return config.max_rpm;
+}
+
+/**
+ * Volts the loop asked for on its last update
+ */
+scalar_t MotorController::get_output_volts() const
+{
+  return output_volts;
+}
+
+/**
+ * One iteration of the loop, (dt) seconds after the last. Called by the background task.
+ */
+void MotorController::update(scalar_t dt)
+{
+  // Keep the observer tracking even while stopped, so it's settled when control starts
+  if (observer != NULL)
+    observer->update(read_position(), dt);
+
+  if (mode == STOPPED)
+    return;
+
+  scalar_t setpoint, accel;
+  if (mode == VELOCITY)
+  {
+    target_rpm += target_accel * dt;
+    setpoint = target_rpm;
+    accel = target_accel;
+  }
+  else
+  {
+    // Position: a P loop on position picks the velocity, the velocity loop follows it
+    setpoint = clamp(config.position_p * (target_deg - get_position()), max_position_rpm);
+    accel = 0;
+  }
+
+  scalar_t error = setpoint - get_velocity();
+  scalar_t volts = config.ks * sign(setpoint) + config.kv * setpoint + config.ka * accel + config.kp * error
+                 + config.ki * integral;
+
+  // Only integrate while the output isn't saturated, so the integral can't wind up
+  scalar_t limit = compensation.get_nominal_voltage();
+  if (std::fabs(volts) < limit)
+    integral += error * dt;
+
+  output(clamp(volts, limit));
+}
+
+void MotorController::output(scalar_t volts)
+{
+  output_volts = volts;
+  scalar_t command = compensation.command_for(volts);
+
+  if (motor != NULL)
+    motor->spin(vex::directionType::fwd, command, vex::voltageUnits::volt);
+  else
+    motors->spin(vex::directionType::fwd, command, vex::voltageUnits::volt);
+}
+
+void MotorController::start_task()
+{
+  if (task_started)
+    return;
+
+  task_started = true;
+  vex::task controller_task(control_task);
+}
+
+/**
+ * Updates every controller at a fixed rate, each due MOTOR_CONTROLLER_PERIOD_MS after
+ * the last was due.
+ */
+int MotorController::control_task()
+{
+  uint64_t last_us = vexSystemHighResTimeGet();
+  uint32_t next_ms = vexSystemTimeGet();
+
+  while (true)
+  {
+    uint64_t now_us = vexSystemHighResTimeGet();
+    scalar_t dt = (now_us - last_us) / (scalar_t)1e6;
+    last_us = now_us;
+
+    controllers_lock().lock();
+    for (int i = 0; i < num_controllers; i++)
+      controllers[i]->update(dt);
+    controllers_lock().unlock();
+
+    next_ms += MOTOR_CONTROLLER_PERIOD_MS;
+    int32_t wait_ms = (int32_t)(next_ms - vexSystemTimeGet());
+    vexDelay(wait_ms > 0 ? wait_ms : 0);
+  }
+
+  return 0;
+}
@@ -7,23 +7,41 @@ PID::PID(pid_config_t &config)
     : config(config)
 {
   pid_timer.reset();
+
+  if (config.observer != NULL)
+    set_observer(*config.observer);
+}
+
+PID::~PID()
+{
+  delete observer;
 }
 
 /**
    * Update the PID loop by taking the time difference from last update,
    * and running the PID formula with the new sensor data
    */
-void PID::update(double sensor_val)
+void PID::update(scalar_t sensor_val)
 {
   this->sensor_val = sensor_val;
 
-  double time_delta = pid_timer.value() - last_time;
+  scalar_t now = pid_timer.value();
+  scalar_t time_delta = now - last_time;
 
   accum_error += time_delta * get_error();
 
-  out = (config.f) + (config.p * get_error()) + (config.i * accum_error) + (config.d * (get_error() - last_error) / time_delta);
+  scalar_t derivative;
+  if (observer != NULL)
+  {
+    observer->update(get_error(), time_delta);
+    derivative = observer->get_velocity();
+  }
+  else
+    derivative = (get_error() - last_error) / time_delta;
+
+  out = (config.f) + (config.p * get_error()) + (config.i * accum_error) + (config.d * derivative);
 
-  last_time = pid_timer.value();
+  last_time = now;
   last_error = get_error();
 
   if (lower_limit != 0 || upper_limit != 0)
@@ -43,12 +61,15 @@ void PID::reset()
 
   is_checking_on_target = false;
   on_target_last_time = 0;
+
+  if (observer != NULL)
+    observer->reset();
 }
 
 /**
    * Gets the current PID out value, from when update() was last run
    */
-double PID::get()
+scalar_t PID::get()
 {
   return out;
 }
@@ -56,7 +77,7 @@ double PID::get()
 /**
    * Get the delta between the current sensor data and the target
    */
-double PID::get_error()
+scalar_t PID::get_error()
 {
   return target - sensor_val;
 }
@@ -64,7 +85,7 @@ double PID::get_error()
 /**
    * Set the target for the PID loop, where the robot is trying to end up
    */
-void PID::set_target(double target)
+void PID::set_target(scalar_t target)
 {
   this->target = target;
 }
@@ -73,7 +94,7 @@ void PID::set_target(double target)
    * Set the limits on the PID out. The PID out will "clip" itself to be 
    * between the limits.
    */
-void PID::set_limits(double lower, double upper)
+void PID::set_limits(scalar_t lower, scalar_t upper)
 {
   lower_limit = lower;
   upper_limit = upper;
@@ -85,7 +106,7 @@ void PID::set_limits(double lower, double upper)
    */
 bool PID::is_on_target()
 {
-  if (fabs(get_error()) < config.deadband)
+  if (std::fabs(get_error()) < config.deadband)
   {
     if (is_checking_on_target == false)
     {
@@ -103,4 +124,16 @@ bool PID::is_on_target()
   }
 
   return false;
+}
+
+/**
+ * Take the derivative term from an observer fed the error (see state_observer.h),
+ * instead of differencing the error, which is noisy at fast loop rates
+ */
+void PID::set_observer(StateObserver::observer_config_t &config)
+{
+  if (observer != NULL)
+    delete observer;
+
+  observer = new StateObserver(config);
 }
\ No newline at end of file
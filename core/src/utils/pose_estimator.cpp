@@ -0,0 +1,283 @@
+#include "../core/include/utils/pose_estimator.h"
+#include <cmath>
+#include <string.h>
+
+#define ESTIMATOR_PI 3.141592654
+
+// Process noise on position and heading themselves, so their variance never collapses
+#define POSITION_NOISE 1e-4
+#define HEADING_NOISE 1e-6
+
+namespace
+{
+scalar_t wrap_radians(scalar_t angle)
+{
+  while (angle > ESTIMATOR_PI)
+    angle -= 2 * ESTIMATOR_PI;
+  while (angle < -ESTIMATOR_PI)
+    angle += 2 * ESTIMATOR_PI;
+  return angle;
+}
+} // namespace
+
+PoseEstimator::PoseEstimator(estimator_config_t &config) : config(config)
+{
+  state_t origin = {0, 0, 0, 0, 0, 0};
+  reset(origin, 0);
+}
+
+/**
+ * Start over, certain the robot is in (state) at (time_ms)
+ */
+void PoseEstimator::reset(const state_t &start, uint32_t time_ms)
+{
+  state[X] = start.x;
+  state[Y] = start.y;
+  state[HEADING] = start.heading;
+  state[FORWARD] = start.forward;
+  state[LEFT] = start.left;
+  state[OMEGA] = start.omega;
+  memset(cov, 0, sizeof(cov));
+
+  newest = 0;
+  num_steps = 1;
+  dropped = 0;
+  slipping = false;
+
+  step_t &step = history[0];
+  step.time_ms = time_ms;
+  step.dt = step.accel_forward = step.accel_left = 0;
+  memcpy(step.prior, state, sizeof(state));
+  memcpy(step.prior_cov, cov, sizeof(cov));
+  step.num_measurements = 0;
+}
+
+/**
+ * Move the state and its covariance (dt) seconds forward. The speeds are in the robot's
+ * frame, which turns with it, so the accelerometer's reading is the change in speed
+ * plus the turning term.
+ */
+void PoseEstimator::propagate(scalar_t dt, scalar_t accel_forward, scalar_t accel_left)
+{
+  scalar_t c = std::cos(state[HEADING]), s = std::sin(state[HEADING]);
+  scalar_t forward = state[FORWARD], left = state[LEFT], omega = state[OMEGA];
+
+  state[X] += (c * forward - s * left) * dt;
+  state[Y] += (s * forward + c * left) * dt;
+  state[HEADING] += omega * dt;
+  state[FORWARD] += (accel_forward + omega * left) * dt;
+  state[LEFT] += (accel_left - omega * forward) * dt;
+
+  // Jacobian of the step above
+  scalar_t f[N][N] = {};
+  for (int i = 0; i < N; i++)
+    f[i][i] = 1;
+  f[X][HEADING] = (-s * forward - c * left) * dt;
+  f[X][FORWARD] = c * dt;
+  f[X][LEFT] = -s * dt;
+  f[Y][HEADING] = (c * forward - s * left) * dt;
+  f[Y][FORWARD] = s * dt;
+  f[Y][LEFT] = c * dt;
+  f[HEADING][OMEGA] = dt;
+  f[FORWARD][LEFT] = omega * dt;
+  f[FORWARD][OMEGA] = left * dt;
+  f[LEFT][FORWARD] = -omega * dt;
+  f[LEFT][OMEGA] = -forward * dt;
+
+  // cov = F cov F^T + Q
+  scalar_t fp[N][N];
+  for (int i = 0; i < N; i++)
+    for (int j = 0; j < N; j++)
+    {
+      scalar_t sum = 0;
+      for (int k = 0; k < N; k++)
+        sum += f[i][k] * cov[k][j];
+      fp[i][j] = sum;
+    }
+
+  for (int i = 0; i < N; i++)
+    for (int j = 0; j < N; j++)
+    {
+      scalar_t sum = 0;
+      for (int k = 0; k < N; k++)
+        sum += fp[i][k] * f[j][k];
+      cov[i][j] = sum;
+    }
+
+  scalar_t accel_var = config.accel_noise * dt * config.accel_noise * dt;
+  cov[X][X] += POSITION_NOISE * dt;
+  cov[Y][Y] += POSITION_NOISE * dt;
+  cov[HEADING][HEADING] += HEADING_NOISE * dt;
+  cov[FORWARD][FORWARD] += accel_var;
+  cov[LEFT][LEFT] += accel_var;
+  cov[OMEGA][OMEGA] += config.yaw_accel_noise * dt * config.yaw_accel_noise * dt;
+}
+
+/**
+ * Fuse one measurement of one state. With H a single 1, the Kalman gain is just that
+ * state's column of the covariance over the innovation variance.
+ */
+void PoseEstimator::correct(const measurement_t &m)
+{
+  scalar_t innovation = m.value - state[m.index];
+  if (m.index == HEADING)
+    innovation = wrap_radians(innovation);
+
+  scalar_t variance = cov[m.index][m.index] + m.variance;
+  if (variance <= 0)
+    return;
+
+  // Too far from what the IMU says for noise: a wheel slipping or the robot being pushed
+  if (m.gate > 0)
+  {
+    slipping = innovation * innovation > m.gate * m.gate * variance;
+    if (slipping)
+      return;
+  }
+
+  scalar_t gain[N], row[N];
+  for (int i = 0; i < N; i++)
+  {
+    gain[i] = cov[i][m.index] / variance;
+    row[i] = cov[m.index][i];
+  }
+
+  for (int i = 0; i < N; i++)
+  {
+    state[i] += gain[i] * innovation;
+    for (int j = 0; j < N; j++)
+      cov[i][j] -= gain[i] * row[j];
+  }
+}
+
+/**
+ * Step the estimate forward to (time_ms), with the robot accelerating at
+ * (accel_forward), (accel_left) in/s^2 as measured by the IMU. Call it every loop.
+ */
+void PoseEstimator::predict(uint32_t time_ms, scalar_t accel_forward, scalar_t accel_left)
+{
+  int32_t elapsed_ms = (int32_t)(time_ms - history[newest].time_ms);
+  if (elapsed_ms <= 0)
+    return;
+
+  scalar_t dt = elapsed_ms / (scalar_t)1000;
+  propagate(dt, accel_forward, accel_left);
+
+  newest = (newest + 1) % POSE_ESTIMATOR_HISTORY;
+  if (num_steps < POSE_ESTIMATOR_HISTORY)
+    num_steps++;
+
+  step_t &step = history[newest];
+  step.time_ms = time_ms;
+  step.dt = dt;
+  step.accel_forward = accel_forward;
+  step.accel_left = accel_left;
+  memcpy(step.prior, state, sizeof(state));
+  memcpy(step.prior_cov, cov, sizeof(cov));
+  step.num_measurements = 0;
+}
+
+/**
+ * Fuse a measurement at the step it was taken in. If that's not the latest one, go back
+ * to it and replay the steps since, with their inputs and measurements.
+ */
+void PoseEstimator::add_measurement(uint32_t time_ms, int index, scalar_t value, scalar_t stddev, scalar_t gate)
+{
+  measurement_t m = {index, value, stddev * stddev, gate};
+
+  // Newest step at or before the measurement
+  int age = 0;
+  while (age < num_steps &&
+         (int32_t)(time_ms - history[(newest - age + POSE_ESTIMATOR_HISTORY) % POSE_ESTIMATOR_HISTORY].time_ms) < 0)
+    age++;
+
+  int at = (newest - age + POSE_ESTIMATOR_HISTORY) % POSE_ESTIMATOR_HISTORY;
+  if (age >= num_steps || history[at].num_measurements >= POSE_ESTIMATOR_MAX_MEASUREMENTS)
+  {
+    dropped++;
+    return;
+  }
+
+  step_t &step = history[at];
+  step.measurements[step.num_measurements++] = m;
+
+  if (age == 0)
+  {
+    correct(m);
+    return;
+  }
+
+  // Replay from the step the measurement belongs to
+  memcpy(state, step.prior, sizeof(state));
+  memcpy(cov, step.prior_cov, sizeof(cov));
+  for (int i = 0; i < step.num_measurements; i++)
+    correct(step.measurements[i]);
+
+  for (int a = age - 1; a >= 0; a--)
+  {
+    step_t &later = history[(newest - a + POSE_ESTIMATOR_HISTORY) % POSE_ESTIMATOR_HISTORY];
+    propagate(later.dt, later.accel_forward, later.accel_left);
+    memcpy(later.prior, state, sizeof(state));
+    memcpy(later.prior_cov, cov, sizeof(cov));
+    for (int i = 0; i < later.num_measurements; i++)
+      correct(later.measurements[i]);
+  }
+}
+
+/**
+ * Wheel speeds (inches/s, robot frame) as they were at (time_ms)
+ */
+void PoseEstimator::add_odometry(uint32_t time_ms, scalar_t forward, scalar_t left)
+{
+  add_measurement(time_ms, FORWARD, forward, config.odometry_noise, config.slip_gate);
+  add_measurement(time_ms, LEFT, left, config.odometry_noise, config.slip_gate);
+}
+
+/**
+ * IMU heading (radians, counter-clockwise) as it was at (time_ms)
+ */
+void PoseEstimator::add_heading(uint32_t time_ms, scalar_t heading)
+{
+  add_measurement(time_ms, HEADING, heading, config.heading_noise, 0);
+}
+
+/**
+ * IMU turn rate (radians/s, counter-clockwise) as it was at (time_ms)
+ */
+void PoseEstimator::add_yaw_rate(uint32_t time_ms, scalar_t omega)
+{
+  add_measurement(time_ms, OMEGA, omega, config.yaw_rate_noise, 0);
+}
+
+/**
+ * The estimate as of the last predict()
+ */
+PoseEstimator::state_t PoseEstimator::get_state() const
+{
+  state_t out = {state[X], state[Y], state[HEADING], state[FORWARD], state[LEFT], state[OMEGA]};
+  return out;
+}
+
+/**
+ * Standard deviation of the position estimate, inches
+ */
+scalar_t PoseEstimator::get_position_error() const
+{
+  return std::sqrt(cov[X][X] + cov[Y][Y]);
+}
+
+/**
+ * Measurements older than the history, which were dropped
+ */
+int PoseEstimator::get_dropped() const
+{
+  return dropped;
+}
+
+/**
+ * Whether the latest wheel speed was ignored as slip
+ */
+bool PoseEstimator::is_slipping() const
+{
+  return slipping;
+}
@@ -0,0 +1,159 @@
+#include "../core/include/utils/power_manager.h"
+
+// Steering always gets at least this share of the budget, however well aligned
+#define STEERING_MIN_SHARE 0.25
+
+// Never scale output below this, so the robot can always still move
+#define MIN_SCALE 0.1
+#define MIN_BUDGET_FRACTION 0.25
+
+// How fast a scaled-down side gets its output back, per second
+#define SCALE_RECOVERY_PER_S 2.0
+
+namespace
+{
+scalar_t clamp(scalar_t value, scalar_t lower, scalar_t upper)
+{
+  return value < lower ? lower : (value > upper ? upper : value);
+}
+} // namespace
+
+PowerManager::PowerManager(vex::brain::battery &battery, power_config_t &config)
+    : battery(battery), config(config)
+{
+}
+
+/**
+ * Manage a module's motors. Returns the module's index for drive_output() and
+ * steering_scale(), or -1 if there are too many.
+ */
+int PowerManager::add_module(vex::motor &drive, vex::motor &direction)
+{
+  if (num_modules >= POWER_MANAGER_MAX_MODULES)
+    return -1;
+
+  module_t &module = modules[num_modules];
+  module.drive = &drive;
+  module.direction = &direction;
+  module.last_output = 0;
+  module.last_output_ms = vexSystemTimeGet();
+  module.alignment_error = 0;
+  return num_modules++;
+}
+
+/**
+ * Re-measure and re-share the budget, at most every POWER_MANAGER_PERIOD_MS however
+ * many modules ask
+ */
+void PowerManager::update()
+{
+  uint32_t now = vexSystemTimeGet();
+  if (updated && now - last_update_ms < POWER_MANAGER_PERIOD_MS)
+    return;
+
+  scalar_t dt = updated ? (now - last_update_ms) / (scalar_t)1000 : 0;
+  last_update_ms = now;
+  updated = true;
+
+  scalar_t drive_a = 0, steering_a = 0, worst_error = 0;
+  for (int i = 0; i < num_modules; i++)
+  {
+    drive_a += std::fabs((scalar_t)modules[i].drive->current(vex::currentUnits::amp));
+    steering_a += std::fabs((scalar_t)modules[i].direction->current(vex::currentUnits::amp));
+    if (modules[i].alignment_error > worst_error)
+      worst_error = modules[i].alignment_error;
+  }
+  total_a = drive_a + steering_a;
+
+  // Shrink the budget as the battery sags towards a brownout
+  scalar_t volts = (scalar_t)battery.voltage(vex::voltageUnits::volt);
+  scalar_t health = volts > 1 ? clamp((volts - config.brownout_v) / (config.sag_start_v - config.brownout_v),
+                                      MIN_BUDGET_FRACTION, 1)
+                              : 1; // no reading
+  budget_a = config.current_budget_a * health;
+
+  // Steering first, with a bigger share the further off the modules are
+  scalar_t priority = config.steering_priority_deg > 0 ? clamp(worst_error / config.steering_priority_deg, 0, 1) : 1;
+  scalar_t steering_share = budget_a * clamp(priority, STEERING_MIN_SHARE, 1);
+  scalar_t steering_used = steering_a < steering_share ? steering_a : steering_share;
+  scalar_t drive_share = budget_a - steering_used;
+
+  // Each side scales down in proportion to its overdraw, and recovers gradually
+  if (steering_a > steering_share)
+    steer_scale = clamp(steer_scale * steering_share / steering_a, MIN_SCALE, 1);
+  else
+    steer_scale = clamp(steer_scale + (scalar_t)SCALE_RECOVERY_PER_S * dt, MIN_SCALE, 1);
+
+  if (drive_a > drive_share)
+    drive_scale = clamp(drive_scale * drive_share / drive_a, MIN_SCALE, 1);
+  else
+    drive_scale = clamp(drive_scale + (scalar_t)SCALE_RECOVERY_PER_S * dt, MIN_SCALE, 1);
+}
+
+/**
+ * The drive command (-1.0 -> 1.0) module (index) may have instead of (percent):
+ * slew-rate limited and scaled to the drive's share of the budget. (reversed) is true
+ * if the drive motor runs backwards to the way the module points.
+ */
+scalar_t PowerManager::drive_output(int index, scalar_t percent, bool reversed)
+{
+  if (index < 0 || index >= num_modules)
+    return percent;
+
+  update();
+  module_t &module = modules[index];
+
+  uint32_t now = vexSystemTimeGet();
+  scalar_t max_step = config.drive_slew_per_s * (now - module.last_output_ms) / (scalar_t)1000;
+  module.last_output_ms = now;
+
+  // Limit what the motor is actually told: when the module flips around, the same
+  // (percent) turns the motor the other way
+  scalar_t target = (reversed ? -percent : percent) * drive_scale;
+
+  // Slowing down is let through at once; speeding up and reversing are limited
+  scalar_t last = module.last_output;
+  bool slowing = (last >= 0 && target >= 0 && target < last) || (last <= 0 && target <= 0 && target > last);
+  if (!slowing)
+    target = clamp(target, last - max_step, last + max_step);
+
+  module.last_output = target;
+  return reversed ? -target : target;
+}
+
+/**
+ * Fraction of full steering speed module (index) may use, given it is
+ * (alignment_error_deg) from where it should point
+ */
+scalar_t PowerManager::steering_scale(int index, scalar_t alignment_error_deg)
+{
+  if (index < 0 || index >= num_modules)
+    return 1;
+
+  modules[index].alignment_error = std::fabs(alignment_error_deg);
+  update();
+  return steer_scale;
+}
+
+/**
+ * Current budget (A) after battery sag, and the total drawn, as of the last update
+ */
+scalar_t PowerManager::get_budget() const
+{
+  return budget_a;
+}
+
+scalar_t PowerManager::get_total_current() const
+{
+  return total_a;
+}
+
+scalar_t PowerManager::get_drive_scale() const
+{
+  return drive_scale;
+}
+
+scalar_t PowerManager::get_steering_scale() const
+{
+  return steer_scale;
+}
@@ -0,0 +1,450 @@
+#include "../core/include/utils/pure_pursuit.h"
+#include <cmath>
+#include <stdlib.h>
+
+// The grid index never has more cells than this; cells grow to fit big paths
+#define PURE_PURSUIT_MAX_CELLS 4096
+
+namespace
+{
+scalar_t clamp(scalar_t value, scalar_t lower, scalar_t upper)
+{
+  return value < lower ? lower : (value > upper ? upper : value);
+}
+} // namespace
+
+PurePursuit::PurePursuit(pursuit_config_t &config) : config(config)
+{
+}
+
+PurePursuit::~PurePursuit()
+{
+  release();
+}
+
+void PurePursuit::release()
+{
+  free(xs);
+  free(ys);
+  free(distances);
+  free(speeds);
+  free(cell_start);
+  free(cell_points);
+  xs = ys = distances = speeds = NULL;
+  cell_start = cell_points = NULL;
+  length = 0;
+}
+
+bool PurePursuit::allocate(int length)
+{
+  release();
+  if (length < 2)
+    return false;
+
+  xs = (scalar_t *)malloc(sizeof(scalar_t) * length);
+  ys = (scalar_t *)malloc(sizeof(scalar_t) * length);
+  distances = (scalar_t *)malloc(sizeof(scalar_t) * length);
+  speeds = (scalar_t *)malloc(sizeof(scalar_t) * length);
+  cell_points = (int *)malloc(sizeof(int) * length);
+  if (xs == NULL || ys == NULL || distances == NULL || speeds == NULL || cell_points == NULL)
+  {
+    release();
+    return false;
+  }
+
+  this->length = length;
+  return true;
+}
+
+/**
+ * Follow the center of a pathfinder trajectory
+ */
+bool PurePursuit::set_path(const Segment *segments, int length)
+{
+  if (!allocate(length))
+    return false;
+
+  for (int i = 0; i < length; i++)
+  {
+    xs[i] = (scalar_t)segments[i].x;
+    ys[i] = (scalar_t)segments[i].y;
+  }
+
+  prepare();
+  return cell_start != NULL;
+}
+
+/**
+ * Follow straight lines between (waypoints) (their angles are ignored), split up
+ * every (spacing) inches
+ */
+bool PurePursuit::set_path(const Waypoint *waypoints, int count)
+{
+  scalar_t spacing = config.spacing > 0 ? config.spacing : 1;
+
+  int total = 1;
+  for (int i = 1; i < count; i++)
+  {
+    scalar_t dx = (scalar_t)(waypoints[i].x - waypoints[i - 1].x), dy = (scalar_t)(waypoints[i].y - waypoints[i - 1].y);
+    total += (int)std::ceil(std::sqrt(dx * dx + dy * dy) / spacing);
+  }
+
+  if (count < 2 || !allocate(total))
+    return false;
+
+  int n = 0;
+  xs[n] = (scalar_t)waypoints[0].x;
+  ys[n++] = (scalar_t)waypoints[0].y;
+  for (int i = 1; i < count; i++)
+  {
+    scalar_t x0 = (scalar_t)waypoints[i - 1].x, y0 = (scalar_t)waypoints[i - 1].y;
+    scalar_t dx = (scalar_t)waypoints[i].x - x0, dy = (scalar_t)waypoints[i].y - y0;
+    int steps = (int)std::ceil(std::sqrt(dx * dx + dy * dy) / spacing);
+    for (int step = 1; step <= steps; step++)
+    {
+      xs[n] = x0 + dx * step / steps;
+      ys[n++] = y0 + dy * step / steps;
+    }
+  }
+  length = n; // repeated waypoints add no points
+  if (length < 2)
+  {
+    release();
+    return false;
+  }
+
+  prepare();
+  return cell_start != NULL;
+}
+
+/**
+ * Work out the distance along the path and the speed limit at each point, then index it
+ */
+void PurePursuit::prepare()
+{
+  distances[0] = 0;
+  for (int i = 1; i < length; i++)
+    distances[i] = distances[i - 1] + std::sqrt((xs[i] - xs[i - 1]) * (xs[i] - xs[i - 1]) +
+                                                (ys[i] - ys[i - 1]) * (ys[i] - ys[i - 1]));
+
+  // Curvature from the circle through each point and its neighbours: v^2 * k <= max_lateral_a
+  speeds[0] = speeds[length - 1] = config.max_v;
+  for (int i = 1; i < length - 1; i++)
+  {
+    scalar_t ax = xs[i] - xs[i - 1], ay = ys[i] - ys[i - 1];
+    scalar_t bx = xs[i + 1] - xs[i], by = ys[i + 1] - ys[i];
+    scalar_t cx = xs[i + 1] - xs[i - 1], cy = ys[i + 1] - ys[i - 1];
+    scalar_t abc = std::sqrt((ax * ax + ay * ay) * (bx * bx + by * by) * (cx * cx + cy * cy));
+    scalar_t curvature = abc > 0 ? 2 * std::fabs(ax * cy - ay * cx) / abc : 0;
+
+    speeds[i] = config.max_v;
+    if (curvature * config.max_v * config.max_v > config.max_lateral_a)
+      speeds[i] = std::sqrt(config.max_lateral_a / curvature);
+  }
+
+  // Working back from a stop at the end, slow down in time for each limit
+  speeds[length - 1] = 0;
+  for (int i = length - 2; i >= 0; i--)
+  {
+    scalar_t reachable = std::sqrt(speeds[i + 1] * speeds[i + 1] + 2 * config.max_a * (distances[i + 1] - distances[i]));
+    if (reachable < speeds[i])
+      speeds[i] = reachable;
+  }
+
+  nearest = 0;
+  located = false;
+  last_speed = 0;
+  build_index();
+}
+
+/**
+ * Bucket the points into a grid of square cells, counting sort style, so the points near
+ * any position can be found without looking at the rest
+ */
+void PurePursuit::build_index()
+{
+  scalar_t min_x = xs[0], max_x = xs[0], min_y = ys[0], max_y = ys[0];
+  for (int i = 1; i < length; i++)
+  {
+    min_x = xs[i] < min_x ? xs[i] : min_x;
+    max_x = xs[i] > max_x ? xs[i] : max_x;
+    min_y = ys[i] < min_y ? ys[i] : min_y;
+    max_y = ys[i] > max_y ? ys[i] : max_y;
+  }
+
+  cell_size = config.lookahead_max > 1 ? config.lookahead_max : 1;
+  while (((int)((max_x - min_x) / cell_size) + 1) * ((int)((max_y - min_y) / cell_size) + 1) > PURE_PURSUIT_MAX_CELLS)
+    cell_size *= 2;
+
+  grid_x = min_x;
+  grid_y = min_y;
+  cells_x = (int)((max_x - min_x) / cell_size) + 1;
+  cells_y = (int)((max_y - min_y) / cell_size) + 1;
+
+  cell_start = (int *)calloc(cells_x * cells_y + 1, sizeof(int));
+  if (cell_start == NULL)
+    return;
+
+  // Count each cell's points, turn the counts into start offsets, then fill
+  for (int i = 0; i < length; i++)
+  {
+    int cell = (int)((ys[i] - grid_y) / cell_size) * cells_x + (int)((xs[i] - grid_x) / cell_size);
+    cell_start[cell + 1]++;
+  }
+  for (int c = 0; c < cells_x * cells_y; c++)
+    cell_start[c + 1] += cell_start[c];
+
+  for (int i = 0; i < length; i++)
+  {
+    int cell = (int)((ys[i] - grid_y) / cell_size) * cells_x + (int)((xs[i] - grid_x) / cell_size);
+    cell_points[cell_start[cell]++] = i;
+  }
+
+  // Filling moved each start to the next cell's: shift them back
+  for (int c = cells_x * cells_y; c > 0; c--)
+    cell_start[c] = cell_start[c - 1];
+  cell_start[0] = 0;
+}
+
+/**
+ * Nearest point to (pose) in the stretch of path just ahead of the last nearest point.
+ * (best_sq) is set to its squared distance.
+ */
+int PurePursuit::search_window(const pose_t &pose, scalar_t &best_sq)
+{
+  int best = nearest;
+  best_sq = -1;
+  scalar_t window_end = distances[nearest] + config.search_distance;
+
+  for (int i = nearest; i < length && distances[i] <= window_end; i++)
+  {
+    scalar_t dx = xs[i] - pose.x, dy = ys[i] - pose.y;
+    scalar_t dist_sq = dx * dx + dy * dy;
+    if (best_sq < 0 || dist_sq < best_sq)
+    {
+      best_sq = dist_sq;
+      best = i;
+    }
+  }
+
+  return best;
+}
+
+/**
+ * Nearest point to (pose) at or after the last nearest point, anywhere on the path, from
+ * the grid: cells are checked in rings around the robot until no closer point can be left
+ */
+int PurePursuit::search_index(const pose_t &pose)
+{
+  int robot_x = (int)std::floor((pose.x - grid_x) / cell_size);
+  int robot_y = (int)std::floor((pose.y - grid_y) / cell_size);
+
+  // Far enough out to reach every cell, however far off the grid the robot is
+  int max_ring = 0;
+  int reach[4] = {robot_x, cells_x - robot_x, robot_y, cells_y - robot_y};
+  for (int i = 0; i < 4; i++)
+    max_ring = abs(reach[i]) > max_ring ? abs(reach[i]) : max_ring;
+
+  int best = length - 1;
+  scalar_t best_sq = -1;
+
+  for (int ring = 0; ring <= max_ring; ring++)
+  {
+    // Every point in this ring or further out is at least this far away
+    scalar_t ring_dist = (ring - 1) * cell_size;
+    if (best_sq >= 0 && ring_dist > 0 && ring_dist * ring_dist > best_sq)
+      break;
+
+    for (int cy = robot_y - ring; cy <= robot_y + ring; cy++)
+    {
+      if (cy < 0 || cy >= cells_y)
+        continue;
+
+      // Only the edge of the ring: the inside was checked already
+      int step = (cy == robot_y - ring || cy == robot_y + ring) ? 1 : (ring > 0 ? 2 * ring : 1);
+      for (int cx = robot_x - ring; cx <= robot_x + ring; cx += step)
+      {
+        if (cx < 0 || cx >= cells_x)
+          continue;
+
+        int cell = cy * cells_x + cx;
+        for (int p = cell_start[cell]; p < cell_start[cell + 1]; p++)
+        {
+          int i = cell_points[p];
+          if (i < nearest)
+            continue;
+
+          scalar_t dx = xs[i] - pose.x, dy = ys[i] - pose.y;
+          scalar_t dist_sq = dx * dx + dy * dy;
+          if (best_sq < 0 || dist_sq < best_sq)
+          {
+            best_sq = dist_sq;
+            best = i;
+          }
+        }
+      }
+    }
+  }
+
+  return best;
+}
+
+/**
+ * The point on the path, after the nearest one, where a circle of (lookahead) around the
+ * robot crosses it. The end of the path if it's all inside the circle.
+ */
+void PurePursuit::lookahead_point(const pose_t &pose, scalar_t lookahead, scalar_t &x, scalar_t &y)
+{
+  scalar_t lookahead_sq = lookahead * lookahead;
+
+  for (int i = nearest + 1; i < length; i++)
+  {
+    scalar_t dx = xs[i] - pose.x, dy = ys[i] - pose.y;
+    if (dx * dx + dy * dy < lookahead_sq)
+      continue;
+
+    // Solve |start + t * d - robot| = lookahead for the crossing on this segment
+    scalar_t sx = xs[i - 1] - pose.x, sy = ys[i - 1] - pose.y;
+    scalar_t ddx = xs[i] - xs[i - 1], ddy = ys[i] - ys[i - 1];
+    scalar_t a = ddx * ddx + ddy * ddy;
+    scalar_t b = 2 * (sx * ddx + sy * ddy);
+    scalar_t c = sx * sx + sy * sy - lookahead_sq;
+    scalar_t disc = b * b - 4 * a * c;
+    scalar_t t = (a > 0 && disc >= 0) ? clamp((-b + std::sqrt(disc)) / (2 * a), 0, 1) : 1;
+
+    x = xs[i - 1] + t * ddx;
+    y = ys[i - 1] + t * ddy;
+    return;
+  }
+
+  x = xs[length - 1];
+  y = ys[length - 1];
+}
+
+/**
+ * Where the robot at (pose) should head for, and how fast. Call it every loop.
+ */
+PurePursuit::target_t PurePursuit::update(const pose_t &pose)
+{
+  target_t target = {};
+  if (length < 2 || cell_start == NULL)
+  {
+    target.finished = true;
+    return target;
+  }
+
+  uint32_t now = vexSystemTimeGet();
+  scalar_t dt = located ? (now - last_update_ms) / (scalar_t)1000 : 0;
+  last_update_ms = now;
+
+  // Find where on the path the robot is
+  scalar_t best_sq;
+  int found = search_window(pose, best_sq);
+  if (!located || best_sq > config.relocate_distance * config.relocate_distance)
+    found = search_index(pose);
+  nearest = found;
+  located = true;
+
+  // As fast as the path allows here, speeding up no faster than max_a
+  scalar_t speed = speeds[nearest];
+  if (speed > last_speed + config.max_a * dt)
+    speed = last_speed + config.max_a * dt;
+  speed = speed < config.min_v ? config.min_v : speed;
+
+  target.index = nearest;
+  target.remaining = distances[length - 1] - distances[nearest];
+  target.finished = nearest == length - 1 || (target.remaining <= config.end_tolerance &&
+                                              (xs[length - 1] - pose.x) * (xs[length - 1] - pose.x) +
+                                                      (ys[length - 1] - pose.y) * (ys[length - 1] - pose.y) <=
+                                                  config.end_tolerance * config.end_tolerance);
+  target.speed = target.finished ? 0 : speed;
+  last_speed = target.speed;
+
+  scalar_t lookahead = clamp(config.lookahead_min + config.lookahead_gain * speed, config.lookahead_min,
+                             config.lookahead_max);
+  lookahead_point(pose, lookahead, target.x, target.y);
+
+  // Arc from the robot to the lookahead point: curvature = 2 * sideways offset / distance^2
+  scalar_t dx = target.x - pose.x, dy = target.y - pose.y;
+  scalar_t left = -std::sin(pose.heading) * dx + std::cos(pose.heading) * dy;
+  scalar_t dist_sq = dx * dx + dy * dy;
+  target.curvature = dist_sq > 0 ? 2 * left / dist_sq : 0;
+
+  return target;
+}
+
+/**
+ * Drive along the path, with the pose from (odometry). Returns true when finished.
+ */
+bool PurePursuit::follow(TankDrive &drive, TankOdometry &odometry)
+{
+  odometry.update();
+  TankOdometry::pose_t odom = odometry.get_position();
+  pose_t pose = {odom.x, odom.y, odom.heading};
+
+  target_t target = update(pose);
+  if (target.finished)
+  {
+    drive.stop();
+    located = false;
+    return true;
+  }
+
+  scalar_t turn = target.curvature * config.track_width / 2;
+  drive.drive_tank(config.kv * target.speed * (1 - turn), config.kv * target.speed * (1 + turn));
+  return false;
+}
+
+/**
+ * Drive along the path, with the robot at (pose). The robot's heading is left alone:
+ * it goes straight for the lookahead point. Returns true when finished.
+ */
+bool PurePursuit::follow(SwerveDrive &drive, const pose_t &pose)
+{
+  target_t target = update(pose);
+  if (target.finished)
+  {
+    drive.drive(Vector(0, 0), 0);
+    located = false;
+    return true;
+  }
+
+  // Towards the lookahead point, in the robot's frame: Vector's 0 is forward, clockwise positive
+  scalar_t dx = target.x - pose.x, dy = target.y - pose.y;
+  scalar_t ahead = std::cos(pose.heading) * dx + std::sin(pose.heading) * dy;
+  scalar_t left = -std::sin(pose.heading) * dx + std::cos(pose.heading) * dy;
+
+  // SwerveModule::set squares its speed, so undo that to keep it proportional
+  scalar_t output = clamp(config.kv * target.speed, 0, 1);
+  drive.drive(Vector(std::atan2(-left, ahead), std::sqrt(output)), 0);
+  return false;
+}
+
+bool PurePursuit::follow(MecanumDrive &drive, const pose_t &pose)
+{
+  target_t target = update(pose);
+  if (target.finished)
+  {
+    drive.drive(0, 0, 0);
+    located = false;
+    return true;
+  }
+
+  scalar_t dx = target.x - pose.x, dy = target.y - pose.y;
+  scalar_t ahead = std::cos(pose.heading) * dx + std::sin(pose.heading) * dy;
+  scalar_t left = -std::sin(pose.heading) * dx + std::cos(pose.heading) * dy;
+  scalar_t dist = std::sqrt(dx * dx + dy * dy);
+
+  scalar_t output = clamp(config.kv * target.speed, 0, 1) * 100;
+  if (dist > 0)
+    drive.drive(output * ahead / dist, -output * left / dist, 0, 1);
+  return false;
+}
+
+/**
+ * Number of points on the path
+ */
+int PurePursuit::get_length() const
+{
+  return length;
+}
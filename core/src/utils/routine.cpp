@@ -0,0 +1,76 @@
+#include "../core/include/utils/routine.h"
+
+Routine::Routine()
+{
+  name = "routine";
+}
+
+void Routine::initialize()
+{
+  resume_line = 0;
+  num_awaiting = 0;
+  done = false;
+}
+
+void Routine::execute()
+{
+  body();
+}
+
+void Routine::end(bool interrupted)
+{
+  for (int i = 0; i < num_awaiting; i++)
+    awaiting[i]->cancel();
+  num_awaiting = 0;
+}
+
+bool Routine::is_finished()
+{
+  return done;
+}
+
+/**
+ * Start the commands for a ROUTINE_AWAIT_ALL / ROUTINE_AWAIT_ANY
+ */
+void Routine::start_awaiting(std::initializer_list<Command *> commands)
+{
+  num_awaiting = 0;
+  for (Command *command : commands)
+  {
+    if (num_awaiting >= COMMAND_GROUP_MAX)
+    {
+      fprintf(stderr, "Routine: awaiting more than %d commands, command ignored\n", COMMAND_GROUP_MAX);
+      break;
+    }
+
+    awaiting[num_awaiting++] = command;
+    command->start();
+  }
+}
+
+/**
+ * Run one tick of the awaited commands. Returns true once all of them have finished,
+ * or if (any) is set, once one of them has (cancelling the rest).
+ */
+bool Routine::step_awaiting(bool any)
+{
+  bool all_done = true, any_done = false;
+  for (int i = 0; i < num_awaiting; i++)
+  {
+    if (awaiting[i]->is_running())
+      awaiting[i]->step();
+
+    if (awaiting[i]->is_running())
+      all_done = false;
+    else
+      any_done = true;
+  }
+
+  if (!(any ? any_done || num_awaiting == 0 : all_done))
+    return false;
+
+  for (int i = 0; i < num_awaiting; i++)
+    awaiting[i]->cancel();
+  num_awaiting = 0;
+  return true;
+}
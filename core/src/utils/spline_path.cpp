@@ -1,7 +1,52 @@
 #include "../core/include/utils/spline_path.h"
+#include <string.h>
+
+// A replan skips a waypoint the robot is already this close to (inches)
+#define REPLAN_MIN_LEG 2
+
+// run_paths() only carries on through a join this close (inches), and this straight (radians)
+#define JOIN_MAX_GAP 1
+#define JOIN_MAX_TURN (10 * PI / 180)
+
+namespace
+{
+/**
+ * (angle) in radians, wrapped to -PI -> PI
+ */
+double wrap_radians(double angle)
+{
+  while (angle > PI)
+    angle -= 2 * PI;
+  while (angle < -PI)
+    angle += 2 * PI;
+  return angle;
+}
+
+/**
+ * How far along (path) it is, at least: the straight lines between its waypoints
+ */
+double path_length(const SplinePath::path_t &path)
+{
+  double length = 0;
+  for (int i = 1; i < path.length; i++)
+    length += sqrt(pow(path.points[i].x - path.points[i - 1].x, 2) + pow(path.points[i].y - path.points[i - 1].y, 2));
+  return length;
+}
+
+/**
+ * Whether path (to) carries straight on from where path (from) ends
+ */
+bool joins(const SplinePath::path_t &from, const SplinePath::path_t &to)
+{
+  const Waypoint &end = from.points[from.length - 1], &start = to.points[0];
+  return fabs(end.x - start.x) <= JOIN_MAX_GAP && fabs(end.y - start.y) <= JOIN_MAX_GAP &&
+         fabs(wrap_radians(end.angle - start.angle)) <= JOIN_MAX_TURN;
+}
+} // namespace
 
 SplinePath::SplinePath(TankDrive &drive_system, vex::inertial &imu, vex::motor &l_enc, vex::motor &r_enc, motion_profile_t &motion_profile)
-: drive_system(drive_system), l_enc(l_enc), r_enc(r_enc), imu(imu), motion_profile(motion_profile)
+: drive_system(drive_system), l_enc(l_enc), r_enc(r_enc), imu(imu), motion_profile(motion_profile),
+  generator_config(), generator(generator_config)
 {
 }
 
@@ -9,10 +54,15 @@ SplinePath::SplinePath(TankDrive &drive_system, vex::inertial &imu, vex::motor &
  * Makes the robot follow a predetermined path defined by point_list array,
  * with list_length number of waypoints. The first waypoint should be the
  * starting position.
+ *
+ * With pose feedback (see set_odometry()), the path can end still moving, at end_v
+ * in/s, instead of stopped. The drive is then left running, and the next call to
+ * run_path must carry on from where this one ended: it starts at that speed instead
+ * of from rest.
  * 
  * Returns true when the path has finished
  */
-bool SplinePath::run_path(Waypoint *point_list, int list_length)
+bool SplinePath::run_path(Waypoint *point_list, int list_length, scalar_t end_v)
 {
   if (run_path_init)
   {
@@ -30,16 +80,75 @@ bool SplinePath::run_path(Waypoint *point_list, int list_length)
     pathfinder_prepare(point_list, list_length, FIT_HERMITE_CUBIC, PATHFINDER_SAMPLES_LOW, motion_profile.dt,
                        motion_profile.max_v, motion_profile.max_a, motion_profile.max_j, &candidate);
 
+    // Pathfinder only goes from rest to rest, so a path starting or ending on the move is
+    // made by the TrajectoryGenerator. Only pose feedback can follow one: the encoder
+    // followers always start from rest.
+    path_end_v = odometry != NULL ? end_v : 0;
+    if (odometry == NULL)
+      carry_v = 0;
+    bool moving = carry_v > 0 || path_end_v > 0;
+
+    // Replanning needs a copy of the waypoints, and room for a new trajectory, which may
+    // take up to twice as long as this one
+    bool replan = odometry != NULL && motion_profile.replan_distance > 0;
+    if (replan && list_length > TRAJECTORY_MAX_WAYPOINTS)
+    {
+      fprintf(stderr, "SplinePath: too many waypoints to replan (%d), following without\n", list_length);
+      replan = false;
+    }
+    center_length = candidate.length;
+    capacity = (replan || moving) ? 2 * candidate.length : candidate.length;
+    num_waypoints = replan ? list_length : 0;
+
     // Allocate the memory for the center, left and right "trajectories", or paths.
-    center_traj = (Segment *)malloc(sizeof(Segment) * candidate.length);
-    left_traj = (Segment*) malloc(sizeof(Segment) * candidate.length);
-    right_traj = (Segment*) malloc(sizeof(Segment) * candidate.length);
+    center_traj = (Segment *)malloc(sizeof(Segment) * capacity);
+    pending_traj = replan ? (Segment *)malloc(sizeof(Segment) * capacity) : NULL;
+    left_traj = (Segment*) malloc(sizeof(Segment) * capacity);
+    right_traj = (Segment*) malloc(sizeof(Segment) * capacity);
+
+    generator_config.max_v = motion_profile.max_v;
+    generator_config.max_a = motion_profile.max_a;
+    generator_config.dt = motion_profile.dt;
 
     // Generate the main center trajectory
-    pathfinder_generate(&candidate, center_traj);
+    if (moving)
+      center_length = generator.generate(point_list, list_length, carry_v, path_end_v, center_traj, capacity);
+    if (moving && center_length >= 1)
+    {
+      // pathfinder_generate frees the candidate's splines, and it isn't going to run
+      free(candidate.saptr);
+      free(candidate.laptr);
+    }
+    else
+    {
+      if (moving)
+        fprintf(stderr, "SplinePath: couldn't make a path from %.1f to %.1f in/s, starting from rest\n",
+                (double)carry_v, (double)path_end_v);
+      pathfinder_generate(&candidate, center_traj);
+      center_length = candidate.length;
+    }
+
+    // Where the trajectory passes each waypoint, for knowing which are still ahead
+    int from = 0;
+    for (int i = 0; i < num_waypoints; i++)
+    {
+      waypoints[i] = point_list[i];
+      double best_sq = -1;
+      for (int j = from; j < center_length; j++)
+      {
+        double dx = center_traj[j].x - point_list[i].x, dy = center_traj[j].y - point_list[i].y;
+        if (best_sq < 0 || dx * dx + dy * dy < best_sq)
+        {
+          best_sq = dx * dx + dy * dy;
+          from = j;
+        }
+      }
+      waypoint_segments[i] = from;
+    }
+    next_replan_ms = 0;
 
     // Generate the left wheel and right wheel paths from the center trajectory
-    pathfinder_modify_tank(center_traj, candidate.length, left_traj, right_traj, motion_profile.wheelbase_width);
+    pathfinder_modify_tank(center_traj, center_length, left_traj, right_traj, motion_profile.wheelbase_width);
     
     // Create the "follower" structs, which contains info about the current state of each path when it is running
     // (e.g. current error for PID, whether it is finished)
@@ -48,10 +157,25 @@ bool SplinePath::run_path(Waypoint *point_list, int list_length)
 
     reset_heading = imu.rotation();
 
+    // With pose feedback, the robot starts where the path does (or, carrying on from the
+    // last one, is already about there)
+    if (odometry != NULL && carry_v > 0)
+      start_ms = vexSystemTimeGet();
+    else if (odometry != NULL)
+    {
+      TankOdometry::pose_t start = {(scalar_t)center_traj[0].x, (scalar_t)center_traj[0].y,
+                                    (scalar_t)center_traj[0].heading};
+      odometry->set_position(start);
+      start_ms = vexSystemTimeGet();
+    }
+
     // Make sure this only runs once per run
     run_path_init = false;
   }
 
+  if (odometry != NULL)
+    return follow_pose();
+
   double lout = pathfinder_follow_encoder(enc_conf, left_follower, left_traj, candidate.length, l_enc.position(rotationUnits::raw));
   double rout = pathfinder_follow_encoder(enc_conf, right_follower, right_traj, candidate.length, r_enc.position(rotationUnits::raw));
 
@@ -67,20 +191,226 @@ bool SplinePath::run_path(Waypoint *point_list, int list_length)
 
   if(left_follower->finished && right_follower->finished)
   {
-    // Actively set all velocities of the wheels to 0
-    drive_system.stop();
+    finish_path();
+    return true;
+  }
+
+  return false;
+}
 
-    // Free the memory allocated in the last run
-    free(center_traj);
-    free(left_traj);
-    free(right_traj);
-    free(left_follower);
-    free(right_follower);
+/**
+ * Follow the center trajectory with pose feedback (the "Ramsete" controller): the
+ * segment for the time since the path started gives the pose and speeds the robot
+ * should have, and the error from where odometry says it is, in the robot's own frame,
+ * adjusts them. Returns true when the path has finished.
+ */
+bool SplinePath::follow_pose()
+{
+  odometry->update();
+  take_replan();
 
-    // Re-run initialization for the next path
-    run_path_init = true;
+  int index = (int)((vexSystemTimeGet() - start_ms) / (motion_profile.dt * 1000));
+  if (index >= center_length - 1)
+  {
+    finish_path();
     return true;
   }
 
+  Segment &target = center_traj[index];
+  double target_omega = wrap_radians(center_traj[index + 1].heading - target.heading) / motion_profile.dt;
+
+  TankOdometry::pose_t pose = odometry->get_position();
+  double dx = target.x - pose.x, dy = target.y - pose.y;
+  double error_x = cos(pose.heading) * dx + sin(pose.heading) * dy;  // ahead of the robot
+  double error_y = -sin(pose.heading) * dx + cos(pose.heading) * dy; // to its left
+  double error_heading = wrap_radians(target.heading - pose.heading);
+
+  // Knocked off the path: keep following it while a new one is made from here
+  if (num_waypoints > 0 && dx * dx + dy * dy > motion_profile.replan_distance * motion_profile.replan_distance)
+    start_replan(pose, index);
+
+  double b = motion_profile.ramsete_b, zeta = motion_profile.ramsete_zeta;
+  double gain = 2 * zeta * sqrt(target_omega * target_omega + b * target.velocity * target.velocity);
+
+  // sin(x) / x, which goes to 1 as the heading error goes to 0
+  double sinc = fabs(error_heading) > 1e-6 ? sin(error_heading) / error_heading : 1;
+
+  double velocity = target.velocity * cos(error_heading) + gain * error_x;
+  double omega = target_omega + gain * error_heading + b * target.velocity * sinc * error_y;
+
+  // Each side's speed, through the same feedforward the encoder followers use, and
+  // feedback on the measured speed for whatever the feedforward gets wrong
+  double half_width = motion_profile.wheelbase_width / 2;
+  double feedback = motion_profile.velocity_p * (velocity - odometry->get_speed());
+  double lout = motion_profile.kv * (velocity - omega * half_width) + motion_profile.ka * target.acceleration + feedback;
+  double rout = motion_profile.kv * (velocity + omega * half_width) + motion_profile.ka * target.acceleration + feedback;
+
+  drive_system.drive_tank(lout, rout);
   return false;
+}
+
+/**
+ * Stop, and free the last path so the next call to run_path starts a new one
+ */
+void SplinePath::finish_path()
+{
+  // Actively set all velocities of the wheels to 0, unless the next path carries on
+  // from this one
+  carry_v = path_end_v > 0 ? center_traj[center_length - 1].velocity : 0;
+  if (carry_v <= 0)
+    drive_system.stop();
+
+  // A replan still being made is writing into pending_traj
+  while (replanning)
+    vexDelay(1);
+
+  // Free the memory allocated in the last run
+  free(center_traj);
+  free(pending_traj);
+  pending_traj = NULL;
+  replan_ready = false;
+  free(left_traj);
+  free(right_traj);
+  free(left_follower);
+  free(right_follower);
+
+  // Re-run initialization for the next path
+  run_path_init = true;
+}
+
+/**
+ * Follow (paths) one after another, like calling run_path on each in turn, but without
+ * stopping between them where one carries straight on into the next (starting where
+ * it ended, facing the same way). At each of those the robot goes as fast as it still
+ * can slow down in time for the next stop. Needs pose feedback: with the encoders it
+ * stops after each path.
+ *
+ * Returns true when the last path has finished
+ */
+bool SplinePath::run_paths(path_t *paths, int num_paths)
+{
+  if (num_paths < 1)
+    return true;
+
+  // The speed to end this path at (only read as it starts), working back from the next
+  // stop: each join is as fast as the path after it can still slow down from
+  scalar_t end_v = 0;
+  if (run_path_init)
+  {
+    for (int i = num_paths - 1; i > path_index; i--)
+    {
+      if (!joins(paths[i - 1], paths[i]))
+        end_v = 0;
+      else
+        end_v = fmin(motion_profile.max_v, sqrt(end_v * end_v + 2 * motion_profile.max_a * path_length(paths[i])));
+    }
+  }
+
+  if (!run_path(paths[path_index].points, paths[path_index].length, end_v))
+    return false;
+
+  if (++path_index < num_paths)
+    return false;
+
+  path_index = 0;
+  return true;
+}
+
+/**
+ * Follow paths with pose feedback from (odometry) instead of following each side's
+ * encoder on its own: x, y and heading errors against the center trajectory are all
+ * corrected, so sideways error can't build up. Pass NULL to go back to the encoders.
+ */
+void SplinePath::set_odometry(TankOdometry *odometry)
+{
+  this->odometry = odometry;
+}
+
+/**
+ * Start making a new trajectory from (pose), at the current speed, through the waypoints
+ * center_traj hasn't reached by segment (index). It runs in its own task, so the control
+ * loop carries on following the old one meanwhile.
+ */
+void SplinePath::start_replan(const TankOdometry::pose_t &pose, int index)
+{
+  uint32_t now = vexSystemTimeGet();
+  if (replanning || replan_ready || (int32_t)(now - next_replan_ms) < 0)
+    return;
+
+  // The first waypoint still ahead, unless the robot is practically on it already
+  int from = 1;
+  while (from < num_waypoints - 1 && waypoint_segments[from] <= index)
+    from++;
+  double dx = waypoints[from].x - pose.x, dy = waypoints[from].y - pose.y;
+  if (from < num_waypoints - 1 && dx * dx + dy * dy < REPLAN_MIN_LEG * REPLAN_MIN_LEG)
+    from++;
+
+  replan_start.x = pose.x;
+  replan_start.y = pose.y;
+  replan_start.angle = pose.heading;
+  replan_speed = odometry->get_speed();
+  replan_from = from;
+  replan_ms = now;
+  replanning = true;
+
+  vex::task replanner(replan_task, this);
+}
+
+/**
+ * Swap in a replanned trajectory, if one is ready. It starts from when the replan did, so
+ * the robot picks it up where it should be by now.
+ */
+void SplinePath::take_replan()
+{
+  if (!replan_ready)
+    return;
+
+  replan_lock.lock();
+  Segment *old = center_traj;
+  center_traj = pending_traj;
+  pending_traj = old;
+  center_length = pending_length;
+  memcpy(waypoint_segments, pending_waypoint_segments, sizeof(waypoint_segments));
+  start_ms = replan_ms;
+  replan_ready = false;
+  replan_lock.unlock();
+}
+
+/**
+ * Make the trajectory start_replan() asked for, into pending_traj. Its cost is bounded
+ * by the room in pending_traj; if it still takes longer than replan_budget_ms, it's
+ * dropped, and the next replan waits as long again.
+ */
+int SplinePath::replan_task(void *arg)
+{
+  SplinePath *self = (SplinePath *)arg;
+
+  Waypoint path[TRAJECTORY_MAX_WAYPOINTS];
+  int count = 0, from = self->replan_from;
+  path[count++] = self->replan_start;
+  for (int i = from; i < self->num_waypoints; i++)
+    path[count++] = self->waypoints[i];
+
+  int segments[TRAJECTORY_MAX_WAYPOINTS];
+  int length = self->generator.generate(path, count, self->replan_speed, self->path_end_v, self->pending_traj, self->capacity, segments);
+  uint32_t took_ms = vexSystemTimeGet() - self->replan_ms;
+
+  if (length > 0 && took_ms <= self->motion_profile.replan_budget_ms)
+  {
+    self->replan_lock.lock();
+    self->pending_length = length;
+    for (int i = 0; i < self->num_waypoints; i++)
+      self->pending_waypoint_segments[i] = i < from ? -1 : segments[i - from + 1];
+    self->replan_ready = true;
+    self->replan_lock.unlock();
+  }
+  else
+  {
+    fprintf(stderr, "SplinePath: replan %s (%lums), keeping the old path\n", length > 0 ? "too slow" : "failed",
+            (unsigned long)took_ms);
+    self->next_replan_ms = vexSystemTimeGet() + (uint32_t)self->motion_profile.replan_budget_ms;
+  }
+
+  self->replanning = false;
+  return 0;
 }
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "../core/include/utils/state_observer.h"
+#include <string.h>
+
+StateObserver::StateObserver(observer_config_t &config) : config(config)
+{
+  reset();
+}
+
+/**
+ * Forget the state. The next update starts over at rest, at that sample.
+ */
+void StateObserver::reset()
+{
+  memset(state, 0, sizeof(state));
+  memset(cov, 0, sizeof(cov));
+  initialized = false;
+}
+
+/**
+ * Flip the sign of the state, for when the samples change sign (e.g. a motor being set
+ * reversed), so the estimate carries on instead of seeing a jump
+ */
+void StateObserver::negate()
+{
+  // The covariance is the same either way
+  for (int i = 0; i < 3; i++)
+    state[i] = -state[i];
+}
+
+/**
+ * Fuse a new (position) sample, taken (dt) seconds after the last
+ */
+void StateObserver::update(scalar_t position, scalar_t dt)
+{
+  scalar_t r = config.position_noise * config.position_noise;
+
+  if (!initialized)
+  {
+    reset();
+    state[0] = position;
+    cov[0][0] = r;
+    initialized = true;
+    return;
+  }
+
+  if (dt > 0)
+  {
+    // Predict: x = F x, cov = F cov F^T + Q, with F the constant-acceleration step
+    scalar_t half_dt2 = dt * dt / 2;
+    state[0] += state[1] * dt + state[2] * half_dt2;
+    state[1] += state[2] * dt;
+
+    scalar_t f[3][3] = {{1, dt, half_dt2}, {0, 1, dt}, {0, 0, 1}};
+    scalar_t fp[3][3];
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++)
+        fp[i][j] = f[i][0] * cov[0][j] + f[i][1] * cov[1][j] + f[i][2] * cov[2][j];
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++)
+        cov[i][j] = fp[i][0] * f[j][0] + fp[i][1] * f[j][1] + fp[i][2] * f[j][2];
+
+    // Jerk as white noise, integrated over the step
+    scalar_t q = config.jerk_noise * config.jerk_noise;
+    scalar_t dt2 = dt * dt, dt3 = dt2 * dt;
+    cov[0][0] += q * dt3 * dt2 / 20;
+    cov[0][1] += q * dt2 * dt2 / 8;
+    cov[0][2] += q * dt3 / 6;
+    cov[1][0] += q * dt2 * dt2 / 8;
+    cov[1][1] += q * dt3 / 3;
+    cov[1][2] += q * dt2 / 2;
+    cov[2][0] += q * dt3 / 6;
+    cov[2][1] += q * dt2 / 2;
+    cov[2][2] += q * dt;
+  }
+
+  // Correct with the sample: only position is measured, so the gain is its column
+  scalar_t variance = cov[0][0] + r;
+  if (variance <= 0)
+  {
+    state[0] = position;
+    return;
+  }
+
+  scalar_t innovation = position - state[0];
+  scalar_t gain[3] = {cov[0][0] / variance, cov[1][0] / variance, cov[2][0] / variance};
+  scalar_t row[3] = {cov[0][0], cov[0][1], cov[0][2]};
+  for (int i = 0; i < 3; i++)
+  {
+    state[i] += gain[i] * innovation;
+    for (int j = 0; j < 3; j++)
+      cov[i][j] -= gain[i] * row[j];
+  }
+}
+
+scalar_t StateObserver::get_position() const
+{
+  return state[0];
+}
+
+scalar_t StateObserver::get_velocity() const
+{
+  return state[1];
+}
+
+scalar_t StateObserver::get_acceleration() const
+{
+  return state[2];
+}
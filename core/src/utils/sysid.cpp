@@ -0,0 +1,218 @@
+#include "../core/include/utils/sysid.h"
+#include <stdlib.h>
+#include <string.h>
+
+// The log is written out in chunks of about this many bytes
+#define SYSID_CHUNK_BYTES 4096
+#define SYSID_LINE_BYTES 64
+
+/**
+ * Characterize (motors), all driven at the same voltage through (compensation), and
+ * write the log to (filename) on (sd). Velocity and position are averaged over the
+ * motors. The log buffer is allocated once, here.
+ */
+SysIdCommand::SysIdCommand(BatteryCompensation &compensation, vex::brain::sdcard &sd, const char *filename,
+                           std::initializer_list<vex::motor *> motors)
+    : compensation(compensation), sd(sd), filename(filename)
+{
+  init(motors);
+}
+
+SysIdCommand::SysIdCommand(BatteryCompensation &compensation, vex::brain::sdcard &sd, const char *filename,
+                           std::initializer_list<vex::motor *> motors, const sysid_config_t &config)
+    : compensation(compensation), sd(sd), filename(filename), config(config)
+{
+  init(motors);
+}
+
+SysIdCommand::~SysIdCommand()
+{
+  // A test still running is using the buffer: stop it first
+  abort = true;
+  while (task_running)
+    vexDelay(1);
+  free(samples);
+}
+
+void SysIdCommand::init(std::initializer_list<vex::motor *> motors)
+{
+  name = "sysid";
+  for (vex::motor *motor : motors)
+    if (num_motors < SYSID_MAX_MOTORS)
+      this->motors[num_motors++] = motor;
+
+  scalar_t ramp_seconds = config.ramp_max_volts / config.ramp_volts_per_s;
+  scalar_t seconds = 2 * ramp_seconds + 2 * config.step_seconds;
+  max_samples = (uint32_t)(seconds * 1000 / SYSID_PERIOD_MS) + 4;
+
+  samples = (sample_t *)malloc(max_samples * sizeof(sample_t));
+  if (samples == NULL)
+    max_samples = 0;
+}
+
+void SysIdCommand::initialize()
+{
+  if (task_running)
+  {
+    fprintf(stderr, "SysIdCommand: still stopping the last run\n");
+    return;
+  }
+
+  num_samples = 0;
+  abort = false;
+  log_saved = false;
+  task_running = true;
+  vex::task tester(test_task, this);
+}
+
+void SysIdCommand::end(bool interrupted)
+{
+  // The test task stops the motors and saves what it has
+  if (interrupted)
+    abort = true;
+}
+
+bool SysIdCommand::is_finished()
+{
+  return !task_running;
+}
+
+/**
+ * Whether the last run's log was written to the SD card
+ */
+bool SysIdCommand::saved() const
+{
+  return log_saved;
+}
+
+void SysIdCommand::set_volts(scalar_t volts)
+{
+  scalar_t command = compensation.command_for(volts);
+  for (int i = 0; i < num_motors; i++)
+    motors[i]->spin(vex::directionType::fwd, command, vex::voltageUnits::volt);
+}
+
+scalar_t SysIdCommand::velocity()
+{
+  scalar_t sum = 0;
+  for (int i = 0; i < num_motors; i++)
+    sum += (scalar_t)motors[i]->velocity(vex::velocityUnits::rpm);
+  return num_motors > 0 ? sum / num_motors : 0;
+}
+
+scalar_t SysIdCommand::position()
+{
+  scalar_t sum = 0;
+  for (int i = 0; i < num_motors; i++)
+    sum += (scalar_t)motors[i]->position(vex::rotationUnits::deg);
+  return num_motors > 0 ? sum / num_motors : 0;
+}
+
+/**
+ * Apply (volts) + (ramp) * t for (seconds), logging every SYSID_PERIOD_MS on a fixed
+ * schedule. Returns false if the run was aborted.
+ */
+bool SysIdCommand::run_test(uint8_t test, scalar_t ramp, scalar_t volts, scalar_t seconds)
+{
+  uint32_t start_ms = vexSystemTimeGet();
+  uint32_t next_ms = start_ms;
+  uint32_t duration_ms = (uint32_t)(seconds * 1000);
+
+  while (!abort && next_ms - start_ms <= duration_ms)
+  {
+    scalar_t t = (next_ms - start_ms) / (scalar_t)1000;
+    scalar_t applied = volts + ramp * t;
+    set_volts(applied);
+
+    if (num_samples < max_samples)
+    {
+      sample_t &sample = samples[num_samples++];
+      sample.time_ms = next_ms - start_ms;
+      sample.test = test;
+      sample.volts = applied;
+      sample.velocity_rpm = velocity();
+      sample.position_deg = position();
+    }
+
+    next_ms += SYSID_PERIOD_MS;
+    int32_t wait_ms = (int32_t)(next_ms - vexSystemTimeGet());
+    vexDelay(wait_ms > 0 ? wait_ms : 0);
+  }
+
+  return !abort;
+}
+
+/**
+ * Coast for (seconds), so each test starts from rest
+ */
+void SysIdCommand::rest(scalar_t seconds)
+{
+  for (int i = 0; i < num_motors; i++)
+    motors[i]->stop(vex::brakeType::coast);
+
+  uint32_t end_ms = vexSystemTimeGet() + (uint32_t)(seconds * 1000);
+  while (!abort && (int32_t)(end_ms - vexSystemTimeGet()) > 0)
+    vexDelay(SYSID_PERIOD_MS);
+}
+
+int SysIdCommand::test_task(void *arg)
+{
+  SysIdCommand *self = (SysIdCommand *)arg;
+  sysid_config_t &config = self->config;
+  scalar_t ramp_seconds = config.ramp_max_volts / config.ramp_volts_per_s;
+
+  fprintf(stderr, "SysId: characterizing %d motors to %s\n", self->num_motors, self->filename);
+
+  bool completed = self->run_test(1, config.ramp_volts_per_s, 0, ramp_seconds);
+  self->rest(config.rest_seconds);
+  completed = completed && self->run_test(2, -config.ramp_volts_per_s, 0, ramp_seconds);
+  self->rest(config.rest_seconds);
+  completed = completed && self->run_test(3, 0, config.step_volts, config.step_seconds);
+  self->rest(config.rest_seconds);
+  completed = completed && self->run_test(4, 0, -config.step_volts, config.step_seconds);
+
+  for (int i = 0; i < self->num_motors; i++)
+    self->motors[i]->stop(vex::brakeType::brake);
+
+  self->log_saved = self->save();
+  fprintf(stderr, "SysId: %s, %d samples %s\n", completed ? "done" : "aborted", (int)self->num_samples,
+          self->log_saved ? "saved" : "NOT saved");
+
+  self->task_running = false;
+  return 0;
+}
+
+/**
+ * Write the log to the SD card as CSV, a chunk at a time
+ */
+bool SysIdCommand::save()
+{
+  if (!sd.isInserted())
+    return false;
+
+  char chunk[SYSID_CHUNK_BYTES + SYSID_LINE_BYTES];
+  int len = snprintf(chunk, sizeof(chunk), "test,time_s,volts,velocity_rpm,position_deg\n");
+  bool first = true;
+
+  for (uint32_t i = 0; i <= num_samples; i++)
+  {
+    if (i < num_samples)
+    {
+      const sample_t &s = samples[i];
+      len += snprintf(chunk + len, SYSID_LINE_BYTES, "%d,%.3f,%.3f,%.2f,%.2f\n", s.test, s.time_ms / 1000.0,
+                      s.volts, s.velocity_rpm, s.position_deg);
+    }
+
+    if (len >= SYSID_CHUNK_BYTES || (i == num_samples && len > 0))
+    {
+      int32_t written = first ? sd.savefile(filename, (uint8_t *)chunk, len)
+                              : sd.appendfile(filename, (uint8_t *)chunk, len);
+      if (written != len)
+        return false;
+      first = false;
+      len = 0;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,132 @@
+#include "../core/include/utils/tank_odometry.h"
+#include <cmath>
+
+#define DEG_TO_RAD (3.141592654 / 180.0)
+
+// Below this heading change, the arc is treated as a straight line
+#define STRAIGHT_LINE_RAD 1e-4
+
+/**
+ * Track a drive from its (left_motors), (right_motors) and (imu). (wheel_diam) is in
+ * inches, and the wheels turn once per motor revolution (as in TankDrive).
+ */
+TankOdometry::TankOdometry(vex::motor_group &left_motors, vex::motor_group &right_motors, vex::inertial &imu,
+                           scalar_t wheel_diam)
+    : left_motors(left_motors), right_motors(right_motors), imu(imu), wheel_diam(wheel_diam)
+{
+}
+
+TankOdometry::~TankOdometry()
+{
+  delete observer;
+}
+
+scalar_t TankOdometry::left_inches()
+{
+  return (scalar_t)left_motors.position(vex::rotationUnits::rev) * (scalar_t)3.141592654 * wheel_diam;
+}
+
+scalar_t TankOdometry::right_inches()
+{
+  return (scalar_t)right_motors.position(vex::rotationUnits::rev) * (scalar_t)3.141592654 * wheel_diam;
+}
+
+/**
+ * Read the sensors and move the pose along the arc driven since the last update.
+ * Call it every loop of whatever uses the pose.
+ */
+void TankOdometry::update()
+{
+  scalar_t left = left_inches(), right = right_inches();
+  scalar_t imu_deg = (scalar_t)imu.rotation(vex::rotationUnits::deg);
+  uint32_t now = vexSystemTimeGet();
+
+  if (!initialized)
+  {
+    last_left = left;
+    last_right = right;
+    last_imu_deg = imu_deg;
+    last_update_ms = now;
+    initialized = true;
+
+    if (observer != NULL)
+    {
+      observer->reset();
+      observer->update((left + right) / 2, 0);
+    }
+    return;
+  }
+
+  scalar_t distance = ((left - last_left) + (right - last_right)) / 2;
+  scalar_t turned = -(imu_deg - last_imu_deg) * (scalar_t)DEG_TO_RAD;
+
+  // Constant curvature between updates: the chord of the arc is shorter than the arc, and
+  // points along the heading halfway through the turn
+  scalar_t chord = distance;
+  if (std::fabs(turned) > STRAIGHT_LINE_RAD)
+    chord = distance * 2 * std::sin(turned / 2) / turned;
+
+  scalar_t mid_heading = pose.heading + turned / 2;
+  pose.x += chord * std::cos(mid_heading);
+  pose.y += chord * std::sin(mid_heading);
+  pose.heading += turned;
+
+  if (observer != NULL)
+  {
+    observer->update((left + right) / 2, (now - last_update_ms) / (scalar_t)1000);
+    speed = observer->get_velocity();
+  }
+  else if (now != last_update_ms)
+    speed = distance * 1000 / (scalar_t)(now - last_update_ms);
+
+  last_left = left;
+  last_right = right;
+  last_imu_deg = imu_deg;
+  last_update_ms = now;
+}
+
+/**
+ * Say the robot is at (pose) now, e.g. the start of a path
+ */
+void TankOdometry::set_position(const pose_t &pose)
+{
+  this->pose = pose;
+  initialized = false;
+  update();
+}
+
+/**
+ * The pose as of the last update
+ */
+TankOdometry::pose_t TankOdometry::get_position() const
+{
+  return pose;
+}
+
+/**
+ * Speed along the robot's heading as of the last update, inches per second
+ */
+scalar_t TankOdometry::get_speed() const
+{
+  return speed;
+}
+
+/**
+ * Acceleration along the robot's heading, inches per second^2. Only with an observer.
+ */
+scalar_t TankOdometry::get_acceleration() const
+{
+  return observer != NULL ? observer->get_acceleration() : 0;
+}
+
+/**
+ * Take speed and acceleration from an observer fed the distance driven (see
+ * state_observer.h), in inches, instead of differencing it each update
+ */
+void TankOdometry::set_observer(StateObserver::observer_config_t &config)
+{
+  if (observer != NULL)
+    delete observer;
+
+  observer = new StateObserver(config);
+}
@@ -0,0 +1,170 @@
+#include "../core/include/utils/thermal_model.h"
+#include <cmath>
+
+// Never cap the current limit below this, so the robot can always still move
+#define MIN_CAP 0.2
+
+// How fast the cap may change, per second, so it never shows up as a jerk
+#define CAP_RATE_PER_S 0.5
+
+// A V5 motor's current limit at full torque, and how close to its (capped) limit it has
+// to be drawing to count as held back by it
+#define FULL_CURRENT_A 2.5
+#define AT_LIMIT_FRACTION 0.9
+
+namespace
+{
+scalar_t clamp(scalar_t value, scalar_t lower, scalar_t upper)
+{
+  return value < lower ? lower : (value > upper ? upper : value);
+}
+} // namespace
+
+ThermalModel::ThermalModel(thermal_config_t &config) : config(config)
+{
+}
+
+/**
+ * Model (motor), and manage its current limit. Returns its index for get_telemetry(),
+ * or -1 if there are too many.
+ */
+int ThermalModel::add_motor(vex::motor &motor)
+{
+  if (num_motors >= THERMAL_MODEL_MAX_MOTORS)
+    return -1;
+
+  motor_t &m = motors[num_motors];
+  m.motor = &motor;
+  m.measured_c = (scalar_t)motor.temperature(vex::temperatureUnits::celsius);
+  m.estimate_c = m.measured_c;
+  m.demand_w = 0;
+  m.cap = 1;
+  m.seconds_to_derate = -1;
+  m.prediction_made = false;
+  m.last_predicted_c = m.estimate_c;
+  m.last_actual_c = m.estimate_c;
+  return num_motors++;
+}
+
+/**
+ * Step the model and re-apply the current limits, at most every THERMAL_MODEL_PERIOD_MS
+ * however often it is called. Call it wherever the motors are commanded.
+ */
+void ThermalModel::update()
+{
+  uint32_t now = vexSystemTimeGet();
+  if (updated && now - last_update_ms < THERMAL_MODEL_PERIOD_MS)
+    return;
+
+  scalar_t dt = updated ? (now - last_update_ms) / (scalar_t)1000 : 0;
+  last_update_ms = now;
+  updated = true;
+
+  for (int i = 0; i < num_motors; i++)
+    update_motor(motors[i], dt, now);
+}
+
+void ThermalModel::update_motor(motor_t &m, scalar_t dt, uint32_t now)
+{
+  scalar_t amps = std::fabs((scalar_t)m.motor->current(vex::currentUnits::amp));
+  scalar_t heat_w = amps * amps * config.winding_ohms;
+  m.measured_c = (scalar_t)m.motor->temperature(vex::temperatureUnits::celsius);
+
+  // Step the estimate, then keep it inside the band the (coarse) reading allows
+  m.estimate_c += (heat_w - (m.estimate_c - config.ambient_c) / config.thermal_ohms) * dt / config.thermal_mass;
+
+  scalar_t low = m.measured_c - config.sensor_step_c / 2, high = m.measured_c + config.sensor_step_c / 2;
+  scalar_t gain = clamp(config.correction_per_s * dt, 0, 1);
+  if (m.estimate_c < low)
+    m.estimate_c += (low - m.estimate_c) * gain;
+  else if (m.estimate_c > high)
+    m.estimate_c += (high - m.estimate_c) * gain;
+
+  // The heating the driver is asking for. Only a motor held at its capped limit is getting
+  // less than it asks for: take it to want the full limit, so its losses scale with the
+  // square of the cap. Below the limit, the cap isn't costing it anything.
+  scalar_t uncapped_w = heat_w;
+  if (m.cap < 1 && amps >= m.cap * FULL_CURRENT_A * AT_LIMIT_FRACTION)
+    uncapped_w = heat_w / (m.cap * m.cap);
+  m.demand_w += (uncapped_w - m.demand_w) * clamp(dt / config.demand_tau_s, 0, 1);
+
+  scalar_t tau = config.thermal_ohms * config.thermal_mass;
+  scalar_t limit_c = config.derate_c - config.margin_c;
+  scalar_t steady_c = config.ambient_c + m.demand_w * config.thermal_ohms;
+
+  // Time until the estimate reaches the limit, on the way to steady state
+  if (m.estimate_c >= limit_c)
+    m.seconds_to_derate = 0;
+  else if (steady_c > limit_c)
+    m.seconds_to_derate = tau * std::log((steady_c - m.estimate_c) / (steady_c - limit_c));
+  else
+    m.seconds_to_derate = -1;
+
+  // The current that would settle exactly at the limit, blended in as the limit gets closer
+  scalar_t sustainable_w = (limit_c - config.ambient_c) / config.thermal_ohms;
+  scalar_t sustainable = m.demand_w > sustainable_w ? std::sqrt(sustainable_w / m.demand_w) : 1;
+  scalar_t weight = m.seconds_to_derate < 0 ? 0 : clamp(1 - m.seconds_to_derate / config.horizon_s, 0, 1);
+  scalar_t target = clamp(1 - weight * (1 - sustainable), MIN_CAP, 1);
+
+  scalar_t max_step = CAP_RATE_PER_S * dt;
+  scalar_t cap = clamp(m.cap + clamp(target - m.cap, -max_step, max_step), MIN_CAP, 1);
+  if (cap != m.cap)
+    m.motor->setMaxTorque(cap * 100, vex::percentUnits::pct);
+  m.cap = cap;
+
+  // Telemetry: check the prediction that has come due, and make the next one
+  uint32_t horizon_ms = (uint32_t)(config.prediction_s * 1000);
+  if (m.prediction_made && now - m.prediction_ms < horizon_ms)
+    return;
+
+  if (m.prediction_made)
+  {
+    m.last_predicted_c = m.prediction_c;
+    m.last_actual_c = m.measured_c;
+  }
+
+  // Heading for what's asked for, up to what the capped limit lets through
+  scalar_t limit_a = m.cap * FULL_CURRENT_A;
+  scalar_t capped_w = std::fmin(m.demand_w, limit_a * limit_a * config.winding_ohms);
+  scalar_t heading_c = config.ambient_c + capped_w * config.thermal_ohms;
+  m.prediction_c = heading_c + (m.estimate_c - heading_c) * std::exp(-config.prediction_s / tau);
+  m.prediction_ms = now;
+  m.prediction_made = true;
+}
+
+/**
+ * Estimated and predicted temperatures of motor (index), as of the last update
+ */
+ThermalModel::telemetry_t ThermalModel::get_telemetry(int index) const
+{
+  telemetry_t telemetry = {};
+  if (index < 0 || index >= num_motors)
+    return telemetry;
+
+  const motor_t &m = motors[index];
+  telemetry.measured_c = m.measured_c;
+  telemetry.estimated_c = m.estimate_c;
+  telemetry.predicted_c = m.last_predicted_c;
+  telemetry.actual_c = m.last_actual_c;
+  telemetry.prediction_error = m.last_actual_c - m.last_predicted_c;
+  telemetry.seconds_to_derate = m.seconds_to_derate;
+  telemetry.cap = m.cap;
+  return telemetry;
+}
+
+/**
+ * Print every motor's telemetry to stderr, one line each
+ */
+void ThermalModel::print_telemetry() const
+{
+  for (int i = 0; i < num_motors; i++)
+  {
+    telemetry_t t = get_telemetry(i);
+    fprintf(stderr, "motor %d: %5.1f C read, %5.1f estimated; last prediction %5.1f, read %5.1f (%+.1f); ", i,
+            t.measured_c, t.estimated_c, t.predicted_c, t.actual_c, t.prediction_error);
+    if (t.seconds_to_derate < 0)
+      fprintf(stderr, "no derate, cap %.2f\n", t.cap);
+    else
+      fprintf(stderr, "derate in %.0fs, cap %.2f\n", t.seconds_to_derate, t.cap);
+  }
+}
@@ -0,0 +1,240 @@
+#include "../core/include/utils/traction_control.h"
+#include "../core/include/subsystems/swerve_module.h"
+#include <cmath>
+
+#define GRAVITY_IPS2 386.09 // inches / s^2 in a g
+#define DEG_TO_RAD (3.141592654 / 180.0)
+
+// Left alone longer than this, the IMU's speed is stale: start again from the wheels
+#define STALE_MS 100
+
+// Every wheel slipping for longer than this isn't slip (the wheels are held to the floor's
+// speed), it's the IMU's speed gone wrong, e.g. through a hit too short for it to sample.
+// Nothing else would correct it, so start again from the wheels.
+#define ALL_SLIP_MS 100
+
+// After a wheel breaks loose, it may lead the floor by this much of what it led by then
+#define LEAD_MEMORY 0.7
+
+namespace
+{
+scalar_t clamp(scalar_t value, scalar_t lower, scalar_t upper)
+{
+  return value < lower ? lower : (value > upper ? upper : value);
+}
+} // namespace
+
+TractionControl::TractionControl(vex::inertial &imu, traction_config_t &config) : imu(imu), config(config)
+{
+}
+
+/**
+ * Watch (module), whose center is (x), (y) inches from the robot's (right and forward).
+ * Returns the module's index for drive_output() and the rest, or -1 if there are too many.
+ */
+int TractionControl::add_module(SwerveModule &module, scalar_t x, scalar_t y)
+{
+  if (num_modules >= TRACTION_CONTROL_MAX_MODULES)
+    return -1;
+
+  module_t &m = modules[num_modules];
+  m.module = &module;
+  m.x = x;
+  m.y = y;
+  m.command = m.wheel_speed = m.floor_speed = 0;
+  m.lead_limit = 2 * config.max_wheel_speed;
+  m.learned_lead = 0;
+  m.slipping = false;
+  m.distance = m.last_rolling = 0;
+  return num_modules++;
+}
+
+/**
+ * Re-estimate the chassis' speed and check every wheel against it, at most every
+ * TRACTION_CONTROL_PERIOD_MS however many modules ask. The IMU and the robot frame here
+ * are both x right, y forward, turning clockwise positive.
+ */
+void TractionControl::update()
+{
+  uint32_t now = vexSystemTimeGet();
+  if (updated && now - last_update_ms < TRACTION_CONTROL_PERIOD_MS)
+    return;
+
+  bool stale = !updated || now - last_update_ms > STALE_MS;
+  scalar_t dt = updated ? (now - last_update_ms) / (scalar_t)1000 : 0;
+
+  bool all_slipping = num_modules > 0;
+  for (int i = 0; i < num_modules; i++)
+    all_slipping = all_slipping && modules[i].slipping;
+  all_slipping_ms = (all_slipping && !stale) ? all_slipping_ms + (now - last_update_ms) : 0;
+  if (all_slipping_ms > ALL_SLIP_MS)
+  {
+    stale = true;
+    all_slipping_ms = 0;
+  }
+
+  last_update_ms = now;
+  updated = true;
+
+  // Nothing carries over a gap: the wheels say what the chassis is doing now, and there's
+  // nothing yet to say one of them is slipping
+  if (stale)
+  {
+    for (int i = 0; i < num_modules; i++)
+    {
+      modules[i].slipping = false;
+      modules[i].lead_limit = 2 * config.max_wheel_speed;
+    }
+  }
+
+  // Predict with the IMU: its acceleration includes the turning (centripetal) part
+  scalar_t w = (scalar_t)imu.gyroRate(vex::axisType::zaxis, vex::velocityUnits::dps) * (scalar_t)DEG_TO_RAD;
+  scalar_t ax = (scalar_t)imu.acceleration(vex::axisType::xaxis) * (scalar_t)GRAVITY_IPS2;
+  scalar_t ay = (scalar_t)imu.acceleration(vex::axisType::yaxis) * (scalar_t)GRAVITY_IPS2;
+  if (!stale)
+  {
+    scalar_t last_vx = vx;
+    vx += (ax - w * vy) * dt;
+    vy += (ay + w * last_vx) * dt;
+  }
+
+  // What each wheel says the chassis is doing wrong: a gripping wheel rolls with the floor
+  // along it, and doesn't slide across it. Wheels count for less the further off they roll,
+  // so a wheel creeping towards slipping doesn't drag the estimate along with it.
+  scalar_t ux[TRACTION_CONTROL_MAX_MODULES], uy[TRACTION_CONTROL_MAX_MODULES];
+  scalar_t cx[TRACTION_CONTROL_MAX_MODULES], cy[TRACTION_CONTROL_MAX_MODULES];
+  scalar_t weight[TRACTION_CONTROL_MAX_MODULES];
+  scalar_t sum_x = 0, sum_y = 0;
+  for (int i = 0; i < num_modules; i++)
+  {
+    module_t &m = modules[i];
+    scalar_t direction_deg;
+    m.module->get_velocity(&direction_deg, &m.wheel_speed);
+    ux[i] = std::sin(direction_deg * (scalar_t)DEG_TO_RAD);
+    uy[i] = std::cos(direction_deg * (scalar_t)DEG_TO_RAD);
+
+    cx[i] = m.wheel_speed * ux[i] - (vx + w * m.y);
+    cy[i] = m.wheel_speed * uy[i] - (vy - w * m.x);
+
+    scalar_t off = (cx[i] * ux[i] + cy[i] * uy[i]) / config.slip_speed;
+    weight[i] = m.slipping ? 0 : (stale ? 1 : clamp(1 - off * off, 0, 1));
+    sum_x += weight[i] * cx[i];
+    sum_y += weight[i] * cy[i];
+  }
+
+  scalar_t gain = stale ? 1 : clamp(config.correction_per_s * dt, 0, 1);
+
+  // Check each wheel against the chassis speed from the IMU and the other wheels only
+  for (int i = 0; i < num_modules; i++)
+  {
+    module_t &m = modules[i];
+    scalar_t check_vx = vx, check_vy = vy;
+    if (num_modules > 1)
+    {
+      check_vx += gain * (sum_x - weight[i] * cx[i]) / (num_modules - 1);
+      check_vy += gain * (sum_y - weight[i] * cy[i]) / (num_modules - 1);
+    }
+    m.floor_speed = (check_vx + w * m.y) * ux[i] + (check_vy - w * m.x) * uy[i];
+    scalar_t error = std::fabs(m.wheel_speed - m.floor_speed);
+
+    if (!stale && !m.slipping && error > config.slip_speed)
+    {
+      // Broke loose: hold it at the floor's speed, and remember how hard it was pushed
+      m.slipping = true;
+      m.learned_lead = (scalar_t)LEAD_MEMORY * std::fabs(m.command - m.floor_speed);
+      m.lead_limit = 0;
+    }
+    else if (m.slipping && error < config.grip_speed)
+    {
+      m.slipping = false;
+      m.lead_limit = m.learned_lead > config.min_lead ? m.learned_lead : config.min_lead;
+    }
+    else if (!m.slipping)
+    {
+      m.lead_limit = clamp(m.lead_limit + config.lead_recovery_per_s * dt, config.min_lead,
+                           2 * config.max_wheel_speed);
+    }
+
+    // Trapezoids, so speeding up doesn't over-count
+    scalar_t rolling = m.slipping ? m.floor_speed : m.wheel_speed;
+    m.distance += (rolling + m.last_rolling) / 2 * dt;
+    m.last_rolling = rolling;
+  }
+
+  // Pull the chassis speed towards the wheels still gripping
+  sum_x = sum_y = 0;
+  for (int i = 0; i < num_modules; i++)
+  {
+    if (modules[i].slipping)
+      continue;
+    sum_x += weight[i] * cx[i];
+    sum_y += weight[i] * cy[i];
+  }
+  if (num_modules > 0)
+  {
+    vx += gain * sum_x / num_modules;
+    vy += gain * sum_y / num_modules;
+  }
+}
+
+/**
+ * The drive command (-1.0 -> 1.0) module (index) may have instead of (percent): close
+ * enough to the floor's speed that the wheel grips. (reversed) is true if the drive motor
+ * runs backwards to the way the module points.
+ */
+scalar_t TractionControl::drive_output(int index, scalar_t percent, bool reversed)
+{
+  if (index < 0 || index >= num_modules || config.max_wheel_speed <= 0)
+    return percent;
+
+  update();
+  module_t &m = modules[index];
+
+  // In the motor's direction
+  scalar_t sign = reversed ? -1 : 1;
+  scalar_t floor_speed = m.floor_speed * sign;
+  scalar_t command = clamp(percent * config.max_wheel_speed, floor_speed - m.lead_limit, floor_speed + m.lead_limit);
+
+  m.command = command * sign;
+  return command / config.max_wheel_speed;
+}
+
+/**
+ * Whether module (index) was slipping as of the last update
+ */
+bool TractionControl::is_slipping(int index)
+{
+  if (index < 0 || index >= num_modules)
+    return false;
+
+  return modules[index].slipping;
+}
+
+/**
+ * Inches module (index) has really rolled since reset_distance(), along the way it
+ * points: counted with the floor's speed while it slips
+ */
+scalar_t TractionControl::get_distance(int index)
+{
+  if (index < 0 || index >= num_modules)
+    return 0;
+
+  update();
+  return modules[index].distance;
+}
+
+void TractionControl::reset_distance(int index)
+{
+  if (index >= 0 && index < num_modules)
+    modules[index].distance = 0;
+}
+
+/**
+ * The chassis' speed, from the IMU and the gripping wheels: x to the right and y
+ * forward, inches / second
+ */
+Vector::point_t TractionControl::get_velocity()
+{
+  Vector::point_t out = {.x = vx, .y = vy};
+  return out;
+}
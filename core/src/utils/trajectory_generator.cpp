@@ -0,0 +1,153 @@
+#include "../core/include/utils/trajectory_generator.h"
+#include <cmath>
+
+TrajectoryGenerator::TrajectoryGenerator(generator_config_t &config) : config(config)
+{
+}
+
+/**
+ * Position and heading at (t) (0 -> 1) along curve (c)
+ */
+void TrajectoryGenerator::point(const curve_t &c, double t, double &x, double &y, double &heading) const
+{
+  double t2 = t * t, t3 = t2 * t;
+  double h00 = 2 * t3 - 3 * t2 + 1, h10 = t3 - 2 * t2 + t, h01 = -2 * t3 + 3 * t2, h11 = t3 - t2;
+  x = h00 * c.x0 + h10 * c.dx0 + h01 * c.x1 + h11 * c.dx1;
+  y = h00 * c.y0 + h10 * c.dy0 + h01 * c.y1 + h11 * c.dy1;
+
+  // Heading along the tangent
+  double d00 = 6 * t2 - 6 * t, d10 = 3 * t2 - 4 * t + 1, d01 = -6 * t2 + 6 * t, d11 = 3 * t2 - 2 * t;
+  heading = std::atan2(d00 * c.y0 + d10 * c.dy0 + d01 * c.y1 + d11 * c.dy1,
+                       d00 * c.x0 + d10 * c.dx0 + d01 * c.x1 + d11 * c.dx1);
+}
+
+/**
+ * Fill (segments), with room for (max_length), with a trajectory through (waypoints),
+ * starting at (start_v) in/s and ending at (end_v). If the path is too short to get
+ * from one to the other at max_a, it ends as close to (end_v) as it can. If
+ * (waypoint_segments) isn't NULL, it gets the index of the first segment at or past each
+ * waypoint. Returns the number of segments, or -1 if they don't fit or the waypoints are
+ * unusable.
+ */
+int TrajectoryGenerator::generate(const Waypoint *waypoints, int count, scalar_t start_v, scalar_t end_v,
+                                  Segment *segments, int max_length, int *waypoint_segments)
+{
+  if (count < 2 || count > TRAJECTORY_MAX_WAYPOINTS || max_length < 1 || config.max_v <= 0 ||
+      config.max_a <= 0 || config.dt <= 0)
+    return -1;
+
+  // The curves, with tangents as long as the distance between their waypoints, and how
+  // far along each one every sample is
+  int num_curves = count - 1;
+  double total = 0;
+  for (int i = 0; i < num_curves; i++)
+  {
+    const Waypoint &a = waypoints[i], &b = waypoints[i + 1];
+    double chord = std::sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+    curve_t &c = curves[i];
+    c.x0 = a.x;
+    c.y0 = a.y;
+    c.dx0 = chord * std::cos(a.angle);
+    c.dy0 = chord * std::sin(a.angle);
+    c.x1 = b.x;
+    c.y1 = b.y;
+    c.dx1 = chord * std::cos(b.angle);
+    c.dy1 = chord * std::sin(b.angle);
+
+    double last_x = a.x, last_y = a.y, heading;
+    distances[i][0] = 0;
+    for (int j = 1; j <= TRAJECTORY_SAMPLES; j++)
+    {
+      double x, y;
+      point(c, j / (double)TRAJECTORY_SAMPLES, x, y, heading);
+      distances[i][j] = distances[i][j - 1] + std::sqrt((x - last_x) * (x - last_x) + (y - last_y) * (y - last_y));
+      last_x = x;
+      last_y = y;
+    }
+    total += distances[i][TRAJECTORY_SAMPLES];
+  }
+
+  double dt = config.dt, max_v = config.max_v, max_a = config.max_a;
+  double v = start_v < 0 ? 0 : (start_v > max_v ? max_v : start_v);
+  double final_v = end_v < 0 ? 0 : (end_v > max_v ? max_v : end_v);
+  double s = 0, a = 0;
+
+  // Where along the curves the last segment was: curve, sample, and distance to the curve
+  // start
+  int curve = 0, sample = 0;
+  double curve_start = 0;
+  int next_waypoint = 1;
+  if (waypoint_segments != NULL)
+    waypoint_segments[0] = 0;
+
+  for (int n = 0;; n++)
+  {
+    if (n >= max_length)
+      return -1;
+
+    // Find (s) on the curves. Samples only ever move forward, so this is cheap.
+    while (curve < num_curves - 1 && s >= curve_start + distances[curve][TRAJECTORY_SAMPLES])
+    {
+      curve_start += distances[curve][TRAJECTORY_SAMPLES];
+      curve++;
+      sample = 0;
+    }
+    double along = s - curve_start;
+    while (sample < TRAJECTORY_SAMPLES - 1 && along >= distances[curve][sample + 1])
+      sample++;
+
+    double span = distances[curve][sample + 1] - distances[curve][sample];
+    double fraction = span > 0 ? (along - distances[curve][sample]) / span : 0;
+    fraction = fraction < 0 ? 0 : (fraction > 1 ? 1 : fraction);
+
+    Segment &seg = segments[n];
+    point(curves[curve], (sample + fraction) / TRAJECTORY_SAMPLES, seg.x, seg.y, seg.heading);
+    seg.dt = dt;
+    seg.position = s;
+    seg.jerk = n > 0 ? (a - segments[n - 1].acceleration) / dt : 0;
+    seg.velocity = v;
+    seg.acceleration = a;
+
+    // Waypoint k starts curve k
+    while (waypoint_segments != NULL && next_waypoint < count - 1 && curve >= next_waypoint)
+      waypoint_segments[next_waypoint++] = n;
+
+    if (s >= total)
+    {
+      if (waypoint_segments != NULL)
+        waypoint_segments[count - 1] = n;
+      return n + 1;
+    }
+
+    // Speed up, up to max_v, but never so fast the robot can't slow to final_v by the end
+    // after this step: next_v^2 <= final_v^2 + 2 max_a (remaining - (v + next_v) / 2 dt).
+    // Nor slow down harder than max_a, if it's too late to make it.
+    double remaining = total - s;
+    double adt = max_a * dt;
+    double next_v = v + adt;
+    if (next_v > max_v)
+      next_v = max_v;
+    double disc = adt * adt - 4 * (adt * v - 2 * max_a * remaining - final_v * final_v);
+    double slow_v = disc > 0 ? (std::sqrt(disc) - adt) / 2 : 0;
+    if (next_v > slow_v)
+      next_v = slow_v > v - adt ? slow_v : v - adt;
+    if (next_v < 0)
+      next_v = 0;
+
+    double step = (v + next_v) / 2 * dt;
+    if (step >= remaining || next_v <= 0)
+    {
+      // The end: this is the last step, to as close to final_v as max_a allows
+      double last_v = final_v < v - adt ? v - adt : (final_v > v + adt ? v + adt : final_v);
+      a = (last_v - v) / dt;
+      s = total;
+      v = last_v;
+    }
+    else
+    {
+      a = (next_v - v) / dt;
+      s += step;
+      v = next_v;
+    }
+  }
+}
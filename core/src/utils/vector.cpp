@@ -1,4 +1,5 @@
 #include "../core/include/utils/vector.h"
+#include "../core/include/utils/fast_math.h"
 
 /**
  * Construct a vector object.
@@ -6,7 +7,7 @@
  * @param dir Direction, in radians. 'foward' is 0, clockwise positive when viewed from the top.
  * @param mag Magnitude.
  */
-Vector::Vector(double dir, double mag)
+Vector::Vector(scalar_t dir, scalar_t mag)
 : dir(dir), mag(mag)
 {
 
@@ -19,8 +20,8 @@ Vector::Vector(double dir, double mag)
  */
 Vector::Vector(point_t &p)
 {
-    this->dir = atan2(p.x, p.y);
-    this->mag = sqrt( (p.x*p.x) + (p.y*p.y) );
+    this->dir = fast_atan2(p.x, p.y);
+    this->mag = std::sqrt( (p.x*p.x) + (p.y*p.y) );
 }
 
 /**
@@ -29,27 +30,27 @@ Vector::Vector(point_t &p)
  * 
  * Use r2d() to convert.
  */
-double Vector::get_dir() const { return dir;}
+scalar_t Vector::get_dir() const { return dir;}
 
 /**
  * Get the magnitude of the vector
  */
-double Vector::get_mag() const { return mag; }
+scalar_t Vector::get_mag() const { return mag; }
 
 /**
  * Get the X component of the vector; positive to the right.
  */
-double Vector::get_x() const
+scalar_t Vector::get_x() const
 {
-return mag * sin(dir);
+return mag * fast_sin(dir);
 }
 
 /**
  * Get the Y component of the vector, positive forward.
  */
-double Vector::get_y() const
+scalar_t Vector::get_y() const
 {
-return mag * cos(dir);
+return mag * fast_cos(dir);
 }
 
 /**
@@ -82,15 +83,15 @@ Vector Vector::operator-(const Vector &other)
 /**
  * General function for converting degrees to radians
  */
-double deg2rad(double deg)
+scalar_t deg2rad(scalar_t deg)
 {
-    return deg * (PI / 180.0);
+    return deg * (scalar_t)(PI / 180.0);
 }
 
 /**
  * General function for converting radians to degrees
  */
-double rad2deg(double rad)
+scalar_t rad2deg(scalar_t rad)
 {
-    return rad * (180.0 / PI);
+    return rad * (scalar_t)(180.0 / PI);
 }
\ No newline at end of file
@@ -0,0 +1,265 @@
+/**
+ * auto_compiler.cpp
+ *
+ * Compiles a text description of autonomous routines into the AutoProgram file format
+ * (see core/include/utils/auto_program.h), to copy onto the robot's SD card.
+ *
+ *   make -f host.mk tools
+ *   build/host/auto_compiler routines.txt auto.bin
+ *
+ * Text format: one action per line, '#' starts a comment. Distances are inches, angles
+ * degrees (clockwise positive), speeds 0 -> 1, times seconds.
+ *
+ *   routine left_side
+ *     drive 0 0.6 24            # direction, speed, distance
+ *     turn 90 0.5 timeout 2     # any action can end with "timeout <seconds>"
+ *     parallel                  # run everything up to "end" at the same time
+ *       drive 90 0.4 12
+ *       command 1               # a Command bound with AutoProgram::bind(1, ...)
+ *     end
+ *     wait 0.5
+ *     path 2
+ *   end
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "../core/include/utils/auto_program.h"
+
+namespace
+{
+struct routine_entry_t
+{
+  char name[AUTO_PROGRAM_NAME_LEN];
+  int first, count;
+};
+
+struct action_entry_t
+{
+  int op, block_size, timeout_ms;
+  float args[3];
+};
+
+const char *filename;
+int line_number = 0;
+
+void fail(const char *message, const char *detail = "")
+{
+  fprintf(stderr, "%s:%d: %s%s\n", filename, line_number, message, detail);
+  exit(1);
+}
+
+void put16(std::vector<uint8_t> &out, uint16_t value)
+{
+  out.push_back(value & 0xff);
+  out.push_back(value >> 8);
+}
+
+void put32(std::vector<uint8_t> &out, uint32_t value)
+{
+  put16(out, value & 0xffff);
+  put16(out, value >> 16);
+}
+
+void put_float(std::vector<uint8_t> &out, float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  put32(out, bits);
+}
+
+/**
+ * Parse a number token, failing with the line number if it isn't one
+ */
+float number(const char *token)
+{
+  if (token == NULL)
+    fail("missing number");
+
+  char *end;
+  float value = strtof(token, &end);
+  if (*end != '\0')
+    fail("not a number: ", token);
+  return value;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  if (argc != 3)
+  {
+    fprintf(stderr, "usage: %s <routines.txt> <output.bin>\n", argv[0]);
+    return 2;
+  }
+
+  filename = argv[1];
+  FILE *in = fopen(filename, "r");
+  if (in == NULL)
+  {
+    perror(filename);
+    return 1;
+  }
+
+  std::vector<routine_entry_t> routines;
+  std::vector<action_entry_t> actions;
+  bool in_routine = false;
+  int block = -1; // index of the open "parallel" action
+
+  char line[256];
+  while (fgets(line, sizeof(line), in) != NULL)
+  {
+    line_number++;
+    char *comment = strchr(line, '#');
+    if (comment != NULL)
+      *comment = '\0';
+
+    const char *tokens[8] = {};
+    int num_tokens = 0;
+    for (char *token = strtok(line, " \t\r\n"); token != NULL && num_tokens < 8; token = strtok(NULL, " \t\r\n"))
+      tokens[num_tokens++] = token;
+
+    if (num_tokens == 0)
+      continue;
+
+    const char *word = tokens[0];
+
+    if (strcmp(word, "routine") == 0)
+    {
+      if (in_routine)
+        fail("routine inside a routine (missing \"end\"?)");
+      if (num_tokens != 2 || strlen(tokens[1]) > AUTO_PROGRAM_NAME_LEN)
+        fail("expected: routine <name of up to 16 characters>");
+
+      routine_entry_t routine = {};
+      strncpy(routine.name, tokens[1], AUTO_PROGRAM_NAME_LEN);
+      routine.first = actions.size();
+      routines.push_back(routine);
+      in_routine = true;
+      continue;
+    }
+
+    if (!in_routine)
+      fail("action outside a routine: ", word);
+
+    if (strcmp(word, "end") == 0)
+    {
+      if (block >= 0)
+      {
+        actions[block].block_size = actions.size() - block - 1;
+        if (actions[block].block_size > AUTO_PROGRAM_MAX_BLOCK)
+          fail("too many actions in parallel block");
+        block = -1;
+      }
+      else
+      {
+        routines.back().count = actions.size() - routines.back().first;
+        in_routine = false;
+      }
+      continue;
+    }
+
+    // Optional trailing "timeout <seconds>"
+    action_entry_t action = {};
+    if (num_tokens >= 3 && strcmp(tokens[num_tokens - 2], "timeout") == 0)
+    {
+      float timeout = number(tokens[num_tokens - 1]);
+      if (timeout <= 0 || timeout > 65)
+        fail("timeout must be between 0 and 65 seconds");
+      action.timeout_ms = (int)(timeout * 1000);
+      num_tokens -= 2;
+    }
+
+    int num_args;
+    if (strcmp(word, "drive") == 0)
+    {
+      action.op = AutoProgram::OP_DRIVE;
+      num_args = 3;
+    }
+    else if (strcmp(word, "turn") == 0)
+    {
+      action.op = AutoProgram::OP_TURN;
+      num_args = 2;
+    }
+    else if (strcmp(word, "path") == 0)
+    {
+      action.op = AutoProgram::OP_PATH;
+      num_args = 1;
+    }
+    else if (strcmp(word, "wait") == 0)
+    {
+      action.op = AutoProgram::OP_WAIT;
+      num_args = 1;
+    }
+    else if (strcmp(word, "command") == 0)
+    {
+      action.op = AutoProgram::OP_COMMAND;
+      num_args = 1;
+    }
+    else if (strcmp(word, "parallel") == 0)
+    {
+      if (block >= 0)
+        fail("parallel blocks can't be nested");
+      action.op = AutoProgram::OP_PARALLEL;
+      num_args = 0;
+      block = actions.size();
+    }
+    else
+      fail("unknown action: ", word);
+
+    if (num_tokens - 1 != num_args)
+      fail("wrong number of arguments for ", word);
+
+    for (int i = 0; i < num_args; i++)
+      action.args[i] = number(tokens[i + 1]);
+
+    if (action.op == AutoProgram::OP_COMMAND
+        && (action.args[0] < 0 || action.args[0] >= AUTO_PROGRAM_MAX_COMMANDS || action.args[0] != (int)action.args[0]))
+      fail("command id must be a whole number below 32");
+
+    actions.push_back(action);
+  }
+  fclose(in);
+
+  if (in_routine)
+    fail("missing \"end\" at the end of the file");
+  if (routines.size() > AUTO_PROGRAM_MAX_ROUTINES)
+    fail("too many routines");
+  if (actions.size() > AUTO_PROGRAM_MAX_ACTIONS)
+    fail("too many actions");
+
+  std::vector<uint8_t> out;
+  put32(out, AUTO_PROGRAM_MAGIC);
+  put16(out, AUTO_PROGRAM_VERSION);
+  put16(out, routines.size());
+  put16(out, actions.size());
+  put16(out, 0);
+
+  for (size_t i = 0; i < routines.size(); i++)
+  {
+    out.insert(out.end(), routines[i].name, routines[i].name + AUTO_PROGRAM_NAME_LEN);
+    put16(out, routines[i].first);
+    put16(out, routines[i].count);
+  }
+
+  for (size_t i = 0; i < actions.size(); i++)
+  {
+    out.push_back(actions[i].op);
+    out.push_back(actions[i].block_size);
+    put16(out, actions[i].timeout_ms);
+    for (int a = 0; a < 3; a++)
+      put_float(out, actions[i].args[a]);
+  }
+
+  FILE *file = fopen(argv[2], "wb");
+  if (file == NULL || fwrite(out.data(), 1, out.size(), file) != out.size())
+  {
+    perror(argv[2]);
+    return 1;
+  }
+  fclose(file);
+
+  printf("%s: %d routines, %d actions, %d bytes\n", argv[2], (int)routines.size(), (int)actions.size(),
+         (int)out.size());
+  return 0;
+}
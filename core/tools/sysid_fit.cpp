@@ -0,0 +1,218 @@
+/**
+ * sysid_fit.cpp
+ *
+ * Fits the log from a SysIdCommand (core/include/utils/sysid.h) to
+ *   volts = kS * sign(v) + kV * v + kA * a
+ * by least squares, and suggests gains for MotorController::config_t.
+ *
+ *   make -f host.mk tools
+ *   build/host/sysid_fit sysid_drive.csv [--nominal 11] [--response 0.05] [--inches-per-rev 7.26]
+ *
+ *   --nominal         the BatteryCompensation nominal voltage (default 11)
+ *   --response        closed loop time constant to tune the velocity loop for, seconds
+ *                     (default 0.05: 10 loops of MotorController)
+ *   --inches-per-rev  distance per motor revolution, to also print kv / ka for
+ *                     SplinePath::motion_profile_t
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+struct row_t
+{
+  int test;
+  double time_s, volts, velocity, position;
+};
+
+// Samples either side used for the acceleration estimate
+#define ACCEL_SPAN 2
+
+// Samples slower than this fraction of the fastest are left out: below kS nothing moves
+#define MIN_SPEED_FRACTION 0.02
+
+double sign(double value)
+{
+  return value > 0 ? 1 : (value < 0 ? -1 : 0);
+}
+
+/**
+ * Solve the 3x3 system a * x = b by Gaussian elimination. Returns false if singular.
+ */
+bool solve3(double a[3][3], double b[3], double x[3])
+{
+  for (int col = 0; col < 3; col++)
+  {
+    int pivot = col;
+    for (int r = col + 1; r < 3; r++)
+      if (fabs(a[r][col]) > fabs(a[pivot][col]))
+        pivot = r;
+    if (fabs(a[pivot][col]) < 1e-12)
+      return false;
+
+    for (int c = 0; c < 3; c++)
+    {
+      double tmp = a[col][c];
+      a[col][c] = a[pivot][c];
+      a[pivot][c] = tmp;
+    }
+    double tmp = b[col];
+    b[col] = b[pivot];
+    b[pivot] = tmp;
+
+    for (int r = col + 1; r < 3; r++)
+    {
+      double f = a[r][col] / a[col][col];
+      for (int c = col; c < 3; c++)
+        a[r][c] -= f * a[col][c];
+      b[r] -= f * b[col];
+    }
+  }
+
+  for (int r = 2; r >= 0; r--)
+  {
+    double sum = b[r];
+    for (int c = r + 1; c < 3; c++)
+      sum -= a[r][c] * x[c];
+    x[r] = sum / a[r][r];
+  }
+  return true;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  const char *path = NULL;
+  double nominal = 11, response = 0.05, inches_per_rev = 0;
+  bool bad_args = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--nominal") == 0 && i + 1 < argc)
+      nominal = atof(argv[++i]);
+    else if (strcmp(argv[i], "--response") == 0 && i + 1 < argc)
+      response = atof(argv[++i]);
+    else if (strcmp(argv[i], "--inches-per-rev") == 0 && i + 1 < argc)
+      inches_per_rev = atof(argv[++i]);
+    else if (path == NULL && argv[i][0] != '-')
+      path = argv[i];
+    else
+      bad_args = true;
+  }
+
+  if (bad_args || path == NULL || nominal <= 0 || response <= 0)
+  {
+    fprintf(stderr, "usage: %s <sysid.csv> [--nominal 11] [--response 0.05] [--inches-per-rev X]\n", argv[0]);
+    return 2;
+  }
+
+  FILE *in = fopen(path, "r");
+  if (in == NULL)
+  {
+    perror(path);
+    return 1;
+  }
+
+  std::vector<row_t> rows;
+  char line[256];
+  while (fgets(line, sizeof(line), in) != NULL)
+  {
+    row_t row;
+    if (sscanf(line, "%d,%lf,%lf,%lf,%lf", &row.test, &row.time_s, &row.volts, &row.velocity, &row.position) == 5)
+      rows.push_back(row);
+  }
+  fclose(in);
+
+  double max_speed = 0;
+  for (size_t i = 0; i < rows.size(); i++)
+    max_speed = fmax(max_speed, fabs(rows[i].velocity));
+
+  // Accumulate the normal equations for [sign(v), v, a] -> volts
+  double ata[3][3] = {}, atb[3] = {};
+  double sum_v = 0, sum_vv = 0;
+  int used = 0;
+
+  for (size_t i = ACCEL_SPAN; i + ACCEL_SPAN < rows.size(); i++)
+  {
+    const row_t &before = rows[i - ACCEL_SPAN], &after = rows[i + ACCEL_SPAN], &row = rows[i];
+    if (before.test != row.test || after.test != row.test || fabs(row.velocity) < MIN_SPEED_FRACTION * max_speed)
+      continue;
+
+    double accel = (after.velocity - before.velocity) / (after.time_s - before.time_s);
+    double x[3] = {sign(row.velocity), row.velocity, accel};
+
+    for (int r = 0; r < 3; r++)
+    {
+      for (int c = 0; c < 3; c++)
+        ata[r][c] += x[r] * x[c];
+      atb[r] += x[r] * row.volts;
+    }
+    sum_v += row.volts;
+    sum_vv += row.volts * row.volts;
+    used++;
+  }
+
+  double k[3];
+  if (used < 10 || !solve3(ata, atb, k))
+  {
+    fprintf(stderr, "%s: not enough moving samples to fit (%d). Did the mechanism move?\n", path, used);
+    return 1;
+  }
+  double ks = k[0], kv = k[1], ka = k[2];
+
+  // r^2 of the fit, from a second pass
+  double ss_res = 0, mean = sum_v / used;
+  for (size_t i = ACCEL_SPAN; i + ACCEL_SPAN < rows.size(); i++)
+  {
+    const row_t &before = rows[i - ACCEL_SPAN], &after = rows[i + ACCEL_SPAN], &row = rows[i];
+    if (before.test != row.test || after.test != row.test || fabs(row.velocity) < MIN_SPEED_FRACTION * max_speed)
+      continue;
+
+    double accel = (after.velocity - before.velocity) / (after.time_s - before.time_s);
+    double err = row.volts - (ks * sign(row.velocity) + kv * row.velocity + ka * accel);
+    ss_res += err * err;
+  }
+  double ss_tot = sum_vv - used * mean * mean;
+  double r2 = ss_tot > 0 ? 1 - ss_res / ss_tot : 0;
+
+  printf("%s: %d of %d samples used, r^2 = %.4f\n\n", path, used, (int)rows.size(), r2);
+  printf("kS = %.4f V\n", ks);
+  printf("kV = %.6f V/rpm\n", kv);
+  printf("kA = %.6f V/(rpm/s)   (open loop time constant %.3f s)\n\n", ka, kv > 0 ? ka / kv : 0);
+
+  if (kv <= 0 || ka < 0)
+    printf("kV / kA came out unphysical: check the log (mechanism jammed, or motors fighting?)\n\n");
+
+  // Velocity loop: with a = (V - kS - kV v) / kA, proportional feedback kP gives a closed
+  // loop time constant of kA / (kV + kP). Solve for the requested response.
+  double kp = fmax(0, ka / response - kv);
+
+  // Position loop several times slower than the velocity loop it drives, in rpm per degree
+  double position_p = 1 / (4 * response) / 6;
+
+  printf("MotorController::config_t (nominal %.1f V, %.0f ms response):\n", nominal, response * 1000);
+  printf("{\n");
+  printf("  .ks = %.4f,\n", ks);
+  printf("  .kv = %.6f,\n", kv);
+  printf("  .ka = %.6f,\n", ka);
+  printf("  .kp = %.6f,\n", kp);
+  printf("  .ki = 0,\n");
+  printf("  .position_p = %.3f,\n", position_p);
+  printf("  .max_rpm = %.0f\n", kv > 0 ? (nominal - ks) / kv : 0);
+  printf("}\n");
+
+  if (inches_per_rev > 0)
+  {
+    // SplinePath's feedforward is in output fraction (of nominal) per inch/s and inch/s^2
+    double rpm_per_ips = 60 / inches_per_rev;
+    printf("\nSplinePath::motion_profile_t:\n");
+    printf("  kv = %.5f\n", kv * rpm_per_ips / nominal);
+    printf("  ka = %.5f\n", ka * rpm_per_ips / nominal);
+    printf("  max_v = %.1f in/s at nominal\n", kv > 0 ? (nominal - ks) / kv / rpm_per_ips : 0);
+  }
+
+  return 0;
+}
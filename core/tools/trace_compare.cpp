@@ -0,0 +1,107 @@
+/**
+ * trace_compare.cpp
+ *
+ * Compares two SIM_TRACE files (core/sim/include/sim/sim.h) from the same inputs, row by
+ * row, and fails if the robot's pose in them ever differs by more than the tolerances.
+ * make -f host.mk accuracy uses it to check the float build against the double one.
+ *
+ *   make -f host.mk tools
+ *   build/host/trace_compare double.csv float.csv [--max-inches 1.5] [--max-degrees 5]
+ *
+ * Exits 0 if the traces agree, 1 if they don't, 2 if they can't be read.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+struct pose_row_t
+{
+  double time_s, x, y, heading;
+};
+
+bool read_trace(const char *path, std::vector<pose_row_t> &rows)
+{
+  FILE *f = fopen(path, "r");
+  if (f == NULL)
+  {
+    fprintf(stderr, "trace_compare: could not open %s\n", path);
+    return false;
+  }
+
+  char line[1024];
+  while (fgets(line, sizeof(line), f) != NULL)
+  {
+    pose_row_t row;
+    if (sscanf(line, "%lf,%lf,%lf,%lf", &row.time_s, &row.x, &row.y, &row.heading) == 4)
+      rows.push_back(row);
+  }
+
+  fclose(f);
+  return true;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  if (argc < 3)
+  {
+    fprintf(stderr, "usage: %s expected.csv actual.csv [--max-inches 1.5] [--max-degrees 5]\n", argv[0]);
+    return 2;
+  }
+
+  double max_inches = 1.5, max_degrees = 5;
+  for (int i = 3; i + 1 < argc; i += 2)
+  {
+    if (strcmp(argv[i], "--max-inches") == 0)
+      max_inches = atof(argv[i + 1]);
+    else if (strcmp(argv[i], "--max-degrees") == 0)
+      max_degrees = atof(argv[i + 1]);
+  }
+
+  std::vector<pose_row_t> expected, actual;
+  if (!read_trace(argv[1], expected) || !read_trace(argv[2], actual))
+    return 2;
+  if (expected.empty() || expected.size() != actual.size())
+  {
+    fprintf(stderr, "trace_compare: traces have %d and %d rows\n", (int)expected.size(), (int)actual.size());
+    return 2;
+  }
+
+  // The largest gaps, and when they were
+  double worst_inches = 0, worst_degrees = 0, inches_at = 0, degrees_at = 0;
+  for (size_t i = 0; i < expected.size(); i++)
+  {
+    const pose_row_t &e = expected[i], &a = actual[i];
+    double inches = sqrt((e.x - a.x) * (e.x - a.x) + (e.y - a.y) * (e.y - a.y));
+    double degrees = fabs(e.heading - a.heading);
+    if (inches > worst_inches)
+    {
+      worst_inches = inches;
+      inches_at = e.time_s;
+    }
+    if (degrees > worst_degrees)
+    {
+      worst_degrees = degrees;
+      degrees_at = e.time_s;
+    }
+  }
+
+  const pose_row_t &e = expected.back(), &a = actual.back();
+  printf("final gap:     %.2f in, %.2f deg\n", sqrt((e.x - a.x) * (e.x - a.x) + (e.y - a.y) * (e.y - a.y)),
+         fabs(e.heading - a.heading));
+  printf("largest gap:   %.2f in at %.2fs (max %.2f), %.2f deg at %.2fs (max %.2f)\n", worst_inches, inches_at,
+         max_inches, worst_degrees, degrees_at, max_degrees);
+
+  if (worst_inches > max_inches || worst_degrees > max_degrees)
+  {
+    printf("FAIL: the traces differ by more than the tolerance\n");
+    return 1;
+  }
+
+  printf("OK\n");
+  return 0;
+}
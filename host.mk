@@ -0,0 +1,110 @@
+# Host (Linux) build of the robot program, against the simulated vex API in core/sim.
+#
+#   make -f host.mk          build build/host/robot_sim
+#   make -f host.mk run      build and run the autonomous period in simulation
+#   make -f host.mk bench    build and run the core microbenchmarks (JSON lines on stdout)
+#   make -f host.mk tools    build the host tools: build/host/auto_compiler, build/host/sysid_fit,
+#                            build/host/trace_compare
+#   make -f host.mk accuracy run the same driver inputs through the double and float builds, and
+#                            fail if the robot's pose differs by more than ACCURACY_MAX_IN inches
+#                            or ACCURACY_MAX_DEG degrees at any point
+#
+# Add SCALAR=float to any of these to build the core in single precision (CORE_FLOAT_MATH),
+# e.g. to compare benchmarks or SIM_TRACE output against the default double build.
+#
+# Set PATHFINDER_HOST_LIB to a host build of libpathfinder.a to include the pathfinder benchmarks.
+#
+# See core/sim/include/sim/sim.h for the SIM_* environment options.
+
+HOST_CXX  ?= g++
+HOST_AR   ?= ar
+HOST_BUILD = build/host
+
+HOST_FLAGS = -std=gnu++11 -O2 -g -Wall -Werror=return-type -pthread -DVEX_SIM
+HOST_INC   = -Iinclude -I./ -Icore/sim/include
+
+ifeq ($(SCALAR),float)
+HOST_BUILD = build/host-float
+HOST_FLAGS += -DCORE_FLOAT_MATH
+endif
+
+ROBOT_SRC = $(wildcard src/*.cpp) $(wildcard src/*/*.cpp) $(wildcard sim/*.cpp)
+CORE_SRC  = $(wildcard core/src/*/*.cpp)
+SIM_SRC   = $(wildcard core/sim/src/*.cpp)
+BENCH_SRC = $(wildcard core/bench/*.cpp)
+
+ROBOT_OBJ = $(addprefix $(HOST_BUILD)/, $(ROBOT_SRC:.cpp=.o))
+CORE_OBJ  = $(addprefix $(HOST_BUILD)/, $(CORE_SRC:.cpp=.o))
+SIM_OBJ   = $(addprefix $(HOST_BUILD)/, $(SIM_SRC:.cpp=.o))
+BENCH_OBJ = $(addprefix $(HOST_BUILD)/, $(BENCH_SRC:.cpp=.o))
+
+ifdef PATHFINDER_HOST_LIB
+HOST_FLAGS += -DBENCH_PATHFINDER
+BENCH_LIBS = $(PATHFINDER_HOST_LIB)
+endif
+
+HOST_H = $(wildcard include/*.h include/*/*.h core/include/*/*.h core/include/*/*/*.h core/sim/include/*.h core/sim/include/*/*.h)
+
+# pathfinder only ships as an ARM archive, so the core library is linked as an archive:
+# only the objects the program actually uses get pulled in.
+CORE_LIB = $(HOST_BUILD)/libcore.a
+
+all: $(HOST_BUILD)/robot_sim
+
+run: $(HOST_BUILD)/robot_sim
+	./$(HOST_BUILD)/robot_sim
+
+bench: $(HOST_BUILD)/core_bench
+	./$(HOST_BUILD)/core_bench
+
+tools: $(HOST_BUILD)/auto_compiler $(HOST_BUILD)/sysid_fit $(HOST_BUILD)/trace_compare
+
+# The float build drifts from the double one mostly in heading, while spinning (about 2 deg
+# after 600 deg of turning on these inputs)
+ACCURACY_INPUT   = core/tools/float_accuracy.csv
+ACCURACY_MAX_IN  = 1.5
+ACCURACY_MAX_DEG = 5
+
+accuracy:
+	@$(MAKE) -f host.mk SCALAR= build/host/robot_sim build/host/trace_compare
+	@$(MAKE) -f host.mk SCALAR=float build/host-float/robot_sim
+	@SIM_MODE=driver SIM_INPUT=$(ACCURACY_INPUT) SIM_TRACE=build/host/accuracy_double.csv ./build/host/robot_sim > /dev/null
+	@SIM_MODE=driver SIM_INPUT=$(ACCURACY_INPUT) SIM_TRACE=build/host-float/accuracy_float.csv ./build/host-float/robot_sim > /dev/null
+	./build/host/trace_compare build/host/accuracy_double.csv build/host-float/accuracy_float.csv \
+		--max-inches $(ACCURACY_MAX_IN) --max-degrees $(ACCURACY_MAX_DEG)
+
+$(HOST_BUILD)/%.o: %.cpp $(HOST_H) host.mk
+	@mkdir -p $(dir $@)
+	@echo "CXX $<"
+	@$(HOST_CXX) $(HOST_FLAGS) $(HOST_INC) -c -o $@ $<
+
+$(CORE_LIB): $(CORE_OBJ)
+	@$(HOST_AR) rcs $@ $^
+
+$(HOST_BUILD)/robot_sim: $(ROBOT_OBJ) $(SIM_OBJ) $(CORE_LIB)
+	@echo "LINK $@"
+	@$(HOST_CXX) $(HOST_FLAGS) -o $@ $(ROBOT_OBJ) $(SIM_OBJ) $(CORE_LIB) -lm
+
+$(HOST_BUILD)/core_bench: $(BENCH_OBJ) $(SIM_OBJ) $(CORE_LIB)
+	@echo "LINK $@"
+	@$(HOST_CXX) $(HOST_FLAGS) -o $@ $(BENCH_OBJ) $(SIM_OBJ) $(CORE_LIB) $(BENCH_LIBS) -lm
+
+# Compiles autonomous routines from text to the AutoProgram format (core/include/utils/auto_program.h)
+$(HOST_BUILD)/auto_compiler: $(HOST_BUILD)/core/tools/auto_compiler.o
+	@echo "LINK $@"
+	@$(HOST_CXX) $(HOST_FLAGS) -o $@ $^
+
+# Checks one SIM_TRACE against another (make -f host.mk accuracy)
+$(HOST_BUILD)/trace_compare: $(HOST_BUILD)/core/tools/trace_compare.o
+	@echo "LINK $@"
+	@$(HOST_CXX) $(HOST_FLAGS) -o $@ $^ -lm
+
+# Fits kS / kV / kA to SysIdCommand logs (core/include/utils/sysid.h)
+$(HOST_BUILD)/sysid_fit: $(HOST_BUILD)/core/tools/sysid_fit.o
+	@echo "LINK $@"
+	@$(HOST_CXX) $(HOST_FLAGS) -o $@ $^ -lm
+
+clean:
+	rm -rf $(HOST_BUILD)
+
+.PHONY: all run bench tools accuracy clean
@@ -16,6 +16,16 @@ namespace Config
 extern PID::pid_config_t swerve_drive_config;
 extern PID::pid_config_t swerve_turning_config;
 
+extern MotorController::config_t swerve_drive_motor_config;
+extern StateObserver::observer_config_t swerve_drive_observer_config;
+
+extern PowerManager::power_config_t power_config;
+extern ThermalModel::thermal_config_t thermal_config;
+extern TractionControl::traction_config_t traction_config;
+extern PoseEstimator::estimator_config_t estimator_config;
+extern CollisionDetector::collision_config_t collision_config;
+extern PurePursuit::pursuit_config_t pursuit_config;
+
 // End Config Declarations
 
 void initConfig();
@@ -14,8 +14,26 @@
 
 //Utils
 #include "../core/include/utils/pid.h"
+#include "../core/include/utils/state_observer.h"
+#include "../core/include/utils/battery_compensation.h"
+#include "../core/include/utils/motor_controller.h"
+#include "../core/include/utils/sysid.h"
+#include "../core/include/utils/power_manager.h"
+#include "../core/include/utils/thermal_model.h"
+#include "../core/include/utils/traction_control.h"
+#include "../core/include/utils/collision_detector.h"
+#include "../core/include/utils/tank_odometry.h"
+#include "../core/include/utils/trajectory_generator.h"
 #include "../core/include/utils/spline_path.h"
+#include "../core/include/utils/field_planner.h"
+#include "../core/include/utils/pure_pursuit.h"
+#include "../core/include/utils/pose_estimator.h"
 #include "../core/include/utils/generic_auto.h"
+#include "../core/include/utils/command.h"
+#include "../core/include/utils/routine.h"
+#include "../core/include/utils/command_profiler.h"
+#include "../core/include/utils/input_recording.h"
+#include "../core/include/utils/auto_program.h"
 
 //Top Level
 #include "../core/include/pathfinder.h"
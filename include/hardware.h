@@ -43,6 +43,17 @@ extern SwerveModule rr_mod;
 
 extern SwerveDrive drive;
 
+extern BatteryCompensation battery_compensation;
+extern PowerManager power_manager;
+extern ThermalModel thermal_model;
+extern TractionControl traction_control;
+extern CollisionDetector collision_detector;
+
+extern MotorController lf_drive_controller;
+extern MotorController rf_drive_controller;
+extern MotorController lr_drive_controller;
+extern MotorController rr_drive_controller;
+
 //End Hardware Declarations
 } // namespace Hardware
 
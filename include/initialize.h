@@ -1,6 +1,15 @@
-
-namespace Init
-{
-  void vexcodeInit(void);
-
-}
\ No newline at end of file
+namespace Init
+{
+  void vexcodeInit(void);
+
+  /**
+   * True once all startup work has finished (IMU calibrated), and the robot is safe to move.
+   */
+  bool is_ready(void);
+
+  /**
+   * Sleep the calling task until the robot is ready. Other tasks keep running while it waits.
+   */
+  void wait_until_ready(void);
+
+}
@@ -0,0 +1,42 @@
+#ifndef _LOCALIZATION_
+#define _LOCALIZATION_
+
+#include "hardware.h"
+
+/**
+ * localization.h
+ *
+ * Keeps track of where the robot is, fusing the swerve wheels with the IMU (see
+ * pose_estimator.h) in a background task. Poses start at the origin facing +x when the
+ * IMU finishes calibrating: inches, heading in radians counter-clockwise.
+ */
+namespace Localization
+{
+
+#define LOCALIZATION_PERIOD_MS 10
+
+// How old readings are when they arrive: the motors filter their velocity, and the IMU
+// reports every 10ms
+#define ODOMETRY_LATENCY_MS 30
+#define IMU_LATENCY_MS 10
+
+extern PoseEstimator estimator;
+
+/**
+ * Start the background task. It waits for the IMU to calibrate before estimating.
+ */
+void start();
+
+/**
+ * The latest estimate: pose and robot-frame speeds
+ */
+PoseEstimator::state_t get_state();
+
+/**
+ * Say the robot is at (x), (y), (heading) now, stopped
+ */
+void set_position(scalar_t x, scalar_t y, scalar_t heading);
+
+} // namespace Localization
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef _REPLAY_
+#define _REPLAY_
+
+#include "hardware.h"
+
+/**
+ * replay.h
+ *
+ * Recording driver runs and playing them back in autonomous. In driver control, press Up
+ * on the master controller to start recording and Down to stop and save it to the SD card.
+ * Autonomous replays the saved run, if there is one.
+ */
+namespace Replay
+{
+
+#define REPLAY_FILE "driver.rec"
+
+extern InputRecording recording;
+
+/**
+ * Heading from the IMU and distance travelled from the drive motors, for recording and
+ * correcting replays
+ */
+class DriveSensors : public InputRecording::Sensors
+{
+public:
+  void reset() override;
+  void read(scalar_t *heading_deg, scalar_t *distance_in) override;
+
+private:
+  scalar_t heading_offset = 0, distance = 0;
+  uint64_t last_us = 0;
+};
+
+extern DriveSensors sensors;
+
+/**
+ * Drive the robot from controller inputs. Used by driver control, and by replays so they
+ * go through exactly the same code.
+ */
+void drive_with(const InputRecording::frame_t &input);
+
+} // namespace Replay
+
+#endif
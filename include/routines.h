@@ -0,0 +1,65 @@
+#ifndef _ROUTINES_
+#define _ROUTINES_
+
+#include "hardware.h"
+
+/**
+ * routines.h
+ *
+ * Autonomous routines loaded from the SD card (see core/include/utils/auto_program.h).
+ * Write them in text, compile them with build/host/auto_compiler, and copy the result
+ * to the SD card as ROUTINES_FILE. Autonomous runs the selected routine, if there is one.
+ */
+namespace Routines
+{
+
+#define ROUTINES_FILE "auto.bin"
+#define ROUTINES_MAX_PATHS 16
+
+// "command" ids that characterize the drive / steering motors (see core/include/utils/sysid.h),
+// logging to sysid_drive.csv / sysid_steer.csv
+#define SYSID_DRIVE_COMMAND 30
+#define SYSID_STEER_COMMAND 31
+
+extern AutoProgram program;
+
+/**
+ * Runs the selected routine. Select one with runner.select() before autonomous starts;
+ * the first routine in the file is selected when it loads.
+ */
+extern ProgramCommand runner;
+
+/**
+ * Load ROUTINES_FILE from the SD card, and prepare the paths its routines follow. Returns
+ * false if there is no usable program. Called during startup, while the IMU calibrates.
+ */
+bool load();
+
+/**
+ * Drive / turn / path actions on the swerve drive
+ */
+class SwerveActions : public AutoProgram::Drivetrain
+{
+public:
+  /**
+   * Make "path (id)" actions follow straight lines through (waypoints) (see
+   * PurePursuit::set_path), in Localization's frame, with Config::pursuit_config.
+   * Returns false if (id) is out of range or the path is unusable.
+   */
+  bool add_path(int id, const Waypoint *waypoints, int count);
+
+  bool drive(scalar_t direction_deg, scalar_t speed, scalar_t distance_in) override;
+  bool turn(scalar_t degrees, scalar_t speed) override;
+  bool has_path(int id) const override;
+  bool follow_path(int id) override;
+  void stop() override;
+
+private:
+  PurePursuit *paths[ROUTINES_MAX_PATHS] = {};
+};
+
+extern SwerveActions actions;
+
+} // namespace Routines
+
+#endif
@@ -0,0 +1,30 @@
+/**
+ * robot_model.cpp
+ *
+ * Physical description of this robot for the host simulator (see core/sim/include/sim/sim.h).
+ * Only built by host.mk; the robot itself never sees this file.
+ */
+#include "sim/sim.h"
+#include "hardware.h"
+
+void sim::configure_robot(World &world)
+{
+  SwerveModel::swerve_config_t swerve;
+
+  // Same ports as hardware.cpp. Modules sit on the corners of a 12"x12" square.
+  swerve.modules[0] = {PORT1, PORT2, -6.0, 6.0};    // left front
+  swerve.modules[1] = {PORT10, PORT9, 6.0, 6.0};    // right front
+  swerve.modules[2] = {PORT11, PORT12, -6.0, -6.0}; // left rear
+  swerve.modules[3] = {PORT20, PORT19, 6.0, -6.0};  // right rear
+
+  // The single 16:35 mesh turns the module the opposite way from the (reversed) direction motor
+  swerve.dir_ratio = -DIR_GEAR_RATIO;
+  swerve.drive_ratio = DRIVE_GEAR_RATIO;
+  swerve.coupling = 0;
+  swerve.wheel_diam = WHEEL_DIAM;
+
+  swerve.mass = 6.8; // 15lb
+  swerve.friction_coeff = 1.0;
+
+  world.set_chassis(new SwerveModel(swerve));
+}
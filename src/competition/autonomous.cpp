@@ -1,5 +1,8 @@
 #include "competition/autonomous.h"
 #include "core.h"
+#include "initialize.h"
+#include "replay.h"
+#include "routines.h"
 
 using namespace Hardware;
 
@@ -9,11 +12,34 @@ using namespace Hardware;
 void Auto::autonomous()
 {
   //Autonomous Init
-  while(imu.isCalibrating());
+  Init::wait_until_ready();
+
+  // Record how long each step takes, reported once the routine has finished
+  static CommandProfiler profiler;
+  profiler.start();
+  bool reported = false;
+
+  // Schedule the routine's commands (see core/include/utils/command.h) here
+  CommandScheduler scheduler;
+
+  // Run the selected routine from the SD card, or else replay the last recorded driver run
+  static ReplayCommand replay(Replay::recording, Replay::drive_with);
+  if (Routines::program.num_routines() > 0)
+    scheduler.schedule(Routines::runner);
+  else if (Replay::recording.load(v5_brain.SDcard, REPLAY_FILE))
+    scheduler.schedule(replay.with_correction(Replay::sensors, 2.0, 0.05));
 
   //Autonomous Loop
   while (true)
   {
+    scheduler.run();
+
+    if (scheduler.is_idle() && !reported)
+    {
+      profiler.stop();
+      profiler.report(&v5_brain.Screen);
+      reported = true;
+    }
 
     vexDelay(20); // Small delay to allow time-sensitive functions to work properly.
   }
@@ -1,5 +1,7 @@
 #include "competition/opcontrol.h"
 #include "core.h"
+#include "initialize.h"
+#include "replay.h"
 
 using namespace Hardware;
 
@@ -10,13 +12,35 @@ void OpControl::opcontrol()
 {
   
   // OpControl Init
-  while(imu.isCalibrating());
+  Init::wait_until_ready();
+
+  bool recording = false;
+  bool showing_temps = false;
 
   // OpControl Loop
   while (true)
   { 
-    // LEFT STICK: lateral movement   RIGHT STICK: rotational movement
-    drive.drive(master.Axis3.position(), master.Axis4.position(), master.Axis1.position());
+    Replay::drive_with(InputRecording::sample(master));
+
+    // Record a run to replay in autonomous: Up to start, Down to stop and save
+    if (master.ButtonUp.pressing() && !recording)
+    {
+      Replay::recording.start_recording(master, &Replay::sensors);
+      master.Screen.print("Recording...");
+      recording = true;
+    }
+    else if (master.ButtonDown.pressing() && recording)
+    {
+      Replay::recording.stop_recording();
+      recording = false;
+      bool saved = Replay::recording.save(v5_brain.SDcard, REPLAY_FILE);
+      master.Screen.print(saved ? "Saved recording" : "Failed to save!");
+    }
+
+    // Motor temperatures against what the thermal model predicted: X to print them
+    if (master.ButtonX.pressing() && !showing_temps)
+      thermal_model.print_telemetry();
+    showing_temps = master.ButtonX.pressing();
 
 
     vexDelay(50); // Small delay to allow time-sensitive functions to work properly (milliseconds)
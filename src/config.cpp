@@ -20,6 +20,111 @@ PID::pid_config_t Config::swerve_turning_config =
 };
 
 
+// Drive motors (blue cartridge): kV from 12V / 600rpm free speed (MOTOR_MAX_RPM / 6). Only
+// the feedforward is needed to drive as the battery-compensated voltage did, so the
+// feedback is kept gentle until a SysId run fits these.
+MotorController::config_t Config::swerve_drive_motor_config =
+{
+  .ks = .1,
+  .kv = .02,
+  .ka = 0,
+  .kp = .02,
+  .ki = .05,
+  .position_p = 0,
+  .max_rpm = 600
+};
+
+// Drive motor encoders, in degrees of motor rotation: about the encoder's resolution,
+// and how suddenly the wheels speed up and slow down
+StateObserver::observer_config_t Config::swerve_drive_observer_config =
+{
+  .position_noise = .5,
+  .jerk_noise = 5e4
+};
+
+// Current shared by all 8 swerve motors (20A if every one hit its 2.5A limit)
+PowerManager::power_config_t Config::power_config =
+{
+  .current_budget_a = 16,
+  .sag_start_v = 11.5,
+  .brownout_v = 9.5,
+  .drive_slew_per_s = 4,
+  .steering_priority_deg = 45
+};
+
+// V5 motor heating (what the firmware derates on), and how early to start easing off.
+// The thermal constants are estimates: check them against the telemetry (X in driver control).
+ThermalModel::thermal_config_t Config::thermal_config =
+{
+  .derate_c = 55,
+  .margin_c = 3,
+  .horizon_s = 20,
+  .thermal_ohms = 3.5,
+  .thermal_mass = 60,
+  .winding_ohms = 1.5,
+  .ambient_c = 25,
+  .sensor_step_c = 5,
+  .correction_per_s = .2,
+  .demand_tau_s = 5,
+  .prediction_s = 10
+};
+
+// Wheel slip on the 2.75" wheels. Full output is the drive motors' free speed:
+// 600rpm * 0.84 * 2.75" * pi = 72.6 in/s
+TractionControl::traction_config_t Config::traction_config =
+{
+  .max_wheel_speed = 72.6,
+  .slip_speed = 3,
+  .grip_speed = 1,
+  .min_lead = 4,
+  .lead_recovery_per_s = 20,
+  .correction_per_s = 3
+};
+
+// How much to trust each sensor in the pose estimator (localization.h). Wheel speeds that
+// disagree with the IMU by more than slip_gate standard deviations are taken as slip.
+PoseEstimator::estimator_config_t Config::estimator_config =
+{
+  .accel_noise = 10,
+  .yaw_accel_noise = 4,
+  .odometry_noise = 3,
+  .heading_noise = .01,
+  .yaw_rate_noise = .05,
+  .slip_gate = 2.5
+};
+
+// Running into field elements in autonomous. The wheels can't brake much harder than 1g
+// on carpet, and the drive motors draw their full 2.5A only when held back.
+CollisionDetector::collision_config_t Config::collision_config =
+{
+  .impact_g = 1.5,
+  .stall_current_a = 2.3,
+  .stall_rpm = 20,
+  .max_speed = 72.6,
+  .response_s = .25,
+  .tracking_error = 15,
+  .confirm_ms = 100
+};
+
+// "path <id>" actions in autonomous routines. 72.6 in/s is the drive's top speed; the
+// lookahead and speeds kept the simulated robot within about 2" of an S curve.
+PurePursuit::pursuit_config_t Config::pursuit_config =
+{
+  .lookahead_min = 6,
+  .lookahead_max = 18,
+  .lookahead_gain = .25,
+  .max_v = 50,
+  .min_v = 4,
+  .max_a = 60,
+  .max_lateral_a = 60,
+  .kv = 1 / 72.6,
+  .track_width = 12,
+  .spacing = 1,
+  .search_distance = 24,
+  .relocate_distance = 12,
+  .end_tolerance = 1
+};
+
 /**
  * config.cpp
  * 
@@ -29,4 +134,45 @@ void Config::initConfig()
 {
   Hardware::drive.set_drive_pid(swerve_drive_config);
   Hardware::drive.set_turn_pid(swerve_turning_config);
+
+  Hardware::lf_mod.set_battery_compensation(&Hardware::battery_compensation);
+  Hardware::rf_mod.set_battery_compensation(&Hardware::battery_compensation);
+  Hardware::lr_mod.set_battery_compensation(&Hardware::battery_compensation);
+  Hardware::rr_mod.set_battery_compensation(&Hardware::battery_compensation);
+
+  Hardware::lf_mod.set_power_manager(Hardware::power_manager);
+  Hardware::rf_mod.set_power_manager(Hardware::power_manager);
+  Hardware::lr_mod.set_power_manager(Hardware::power_manager);
+  Hardware::rr_mod.set_power_manager(Hardware::power_manager);
+
+  Hardware::lf_mod.set_thermal_model(Hardware::thermal_model);
+  Hardware::rf_mod.set_thermal_model(Hardware::thermal_model);
+  Hardware::lr_mod.set_thermal_model(Hardware::thermal_model);
+  Hardware::rr_mod.set_thermal_model(Hardware::thermal_model);
+
+  // Modules sit on the corners of a 12"x12" square
+  Hardware::lf_mod.set_traction_control(Hardware::traction_control, -6, 6);
+  Hardware::rf_mod.set_traction_control(Hardware::traction_control, 6, 6);
+  Hardware::lr_mod.set_traction_control(Hardware::traction_control, -6, -6);
+  Hardware::rr_mod.set_traction_control(Hardware::traction_control, 6, -6);
+
+  // Drive speed on our own loops. Steering stays on the motors' spinTo loop, which
+  // holds position without gains fitted from a SysId run.
+  Hardware::lf_mod.set_controllers(&Hardware::lf_drive_controller, NULL);
+  Hardware::rf_mod.set_controllers(&Hardware::rf_drive_controller, NULL);
+  Hardware::lr_mod.set_controllers(&Hardware::lr_drive_controller, NULL);
+  Hardware::rr_mod.set_controllers(&Hardware::rr_drive_controller, NULL);
+
+  // Wheel speed from the encoders, without the lag of the motors' filtered velocity
+  Hardware::lf_drive_controller.set_observer(Config::swerve_drive_observer_config);
+  Hardware::rf_drive_controller.set_observer(Config::swerve_drive_observer_config);
+  Hardware::lr_drive_controller.set_observer(Config::swerve_drive_observer_config);
+  Hardware::rr_drive_controller.set_observer(Config::swerve_drive_observer_config);
+
+  // Give up on an auto_drive that has run into something
+  Hardware::collision_detector.add_motor(Hardware::lf_drive);
+  Hardware::collision_detector.add_motor(Hardware::rf_drive);
+  Hardware::collision_detector.add_motor(Hardware::lr_drive);
+  Hardware::collision_detector.add_motor(Hardware::rr_drive);
+  Hardware::drive.set_collision_detector(&Hardware::collision_detector);
 }
\ No newline at end of file
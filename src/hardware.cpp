@@ -1,4 +1,5 @@
 #include "hardware.h"
+#include "config.h"
 
 // Initialize Hardware below
 // Form: [class] Hardware::[name](parameters);
@@ -32,4 +33,25 @@ SwerveModule Hardware::rr_mod(Hardware::rr_drive, gearSetting::ratio18_1, Hardwa
 // Swerve Drivetrain object. Do all 'drive related' things with this.
 SwerveDrive Hardware::drive(lf_mod, lr_mod, rf_mod, rr_mod, imu);
 
+// Drive motor output scaled against the battery, so autonomous behaves the same all match
+BatteryCompensation Hardware::battery_compensation(Hardware::v5_brain.Battery);
+
+// Current budget shared by the swerve modules, to stay clear of brownouts
+PowerManager Hardware::power_manager(Hardware::v5_brain.Battery, Config::power_config);
+
+// Drive motor temperatures, to ease off before the firmware halves their current
+ThermalModel Hardware::thermal_model(Config::thermal_config);
+
+// Wheel slip detection, to hold spinning wheels back to the floor's speed
+TractionControl Hardware::traction_control(Hardware::imu, Config::traction_config);
+
+// Notices when autonomous drives into something, to stop pushing against it
+CollisionDetector Hardware::collision_detector(Hardware::imu, Config::collision_config);
+
+// Module drive speed, run by our own loops instead of the motors' (see motor_controller.h)
+MotorController Hardware::lf_drive_controller(Hardware::lf_drive, Config::swerve_drive_motor_config, Hardware::battery_compensation);
+MotorController Hardware::rf_drive_controller(Hardware::rf_drive, Config::swerve_drive_motor_config, Hardware::battery_compensation);
+MotorController Hardware::lr_drive_controller(Hardware::lr_drive, Config::swerve_drive_motor_config, Hardware::battery_compensation);
+MotorController Hardware::rr_drive_controller(Hardware::rr_drive, Config::swerve_drive_motor_config, Hardware::battery_compensation);
+
 // End Hardware Initialization
\ No newline at end of file
@@ -2,25 +2,47 @@
 #include "vex.h"
 #include "config.h"
 #include "hardware.h"
+#include "routines.h"
+#include "localization.h"
 
 using namespace vex;
 using namespace Hardware;
 
+static volatile bool robot_ready = false;
+
+/**
+ * Background task that watches the IMU calibration, and flags the robot as ready when it's done.
+ * Sleeps between checks, so everything else keeps running while the IMU calibrates.
+ */
+static int calibration_watcher()
+{
+  while(imu.isCalibrating())
+    vexDelay(20);
+
+  fprintf(stderr, "Inertial Calibrated!\n");
+  robot_ready = true;
+
+  return 0;
+}
+
 /**
  * Used to initialize code/tasks/devices added using tools in VEXcode Text.
  *
  * This should be called at the start of your int main function.
+ * 
+ * Calibration of the IMU is only started here; the rest of the initialization, including
+ * preparing the autonomous paths, runs while it calibrates. Nothing that moves the robot
+ * can: the IMU needs it still. Use Init::wait_until_ready() before moving the robot.
  */
 void Init::vexcodeInit(void)
 {
-  // Initialize the robot configuration variables
-  Config::initConfig();
-
   // Calibrate the IMU. Make sure robot is STILL!
-  fprintf(stderr, "Calibrating Inertial...");
+  fprintf(stderr, "Calibrating Inertial...\n");
   imu.startCalibration();
-  while(imu.isCalibrating());
-  fprintf(stderr, "Done!\n");
+  task calibration_task(calibration_watcher);
+
+  // Initialize the robot configuration variables
+  Config::initConfig();
 
   // Set the direction motors to be in "brake" mode
   lf_dir.setBrake(brakeType::brake);
@@ -28,7 +50,38 @@ void Init::vexcodeInit(void)
   rf_dir.setBrake(brakeType::brake);
   rr_dir.setBrake(brakeType::brake);
 
+  // And the drive motors, so a drive controller letting go at zero speed slows the wheel
+  // as zero volts did, instead of coasting
+  lf_drive.setBrake(brakeType::brake);
+  lr_drive.setBrake(brakeType::brake);
+  rf_drive.setBrake(brakeType::brake);
+  rr_drive.setBrake(brakeType::brake);
+
+  // Track the robot's position in the background, once the IMU is ready
+  Localization::start();
+
+  // Load the autonomous routines from the SD card, if there are any, and prepare the paths
+  // they follow (see Routines::SwerveActions::add_path) while the IMU is still busy
+  Routines::load();
+
   Hardware::v5_brain.Screen.print("Robot Code Initialized.");
   Hardware::master.Screen.print("Controller Initialized.");
   Hardware::partner.Screen.print("Controller Initialized.");
-}
\ No newline at end of file
+}
+
+/**
+ * True once all startup work has finished (IMU calibrated), and the robot is safe to move.
+ */
+bool Init::is_ready(void)
+{
+  return robot_ready;
+}
+
+/**
+ * Sleep the calling task until the robot is ready. Other tasks keep running while it waits.
+ */
+void Init::wait_until_ready(void)
+{
+  while(!robot_ready)
+    vexDelay(10);
+}
@@ -0,0 +1,83 @@
+#include "localization.h"
+#include "config.h"
+#include "initialize.h"
+
+using namespace vex;
+using namespace Hardware;
+using namespace Localization;
+
+#define GRAVITY_IPS2 386.09 // inches / s^2 in a g
+#define DEG_TO_RAD (3.141592654 / 180.0)
+
+PoseEstimator Localization::estimator(Config::estimator_config);
+
+static mutex estimator_lock;
+static scalar_t heading_offset = 0; // from the IMU's heading to the estimator's
+
+static scalar_t imu_heading()
+{
+  return -(scalar_t)imu.rotation(rotationUnits::deg) * (scalar_t)DEG_TO_RAD;
+}
+
+/**
+ * Feed the estimator every LOCALIZATION_PERIOD_MS, once the IMU is ready. The IMU turns
+ * clockwise positive with x to the right; the estimator is counter-clockwise with y to
+ * the left.
+ */
+static int localization_task()
+{
+  Init::wait_until_ready();
+  set_position(0, 0, 0);
+
+  while(true)
+  {
+    uint32_t now = vexSystemTimeGet();
+    scalar_t accel_forward = (scalar_t)imu.acceleration(axisType::yaxis) * (scalar_t)GRAVITY_IPS2;
+    scalar_t accel_left = -(scalar_t)imu.acceleration(axisType::xaxis) * (scalar_t)GRAVITY_IPS2;
+    scalar_t heading = imu_heading() + heading_offset;
+    scalar_t omega = -(scalar_t)imu.gyroRate(axisType::zaxis, velocityUnits::dps) * (scalar_t)DEG_TO_RAD;
+    Vector::point_t wheels = drive.get_velocity();
+
+    estimator_lock.lock();
+    estimator.predict(now, accel_forward, accel_left);
+    estimator.add_heading(now - IMU_LATENCY_MS, heading);
+    estimator.add_yaw_rate(now - IMU_LATENCY_MS, omega);
+    estimator.add_odometry(now - ODOMETRY_LATENCY_MS, wheels.y, -wheels.x);
+    estimator_lock.unlock();
+
+    vexDelay(LOCALIZATION_PERIOD_MS);
+  }
+
+  return 0;
+}
+
+/**
+ * Start the background task. It waits for the IMU to calibrate before estimating.
+ */
+void Localization::start()
+{
+  task loc_task(localization_task);
+}
+
+/**
+ * The latest estimate: pose and robot-frame speeds
+ */
+PoseEstimator::state_t Localization::get_state()
+{
+  estimator_lock.lock();
+  PoseEstimator::state_t state = estimator.get_state();
+  estimator_lock.unlock();
+  return state;
+}
+
+/**
+ * Say the robot is at (x), (y), (heading) now, stopped
+ */
+void Localization::set_position(scalar_t x, scalar_t y, scalar_t heading)
+{
+  PoseEstimator::state_t state = {x, y, heading, 0, 0, 0};
+  estimator_lock.lock();
+  heading_offset = heading - imu_heading();
+  estimator.reset(state, vexSystemTimeGet());
+  estimator_lock.unlock();
+}
@@ -0,0 +1,43 @@
+#include "replay.h"
+
+using namespace Hardware;
+
+// 100 samples per second, enough for a whole driver control period
+InputRecording Replay::recording(15000, 10);
+
+Replay::DriveSensors Replay::sensors;
+
+/**
+ * Drive the robot from controller inputs. Used by driver control, and by replays so they
+ * go through exactly the same code.
+ */
+void Replay::drive_with(const InputRecording::frame_t &input)
+{
+  // LEFT STICK: lateral movement   RIGHT STICK: rotational movement
+  drive.drive(input.axis[2], input.axis[3], input.axis[0]);
+}
+
+void Replay::DriveSensors::reset()
+{
+  heading_offset = imu.rotation();
+  distance = 0;
+  last_us = vexSystemHighResTimeGet();
+}
+
+/**
+ * Heading is relative to the last reset(). Distance is the average wheel speed
+ * integrated over time, so it only ever counts up whichever way the modules point.
+ */
+void Replay::DriveSensors::read(scalar_t *heading_deg, scalar_t *distance_in)
+{
+  uint64_t now = vexSystemHighResTimeGet();
+  scalar_t dt = (now - last_us) / (scalar_t)1e6;
+  last_us = now;
+
+  scalar_t rpm = (std::fabs(lf_drive.velocity(velocityUnits::rpm)) + std::fabs(rf_drive.velocity(velocityUnits::rpm))
+                + std::fabs(lr_drive.velocity(velocityUnits::rpm)) + std::fabs(rr_drive.velocity(velocityUnits::rpm))) / 4;
+  distance += rpm / 60 * (scalar_t)(WHEEL_DIAM * PI * DRIVE_GEAR_RATIO) * dt;
+
+  *heading_deg = (scalar_t)imu.rotation() - heading_offset;
+  *distance_in = distance;
+}
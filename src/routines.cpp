@@ -0,0 +1,128 @@
+#include "routines.h"
+#include "config.h"
+#include "localization.h"
+
+using namespace Hardware;
+
+AutoProgram Routines::program;
+Routines::SwerveActions Routines::actions;
+ProgramCommand Routines::runner(Routines::program, Routines::actions);
+
+/**
+ * Point every module forward and hold it there, for characterizing the drive motors
+ */
+static bool align_modules()
+{
+  bool aligned = lf_mod.set_direction(0) & rf_mod.set_direction(0) & lr_mod.set_direction(0) & rr_mod.set_direction(0);
+  lf_mod.set_speed(0);
+  rf_mod.set_speed(0);
+  lr_mod.set_speed(0);
+  rr_mod.set_speed(0);
+  return aligned;
+}
+
+/**
+ * Release the drive speed loops, so the drive motors can be characterized
+ */
+static bool release_drive()
+{
+  lf_drive_controller.stop();
+  rf_drive_controller.stop();
+  lr_drive_controller.stop();
+  rr_drive_controller.stop();
+  return true;
+}
+
+static FunctionCommand align_command(align_modules);
+static FunctionCommand release_command(release_drive);
+static SysIdCommand sysid_drive(battery_compensation, v5_brain.SDcard, "sysid_drive.csv",
+                                {&lf_drive, &rf_drive, &lr_drive, &rr_drive});
+static SequentialGroup characterize_drive{&align_command, &release_command, &sysid_drive};
+
+static SysIdCommand sysid_steer(battery_compensation, v5_brain.SDcard, "sysid_steer.csv",
+                                {&lf_dir, &rf_dir, &lr_dir, &rr_dir});
+
+/**
+ * Load ROUTINES_FILE from the SD card, and prepare the paths its routines follow. Returns
+ * false if there is no usable program. Called during startup, while the IMU calibrates.
+ */
+bool Routines::load()
+{
+  if (!program.load(v5_brain.SDcard, ROUTINES_FILE))
+    return false;
+
+  // Groups made above that lost a command would run without it
+  if (!characterize_drive.is_complete())
+  {
+    fprintf(stderr, "Routines: a command group is missing commands, not loading\n");
+    return false;
+  }
+
+  // Bind commands for "command <id>" actions here, e.g. program.bind(1, intake_command);
+  program.bind(SYSID_DRIVE_COMMAND, characterize_drive);
+  program.bind(SYSID_STEER_COMMAND, sysid_steer);
+
+  // Add paths for "path <id>" actions here, e.g. actions.add_path(1, to_goal, 3);
+  if (!program.check_paths(actions))
+    return false;
+
+  fprintf(stderr, "Loaded %d autonomous routines from %s\n", program.num_routines(), ROUTINES_FILE);
+  return runner.select(0);
+}
+
+bool Routines::SwerveActions::drive(scalar_t direction_deg, scalar_t speed, scalar_t distance_in)
+{
+  return Hardware::drive.auto_drive(direction_deg, speed, distance_in);
+}
+
+bool Routines::SwerveActions::turn(scalar_t degrees, scalar_t speed)
+{
+  return Hardware::drive.auto_turn(degrees, speed);
+}
+
+/**
+ * Make "path (id)" actions follow straight lines through (waypoints) (see
+ * PurePursuit::set_path), in Localization's frame, with Config::pursuit_config.
+ * Returns false if (id) is out of range or the path is unusable.
+ */
+bool Routines::SwerveActions::add_path(int id, const Waypoint *waypoints, int count)
+{
+  if (id < 0 || id >= ROUTINES_MAX_PATHS)
+  {
+    fprintf(stderr, "Routines: path %d is out of range (0 -> %d)\n", id, ROUTINES_MAX_PATHS - 1);
+    return false;
+  }
+
+  PurePursuit *path = paths[id] != NULL ? paths[id] : new PurePursuit(Config::pursuit_config);
+  if (!path->set_path(waypoints, count))
+  {
+    fprintf(stderr, "Routines: path %d is unusable\n", id);
+    if (path != paths[id])
+      delete path;
+    return false;
+  }
+
+  paths[id] = path;
+  return true;
+}
+
+bool Routines::SwerveActions::has_path(int id) const
+{
+  return id >= 0 && id < ROUTINES_MAX_PATHS && paths[id] != NULL;
+}
+
+bool Routines::SwerveActions::follow_path(int id)
+{
+  // load() turns away programs with paths we don't have
+  if (!has_path(id))
+    return true;
+
+  PoseEstimator::state_t state = Localization::get_state();
+  PurePursuit::pose_t pose = {state.x, state.y, state.heading};
+  return paths[id]->follow(Hardware::drive, pose);
+}
+
+void Routines::SwerveActions::stop()
+{
+  Hardware::drive.stop_auto();
+}